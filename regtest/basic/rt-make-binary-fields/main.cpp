@@ -0,0 +1,115 @@
+#include "plumed/tools/IFile.h"
+#include "plumed/tools/OFile.h"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace PLMD;
+
+// reads the field step of a file through a pipe, which cannot be rewound, as with plumed driver <(...)
+std::string readFromPipe(const std::string& file) {
+  int fd[2];
+  if(pipe(fd)!=0) {
+    return " cannot create a pipe";
+  }
+  pid_t child=fork();
+  if(child==0) {
+    close(fd[0]);
+    std::ifstream is(file,std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(is)),std::istreambuf_iterator<char>());
+    if(write(fd[1],data.data(),data.size())!=static_cast<ssize_t>(data.size())) {
+      _exit(1);
+    }
+    _exit(0);
+  }
+  close(fd[1]);
+  std::string steps;
+  {
+    IFile ifile;
+    ifile.open("/dev/fd/"+std::to_string(fd[0]));
+    ifile.allowIgnoredFields();
+    int step;
+    while(ifile.scanField("step",step)) {
+      ifile.scanField();
+      steps+=" "+std::to_string(step);
+    }
+  }
+  close(fd[0]);
+  int status;
+  waitpid(child,&status,0);
+  return steps;
+}
+
+// writes a binary fielded file, with a second header, and reads it back
+int main() {
+  {
+    OFile of;
+    of.setBinaryFormat();
+    of.open("test.bin");
+    of.addConstantField("min_phi").printField("min_phi","-pi");
+    of.addConstantField("max_phi").printField("max_phi","pi");
+    for(int i=0; i<10; i++) {
+      of.printField("time",0.1*i).printField("step",i).printField("phi",1.0/(i+1)).printField();
+    }
+    for(int i=10; i<15; i++) {
+      of.printField("time",0.1*i).printField("psi",-1.0/(i+1)).printField();
+    }
+  }
+  std::ofstream os("output");
+  os.precision(17);
+  IFile ifile;
+  ifile.open("test.bin");
+  ifile.allowIgnoredFields();
+  os << "binary: " << ifile.isBinaryFormat() << "\n";
+  double time,value;
+  int step;
+  std::string min,max;
+  ifile.scanField("min_phi",min).scanField("max_phi",max);
+  os << "domain: " << min << " " << max << "\n";
+  for(int i=0; i<10; i++) {
+    ifile.scanField("time",time).scanField("step",step).scanField("phi",value).scanField();
+    os << time << " " << step << " " << value << " " << (value==1.0/(i+1)) << "\n";
+  }
+  // random access to the records after the first header
+  ifile.seekFrame(7);
+  ifile.scanField("step",step).scanField();
+  os << "frame 7: " << step << "\n";
+  ifile.seekFrame(2);
+  ifile.scanField("step",step).scanField();
+  os << "frame 2: " << step << "\n";
+  // the records after the second header
+  ifile.seekFrame(10);
+  while(ifile.scanField("time",time)) {
+    ifile.scanField("psi",value).scanField();
+    os << time << " " << value << "\n";
+  }
+  ifile.seekFrame(3);
+  ifile.scanField("psi",value).scanField();
+  os << "frame 3: " << value << "\n";
+  // a double read as a string keeps all its digits
+  IFile sfile;
+  sfile.open("test.bin");
+  sfile.allowIgnoredFields();
+  std::string phi;
+  sfile.scanField("phi",phi).scanField();
+  sfile.scanField("phi",phi).scanField();
+  os << "phi as a string: " << phi << " " << (std::stod(phi)==1.0/2) << "\n";
+  sfile.scanField("phi",phi).scanField();
+  os << "phi as a string: " << phi << " " << (std::stod(phi)==1.0/3) << "\n";
+  // binary and text files are read from pipes
+  for(const std::string name : {"steps.bin","steps.txt"}) {
+    OFile of;
+    if(name=="steps.bin") {
+      of.setBinaryFormat();
+    }
+    of.open(name);
+    for(int i=0; i<5; i++) {
+      of.printField("step",i).printField();
+    }
+  }
+  os << "binary file from a pipe:" << readFromPipe("steps.bin") << "\n";
+  os << "text file from a pipe:" << readFromPipe("steps.txt") << "\n";
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include "plumed/wrapper/Plumed.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace PLMD;
+
+// A large system where COORDINATION only involves a small subset of the atoms.
+// With NLIST only the nonzero derivatives are stored, and the forces must be
+// the same as the ones obtained without the neighbor list.
+
+namespace {
+
+const int natoms=16000;
+const double side=5.0;
+
+// simple generator, so that the positions are the same on all the platforms
+class Lcg {
+  unsigned long long state;
+public:
+  explicit Lcg(unsigned long long seed): state(seed) {}
+  double uniform() {
+    state=state*6364136223846793005ULL+1442695040888963407ULL;
+    return double(state>>11)/double(1ULL<<53);
+  }
+};
+
+struct Result {
+  double bias=0.0;
+  std::vector<double> forces;
+  std::vector<double> virial;
+};
+
+std::unique_ptr<Plumed> create(const std::string & input,const std::string & log) {
+  auto p=std::make_unique<Plumed>();
+  int n=natoms;
+  double dt=0.002;
+  p->cmd("setMDEngine","driver");
+  p->cmd("setNatoms",&n);
+  p->cmd("setTimestep",&dt);
+  p->cmd("setLogFile",log.c_str());
+  p->cmd("init");
+  p->cmd("readInputLine","c: COORDINATION GROUPA=1-50 GROUPB=51-16000 SWITCH={RATIONAL R_0=0.3 D_MAX=0.5}"+input);
+  p->cmd("readInputLine","r: RESTRAINT ARG=c AT=0 KAPPA=0.01");
+  return p;
+}
+
+Result step(Plumed & p,int istep,std::vector<double> & positions,std::vector<double> & masses) {
+  Result r;
+  r.forces.assign(3*natoms,0.0);
+  r.virial.assign(9,0.0);
+  std::vector<double> box(9,0.0);
+  box[0]=box[4]=box[8]=side;
+  p.cmd("setStep",&istep);
+  p.cmd("setBox",box.data());
+  p.cmd("setMasses",masses.data());
+  p.cmd("setPositions",positions.data());
+  p.cmd("setForces",r.forces.data());
+  p.cmd("setVirial",r.virial.data());
+  p.cmd("prepareCalc");
+  p.cmd("performCalc");
+  p.cmd("getBias",&r.bias);
+  return r;
+}
+
+}
+
+int main() {
+  std::ofstream out("output");
+  Lcg rng(1234);
+  std::vector<double> positions(3*natoms);
+  for(auto & x : positions) {
+    x=side*rng.uniform();
+  }
+  std::vector<double> masses(natoms,1.0);
+
+  auto dense=create("","log-dense");
+  auto sparse=create(" NLIST NL_CUTOFF=0.8 NL_STRIDE=5","log-sparse");
+
+  bool sameBias=true;
+  bool sameForces=true;
+  bool sameNonzero=true;
+  bool fewNonzero=true;
+  for(int istep=0; istep<10; ++istep) {
+    auto rd=step(*dense,istep,positions,masses);
+    auto rs=step(*sparse,istep,positions,masses);
+    if(std::fabs(rd.bias-rs.bias)>1e-10*std::max(1.0,std::fabs(rd.bias))) {
+      sameBias=false;
+    }
+    int nonzero=0;
+    for(int i=0; i<natoms; ++i) {
+      bool dz=true;
+      bool sz=true;
+      for(int j=0; j<3; ++j) {
+        if(std::fabs(rd.forces[3*i+j]-rs.forces[3*i+j])>1e-10) {
+          sameForces=false;
+        }
+        dz=dz && rd.forces[3*i+j]==0.0;
+        sz=sz && rs.forces[3*i+j]==0.0;
+      }
+      if(dz!=sz) {
+        sameNonzero=false;
+      }
+      if(!sz) {
+        nonzero++;
+      }
+    }
+    for(int j=0; j<9; ++j) {
+      if(std::fabs(rd.virial[j]-rs.virial[j])>1e-10) {
+        sameForces=false;
+      }
+    }
+    if(nonzero==0 || nonzero>natoms/4) {
+      fewNonzero=false;
+    }
+    // small displacements, so that the neighbor list remains valid
+    for(auto & x : positions) {
+      x+=0.01*(rng.uniform()-0.5);
+    }
+  }
+  out<<"same bias: "<<sameBias<<"\n";
+  out<<"same forces and virial: "<<sameForces<<"\n";
+  out<<"same atoms with nonzero forces: "<<sameNonzero<<"\n";
+  out<<"only a subset of the atoms has nonzero forces: "<<fewNonzero<<"\n";
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include "plumed/tools/CSRMatrix.h"
+#include <fstream>
+#include <vector>
+
+using PLMD::CSRMatrix;
+
+// simple generator, so that the matrices are the same on all the platforms
+class Lcg {
+  unsigned long long state;
+public:
+  explicit Lcg(unsigned long long seed): state(seed) {}
+  double uniform() {
+    state=state*6364136223846793005ULL+1442695040888963407ULL;
+    return double(state>>11)/double(1ULL<<53);
+  }
+};
+
+// a random sparse matrix, stored both in CSR format and as a dense matrix
+void randomMatrix(Lcg& rng,std::size_t nr,std::size_t nc,double density,CSRMatrix& a,std::vector<double>& dense) {
+  a.clear(nr,nc);
+  dense.assign(nr*nc,0.0);
+  for(std::size_t i=0; i<nr; ++i) {
+    for(std::size_t j=0; j<nc; ++j) {
+      if(rng.uniform()<density) {
+        // positive values, so that there are no cancellations in the products
+        const double v=0.5+rng.uniform();
+        a.columns.push_back(j);
+        a.values.push_back(v);
+        dense[i*nc+j]=v;
+      }
+    }
+    a.rowStart[i+1]=a.columns.size();
+  }
+}
+
+// check that the elements of c are the nonzero elements of the dense matrix, with increasing columns
+bool samePattern(const CSRMatrix& c,const std::vector<double>& dense) {
+  for(std::size_t i=0; i<c.nrows; ++i) {
+    std::size_t k=c.rowStart[i];
+    for(std::size_t j=0; j<c.ncols; ++j) {
+      if(dense[i*c.ncols+j]!=0.0) {
+        if(k>=c.rowStart[i+1] || c.columns[k]!=j) {
+          return false;
+        }
+        k++;
+      }
+    }
+    if(k!=c.rowStart[i+1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  std::ofstream out("output");
+  Lcg rng(4321);
+  for(const unsigned nt : {1,4}) {
+    for(const double density : {0.0,0.02,0.1,0.5}) {
+      const std::size_t n=60, m=45, p=70;
+      CSRMatrix a,b,c,at;
+      std::vector<double> da,db;
+      randomMatrix(rng,n,m,density,a,da);
+      randomMatrix(rng,m,p,density,b,db);
+      // dense product
+      std::vector<double> dc(n*p,0.0);
+      for(std::size_t i=0; i<n; ++i) {
+        for(std::size_t k=0; k<m; ++k) {
+          for(std::size_t j=0; j<p; ++j) {
+            dc[i*p+j]+=da[i*m+k]*db[k*p+j];
+          }
+        }
+      }
+      a.multiplyPattern(b,c,nt);
+      bool zeros=true;
+      for(const auto v : c.values) {
+        zeros=zeros && v==0.0;
+      }
+      // dense transpose
+      std::vector<double> dat(m*n);
+      for(std::size_t i=0; i<n; ++i) {
+        for(std::size_t j=0; j<m; ++j) {
+          dat[j*n+i]=da[i*m+j];
+        }
+      }
+      std::vector<std::size_t> origin;
+      a.transpose(at,&origin);
+      bool sameTranspose=samePattern(at,dat);
+      for(std::size_t i=0; i<at.nrows; ++i) {
+        for(std::size_t k=at.rowStart[i]; k<at.rowStart[i+1]; ++k) {
+          sameTranspose=sameTranspose && at.values[k]==dat[i*n+at.columns[k]] && at.values[k]==a.values[origin[k]];
+        }
+      }
+      out<<"threads "<<nt<<" density "<<density
+         <<" product pattern: "<<(samePattern(c,dc) && zeros ? "same" : "different")
+         <<" transpose: "<<(sameTranspose ? "same" : "different")<<"\n";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include "plumed/tools/ScratchArena.h"
+
+#include <fstream>
+
+using PLMD::ScratchArena;
+using PLMD::View;
+
+int main() {
+  std::ofstream os("output");
+  ScratchArena arena;
+  // a calculation that is repeated many times in the same step, as with numerical derivatives
+  for(unsigned k=0; k<1000; ++k) {
+    ScratchArena::Scope scope(arena);
+    View<double> a( arena.get<double>( 1000 ) );
+    View<double> b( arena.get<double>( 5000 ) );
+    a[0]=b[0]=1.0;
+  }
+  os << "heap allocations after 1000 scoped calculations: " << arena.getNumberOfHeapAllocations() << "\n";
+  os << "peak memory: " << arena.getPeakMemory() << "\n";
+  // nested scopes give back only what was taken inside them
+  {
+    ScratchArena::Scope outer(arena);
+    View<double> a( arena.get<double>( 10 ) );
+    auto m=arena.mark();
+    {
+      ScratchArena::Scope inner(arena);
+      arena.get<double>( 100 );
+    }
+    auto n=arena.mark();
+    os << "inner scope rewound: " << (m.block==n.block && m.offset==n.offset && m.used==n.used ? "yes" : "no") << "\n";
+  }
+  os << "empty after outer scope: " << (arena.mark().used==0 ? "yes" : "no") << "\n";
+  // a very large step is not kept in memory
+  arena.setMaxRetained( 1024*1024 );
+  {
+    ScratchArena::Scope scope(arena);
+    arena.get<char>( 2*1024*1024 );
+    arena.get<char>( 2*1024*1024 );
+  }
+  const unsigned long nheap=arena.getNumberOfHeapAllocations();
+  {
+    ScratchArena::Scope scope(arena);
+    arena.get<char>( 512*1024 );
+  }
+  arena.reset();
+  os << "heap allocations for a small step after the cap: " << arena.getNumberOfHeapAllocations()-nheap << "\n";
+  os << "peak memory: " << arena.getPeakMemory() << "\n";
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include "plumed/tools/SharedMemoryRing.h"
+#include "plumed/tools/Exception.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using PLMD::SharedMemoryRing;
+using PLMD::View;
+
+// each process publishes n records and reads all the records of the other one
+// the records are checked in the order in which they have been published
+unsigned exchange(unsigned id, unsigned n, const std::string& fname) {
+  SharedMemoryRing ring;
+  ring.open(fname,2,id,3,n);
+  std::vector<double> record(3);
+  for(unsigned i=0; i<n; ++i) {
+    record[0]=id;
+    record[1]=i;
+    record[2]=i*i;
+    ring.publish(View<const double>(record.data(),record.size()));
+  }
+  unsigned other=1-id, errors=0;
+  std::size_t cursor=0;
+  while(cursor<n) {
+    const std::size_t start=cursor;
+    if(!ring.read(other,cursor,record)) {
+      continue;
+    }
+    if(record[0]!=other || record[1]!=start || record[2]!=start*start) {
+      errors++;
+    }
+  }
+  return errors;
+}
+
+// a process that publishes n records and stops without closing the file
+void crash(const std::string& fname, unsigned id, unsigned n) {
+  pid_t child=fork();
+  if(child==0) {
+    auto ring=new SharedMemoryRing;
+    ring->open(fname,2,id,2,4);
+    std::vector<double> record(2,1.0);
+    for(unsigned i=0; i<n; ++i) {
+      ring->publish(View<const double>(record.data(),record.size()));
+    }
+    _exit(0);
+  }
+  int status;
+  waitpid(child,&status,0);
+}
+
+int main() {
+  std::ofstream os("output");
+  const std::string fname="./shared-memory-ring";
+  os << "shared memory available: " << SharedMemoryRing::available() << "\n";
+
+  // two processes exchange records
+  pid_t child=fork();
+  if(child==0) {
+    _exit(exchange(1,1000,fname)==0 ? 0 : 1);
+  }
+  const unsigned errors=exchange(0,1000,fname);
+  int status;
+  waitpid(child,&status,0);
+  os << "errors in parent: " << errors << "\n";
+  os << "errors in child: " << (WIFEXITED(status) ? WEXITSTATUS(status) : -1) << "\n";
+  // the file is deleted by the last process that leaves
+  os << "file deleted: " << (access(fname.c_str(),F_OK)!=0) << "\n";
+
+  // a record that is overwritten before being read is detected
+  SharedMemoryRing ring;
+  ring.open(fname,1,0,2,4);
+  std::vector<double> record(2,1.0);
+  for(unsigned i=0; i<6; ++i) {
+    ring.publish(View<const double>(record.data(),record.size()));
+  }
+  os << "published: " << ring.getNumberOfPublished(0) << "\n";
+  std::size_t cursor=0;
+  try {
+    ring.read(0,cursor,record);
+    os << "overwritten record not detected\n";
+  } catch(const PLMD::Exception&) {
+    os << "overwritten record detected\n";
+  }
+  cursor=2;
+  unsigned nread=0;
+  while(ring.read(0,cursor,record)) {
+    nread++;
+  }
+  os << "read from cursor 2: " << nread << "\n";
+
+  // processes with different settings cannot use the same file
+  SharedMemoryRing other;
+  try {
+    other.open(fname,1,0,3,4);
+    os << "different settings not detected\n";
+  } catch(const PLMD::Exception&) {
+    os << "different settings detected\n";
+  }
+  ring.close();
+  os << "file deleted: " << (access(fname.c_str(),F_OK)!=0) << "\n";
+
+  // a file left by a process that was killed is initialized again
+  crash(fname,0,3);
+  os << "file left by a killed process: " << (access(fname.c_str(),F_OK)==0) << "\n";
+  ring.open(fname,2,0,2,4);
+  os << "published after a crash: " << ring.getNumberOfPublished(0) << "\n";
+  // a process that is killed while the other is running is replaced by the one that restarts it
+  crash(fname,1,2);
+  other.open(fname,2,1,2,4);
+  os << "published by the restarted process: " << other.getNumberOfPublished(1) << "\n";
+  other.close();
+  ring.close();
+  os << "file deleted: " << (access(fname.c_str(),F_OK)!=0) << "\n";
+  return 0;
+}
@@ -0,0 +1,62 @@
+#include "plumed/tools/SwitchingFunction.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using PLMD::SwitchingFunction;
+using PLMD::SwitchingFunctionAccelerable;
+using PLMD::View;
+
+//compares the functions calculated on a block of distances with the ones calculated one by one
+template<typename SW>
+double maxDifference(const SW& sw, const std::vector<double>& d2) {
+  std::vector<double> res(d2.size()), df(d2.size());
+  sw.calculateSqr(View<const double>(d2.data(),d2.size()),
+                  View<double>(res.data(),res.size()),
+                  View<double>(df.data(),df.size()));
+  double maxdiff=0.0;
+  for(unsigned i=0; i<d2.size(); ++i) {
+    double deriv;
+    const double value=sw.calculateSqr(d2[i],deriv);
+    maxdiff=std::max(maxdiff,std::fabs(value-res[i]));
+    maxdiff=std::max(maxdiff,std::fabs(deriv-df[i]));
+  }
+  return maxdiff;
+}
+
+int main() {
+  std::ofstream os("output");
+  // the distances include zero, d_0, r_0, d_max and points beyond d_max
+  std::vector<double> d2;
+  for(unsigned i=0; i<=37; ++i) {
+    const double d=i/10.0;
+    d2.push_back(d*d);
+  }
+  for(const std::string definition : {
+        "RATIONAL R_0=1.3 D_MAX=2.6",
+        "RATIONAL R_0=1.3 NN=6 MM=10 D_MAX=2.6",
+        "RATIONAL R_0=1.3 NN=4 D_MAX=2.6 NOSTRETCH",
+        "RATIONAL R_0=1.3 NN=5 MM=11 D_MAX=2.6",
+        "RATIONAL R_0=1.3 NN=12",
+        "EXP R_0=0.8 D_0=0.5 D_MAX=2.6",
+        "GAUSSIAN R_0=1.0 D_0=0.3 D_MAX=2.6",
+        "GAUSSIAN R_0=1.0 D_0=0.0 D_MAX=2.6",
+        "SMAP R_0=1.3 A=3 B=2 D_MAX=2.6",
+        "SMAP R_0=0.9 D_0=0.4 A=8 B=4 D_MAX=2.6",
+        "TANH R_0=1.3 D_MAX=2.6",
+        "CUBIC D_MAX=2.6 D_0=0.6"
+      }) {
+    std::string error;
+    SwitchingFunction sw;
+    sw.set(definition,error);
+    SwitchingFunctionAccelerable swa;
+    swa.set(definition,error);
+    // the vectorized math functions can differ in the last digits
+    os << definition << " : "
+       << (maxDifference(sw,d2)<1e-12 ? "same" : "different") << " "
+       << (maxDifference(swa,d2)<1e-12 ? "same" : "different") << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include "plumed/tools/TrajectoryParser.h"
+
+#include <cstdio>
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using PLMD::TrajectoryParser;
+
+std::vector<double> readFrame(TrajectoryParser& parser) {
+  const int natoms=parser.nOfAtoms();
+  std::vector<double> masses(natoms),charges(natoms),coordinates(3*natoms),cell(9);
+  long long int step=0;
+  double timeStep;
+  if(parser.readFrame(1,false,false,0,natoms,step,timeStep,masses.data(),charges.data(),coordinates.data(),cell.data())) {
+    return {};
+  }
+  coordinates.insert(coordinates.end(),cell.begin(),cell.end());
+  return coordinates;
+}
+
+// copies the first size bytes of a file (all of it if size is negative)
+void copyFile(const std::string& from, const std::string& to, long size=-1) {
+  std::ifstream is(from,std::ios::binary);
+  std::vector<char> data((std::istreambuf_iterator<char>(is)),std::istreambuf_iterator<char>());
+  if(size>=0) {
+    data.resize(size);
+  }
+  std::ofstream os(to,std::ios::binary);
+  os.write(data.data(),data.size());
+}
+
+void check(std::ofstream& os, const std::string& type, const std::string& file) {
+  std::vector<std::vector<double>> frames;
+  {
+    TrajectoryParser parser;
+    parser.init(type,file);
+    for(auto frame=readFrame(parser); !frame.empty(); frame=readFrame(parser)) {
+      frames.push_back(frame);
+    }
+  }
+  // a copy that ends in the middle of the last frame, as if it was still being written
+  std::ifstream is(file,std::ios::binary|std::ios::ate);
+  const long size=is.tellg();
+  const std::string copy="copy."+type;
+  copyFile(file,copy,size/2);
+  {
+    TrajectoryParser parser;
+    parser.init(type,copy);
+    os << type << " partial file: " << parser.nOfFrames() << " frames\n";
+  }
+  // the index is extended when the file grows
+  copyFile(file,copy);
+  TrajectoryParser parser;
+  parser.init(type,copy);
+  os << type << " complete file: " << parser.nOfFrames() << " frames out of " << frames.size() << "\n";
+  // the frames are read backwards
+  bool same=true;
+  for(unsigned k=frames.size(); k>0; k--) {
+    same=same && !parser.seekFrame(k-1) && readFrame(parser)==frames[k-1];
+  }
+  os << type << " backwards: " << (same ? "same" : "different") << "\n";
+  os << type << " after the end: " << parser.seekFrame(frames.size()).value_or("ok") << "\n";
+  parser.rewind();
+  os << type << " after rewind: " << (readFrame(parser)==frames[0] ? "same" : "different") << "\n";
+  // the index is reused by another parser
+  TrajectoryParser other;
+  other.init(type,copy);
+  os << type << " index reused: " << other.nOfFrames() << " frames\n";
+  // the trajectory is replaced by a shorter one, the index is built again
+  copyFile(file,copy,size/2);
+  TrajectoryParser shorter;
+  shorter.init(type,copy);
+  os << type << " replaced file: " << shorter.nOfFrames() << " frames\n";
+  // the temporary files used to write the index are renamed
+  const std::string tmp=copy+".idx.tmp."+std::to_string(::getpid());
+  os << type << " temporary index left: " << (std::ifstream(tmp) ? "yes" : "no") << "\n";
+}
+
+int main() {
+  std::ofstream os("output");
+  check(os,"xtc","traj.xtc");
+  check(os,"trr","test_traj.trr");
+  return 0;
+}
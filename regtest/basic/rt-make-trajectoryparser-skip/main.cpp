@@ -0,0 +1,71 @@
+#include "plumed/tools/TrajectoryParser.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using PLMD::TrajectoryParser;
+
+// reads a frame, the number of atoms is only known after the header has been read
+bool readOne(TrajectoryParser& parser, std::vector<double>& frame) {
+  long long int step=0;
+  double timeStep;
+  if(parser.readHeader(step,timeStep)) {
+    return false;
+  }
+  const int natoms=parser.nOfAtoms();
+  std::vector<double> masses(natoms),charges(natoms),coordinates(3*natoms),cell(9);
+  if(parser.readAtoms(1,false,false,0,natoms,step,masses.data(),charges.data(),coordinates.data(),cell.data())) {
+    return false;
+  }
+  coordinates.insert(coordinates.end(),cell.begin(),cell.end());
+  frame.swap(coordinates);
+  return true;
+}
+
+// reads all the frames of a trajectory
+std::vector<std::vector<double>> readAll(const std::string& type, const std::string& file) {
+  TrajectoryParser parser;
+  parser.init(type,file);
+  std::vector<std::vector<double>> frames;
+  std::vector<double> frame;
+  while(readOne(parser,frame)) {
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+void check(std::ofstream& os, const std::string& type, const std::string& file) {
+  const auto frames=readAll(type,file);
+  // count the frames skipping them
+  unsigned nframes=0;
+  {
+    TrajectoryParser parser;
+    parser.init(type,file);
+    while(!parser.skipFrame()) {
+      nframes++;
+    }
+  }
+  // read each frame after skipping the previous ones
+  bool same=true;
+  for(unsigned k=0; k<frames.size(); k++) {
+    TrajectoryParser parser;
+    parser.init(type,file);
+    for(unsigned i=0; i<k; i++) {
+      parser.skipFrame();
+    }
+    std::vector<double> frame;
+    same=same && readOne(parser,frame) && frame==frames[k];
+  }
+  os << type << " frames " << frames.size() << " skipped " << nframes << " " << (same ? "same" : "different") << "\n";
+}
+
+int main() {
+  std::ofstream os("output");
+  check(os,"xyz","trajectory.xyz");
+  check(os,"gro","traj_10dec.gro");
+  check(os,"trr","test_traj.trr");
+  check(os,"xtc","traj.xtc");
+  check(os,"dlp4","HISTORY");
+  return 0;
+}
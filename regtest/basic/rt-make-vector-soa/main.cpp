@@ -0,0 +1,87 @@
+#include "plumed/tools/VectorSoA.h"
+#include <cstdint>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+using PLMD::Vector;
+using PLMD::VectorSoA;
+using PLMD::View;
+
+bool aligned(const double* p) {
+  return reinterpret_cast<std::uintptr_t>(p)%64==0;
+}
+
+// check that soa contains v, with aligned arrays and zero padding
+bool check(const VectorSoA& soa,const std::vector<Vector>& v) {
+  if(soa.size()!=v.size()) {
+    return false;
+  }
+  if(v.empty()) {
+    return soa.x()==nullptr && soa.y()==nullptr && soa.z()==nullptr;
+  }
+  if(!aligned(soa.x()) || !aligned(soa.y()) || !aligned(soa.z())) {
+    return false;
+  }
+  for(std::size_t i=0; i<v.size(); ++i) {
+    const Vector w=soa.get(i);
+    if(w[0]!=v[i][0] || w[1]!=v[i][1] || w[2]!=v[i][2]) {
+      return false;
+    }
+    if(soa.x()[i]!=v[i][0] || soa.y()[i]!=v[i][1] || soa.z()[i]!=v[i][2]) {
+      return false;
+    }
+  }
+  // the padding between the arrays is zero
+  for(const double* p=soa.x()+v.size(); p<soa.y(); ++p) {
+    if(*p!=0.0) {
+      return false;
+    }
+  }
+  for(const double* p=soa.y()+v.size(); p<soa.z(); ++p) {
+    if(*p!=0.0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  std::ofstream out("output");
+  for(const std::size_t n : {0,1,7,8,9,100}) {
+    std::vector<Vector> v(n);
+    for(std::size_t i=0; i<n; ++i) {
+      v[i]=Vector(i+0.1,-2.0*i,i*i+0.5);
+    }
+    VectorSoA soa;
+    soa.assign(View<const Vector>(v.data(),v.size()));
+    out<<"size "<<n<<"\n";
+    out<<"  assign: "<<check(soa,v)<<"\n";
+
+    VectorSoA copy(soa);
+    out<<"  copy: "<<(check(copy,v) && check(soa,v) && (n==0 || copy.x()!=soa.x()))<<"\n";
+
+    VectorSoA assigned(3);
+    assigned=soa;
+    out<<"  copy assignment: "<<check(assigned,v)<<"\n";
+
+    const double* data=copy.x();
+    VectorSoA moved(std::move(copy));
+    // the moved-from object is empty and does not point to the memory of the new one
+    out<<"  move: "<<(check(moved,v) && moved.x()==data && check(copy,{}))<<"\n";
+
+    VectorSoA moveAssigned(5);
+    moveAssigned=std::move(moved);
+    out<<"  move assignment: "<<(check(moveAssigned,v) && moveAssigned.x()==data && check(moved,{}))<<"\n";
+
+    // a moved-from object can be used again
+    moved.assign(View<const Vector>(v.data(),v.size()));
+    out<<"  reuse after move: "<<check(moved,v)<<"\n";
+
+    // the content is not preserved when the size changes, the new arrays are zero
+    moveAssigned.resize(n+3);
+    moveAssigned.resize(n);
+    out<<"  resize: "<<check(moveAssigned,std::vector<Vector>(n))<<"\n";
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include "plumed/tools/AtomNumber.h"
+#include "plumed/tools/Communicator.h"
+#include "plumed/tools/NeighborList.h"
+#include "plumed/tools/Pbc.h"
+#include "plumed/tools/AtomDistribution.h"
+#include "plumed/tools/Random.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#define check(arg) (((arg)) ? "pass\n" : "not pass\n")
+
+constexpr bool serial = false;
+
+// the sorted list of neighbors of each atom, so that lists built in different orders can be compared
+std::vector<std::vector<unsigned>> getAllNeighbors(const PLMD::NeighborList& nl, unsigned natoms) {
+  std::vector<std::vector<unsigned>> all(natoms);
+  for(unsigned i=0; i<natoms; ++i) {
+    all[i]=nl.getNeighbors(i);
+    std::sort(all[i].begin(),all[i].end());
+  }
+  return all;
+}
+
+void testSkin(const bool doubleList, const bool do_pbc, std::ostream& ofs, PLMD::Communicator& cm) {
+  using namespace PLMD;
+  Pbc pbc{};
+  Random rng;
+  std::vector<double> box(9);
+  std::vector<Vector> atoms(6*6*6);
+  auto d = AtomDistribution::getAtomDistribution("sc");
+  d->frame(atoms,box,0,rng);
+  Tensor mybox{box[0], box[1], box[2], box[3], box[4], box[5], box[6], box[7], box[8]};
+  pbc.setBox(mybox);
+  const double spacing=box[0]/6;
+  const double cutoff=spacing*1.5;
+  const double skin=spacing*0.2;
+  std::vector<AtomNumber> indexesA, indexesB;
+  for(unsigned i=0; i<atoms.size(); ++i) {
+    if(doubleList && i%2==1) {
+      indexesB.push_back(AtomNumber().setIndex(i));
+    } else {
+      indexesA.push_back(AtomNumber().setIndex(i));
+    }
+  }
+  std::vector<Vector> positions;
+  for(const auto & a : indexesA) {
+    positions.push_back(atoms[a.index()]);
+  }
+  for(const auto & b : indexesB) {
+    positions.push_back(atoms[b.index()]);
+  }
+
+  std::string name=std::string("[")+(doubleList?"Two lists":"Single list")+", pbc "+(do_pbc?"on":"off")+"] ";
+  auto makeList=[&](double mycutoff, double myskin) {
+    if(doubleList) {
+      return NeighborList(indexesA,indexesB,serial,false,do_pbc,pbc,cm,mycutoff,1,false,myskin);
+    }
+    return NeighborList(indexesA,serial,do_pbc,pbc,cm,mycutoff,1,false,myskin);
+  };
+  auto reference=makeList(cutoff,0.0);
+  auto verlet=makeList(cutoff,skin);
+  reference.update(positions);
+  verlet.update(positions);
+  ofs << name << "same pairs as the full list: "
+      << check(getAllNeighbors(reference,positions.size())==getAllNeighbors(verlet,positions.size()));
+
+  // all the atoms move a bit less than half of the skin: the list is kept
+  for(unsigned i=0; i<positions.size(); ++i) {
+    positions[i]+=Vector(0.45*skin,0.0,0.0)*((i%2==0)?1.0:-1.0);
+  }
+  verlet.update(positions);
+  ofs << name << "not rebuilt after a small displacement: " << check(verlet.getNumberOfRebuilds()==1);
+
+  // one atom moves more than half of the skin: the list is rebuilt
+  positions[0]+=Vector(0.0,0.3*skin,0.0);
+  verlet.update(positions);
+  reference.update(positions);
+  ofs << name << "rebuilt after a large displacement: " << check(verlet.getNumberOfRebuilds()==2);
+  ofs << name << "same pairs as the full list after rebuilding: "
+      << check(getAllNeighbors(reference,positions.size())==getAllNeighbors(verlet,positions.size()));
+  ofs << name << "updates " << verlet.getNumberOfUpdates() << " rebuilds " << verlet.getNumberOfRebuilds() << "\n";
+}
+
+int main() {
+  PLMD::Communicator comm;
+  std::ofstream ofs("skinTest");
+  testSkin(false,false,ofs,comm);
+  testSkin(false,true, ofs,comm);
+  testSkin(true, false,ofs,comm);
+  testSkin(true, true, ofs,comm);
+}
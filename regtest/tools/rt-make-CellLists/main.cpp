@@ -27,6 +27,7 @@ void testIndexes (PLMD::Communicator &comm);
 void testRequiredCells (PLMD::Communicator &comm);
 void testRequiredCellsNotOrtho(PLMD::Communicator &comm);
 void testWithEmptyCells (PLMD::Communicator &comm);
+void testSpatialOrder (PLMD::Communicator &comm);
 void bench (PLMD::Communicator &comm);
 
 int main(int argc,char**argv) {
@@ -45,6 +46,7 @@ int main(int argc,char**argv) {
     testWithEmptyCells(comm);
     testRequiredCells(comm);
     testRequiredCellsNotOrtho(comm);
+    testSpatialOrder(comm);
     //bench(comm);
   }
 #ifdef USE_MPI
@@ -312,6 +314,68 @@ void testRequiredCellsNotOrtho (PLMD::Communicator &comm) {
   }
 }
 
+void testSpatialOrder (PLMD::Communicator &comm) {
+  std::string rank="";
+  if(auto myrank = comm.Get_rank(); myrank!=0) {
+    rank=std::to_string(myrank);
+  }
+  tee ofs ("SpatialOrder"+rank);
+  Random rng;
+  std::vector<Vector> atoms(500);
+  for(auto & a : atoms) {
+    a=Vector(10.0*rng.RandU01(),10.0*rng.RandU01(),10.0*rng.RandU01());
+  }
+  std::vector<unsigned> indices(atoms.size());
+  std::iota(indices.begin(),indices.end(),0);
+  Pbc pbc;
+  pbc.setBox(Tensor{
+    10.0,  0.0,  0.0,
+    0.0, 10.0,  0.0,
+    0.0,  0.0, 10.0
+  });
+  LinkCells cells(comm);
+  cells.setCutoff(2.5);
+  cells.setupCells(make_const_view(atoms),pbc);
+  // every cell appears once in the order of the cells
+  auto cellOrder=cells.getCellOrder();
+  std::sort(cellOrder.begin(),cellOrder.end());
+  bool isPermutation=cellOrder.size()==cells.getNumberOfCells();
+  for(unsigned i=0; i<cellOrder.size(); ++i) {
+    isPermutation &= cellOrder[i]==i;
+  }
+  ofs << "the cells are all in the order: " << (isPermutation?"true":"false") << "\n";
+  // the atoms are visited following the order of the cells
+  std::vector<unsigned> order;
+  cells.getSpatialOrder(make_const_view(atoms),order);
+  std::vector<unsigned> rankOfCell(cells.getNumberOfCells());
+  for(unsigned i=0; i<cells.getNumberOfCells(); ++i) {
+    rankOfCell[cells.getCellOrder()[i]]=i;
+  }
+  bool sorted=order.size()==atoms.size();
+  for(unsigned k=1; k<order.size(); ++k) {
+    sorted &= rankOfCell[cells.findCell(atoms[order[k-1]])]<=rankOfCell[cells.findCell(atoms[order[k]])];
+  }
+  auto visited=order;
+  std::sort(visited.begin(),visited.end());
+  for(unsigned i=0; i<visited.size(); ++i) {
+    sorted &= visited[i]==i;
+  }
+  ofs << "the atoms are visited in cell order: " << (sorted?"true":"false") << "\n";
+  // the positions stored in the collection are the ones of the atoms in the same cell
+  auto collection = cells.getCollection(make_const_view(atoms),
+                                        make_const_view(indices));
+  bool samepositions=true;
+  for(unsigned i=0; i< cells.getNumberOfCells(); ++i) {
+    auto thiscell=collection.getCellIndexes(i);
+    auto thesepositions=collection.getCellPositions(i);
+    for(unsigned j=0; j<thiscell.size(); ++j) {
+      samepositions &= delta(atoms[thiscell[j]],thesepositions[j]).modulo2()==0.0;
+      samepositions &= cells.findCell(thesepositions[j])==i;
+    }
+  }
+  ofs << "the positions are sorted by cell: " << (samepositions?"true":"false") << "\n";
+}
+
 void testWithEmptyCells (PLMD::Communicator &comm) {
   std::string rank="";
   if(auto myrank = comm.Get_rank(); myrank!=0) {
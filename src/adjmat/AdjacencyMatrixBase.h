@@ -38,6 +38,7 @@ struct AdjacencyMatrixData {
   T matrixdata;
   bool usepbc{true};
   bool components{false};
+  bool rowsums{false};
   std::size_t nlists{0};
   unsigned natoms_per_list{0};
   std::vector<std::size_t> nlist_v;
@@ -51,7 +52,7 @@ struct AdjacencyMatrixData {
   }
 #ifdef __PLUMED_HAS_OPENACC
   void toACCDevice() const {
-#pragma acc enter data copyin(this[0:1],usepbc,components,nlists, \
+#pragma acc enter data copyin(this[0:1],usepbc,components,rowsums,nlists, \
                               natoms_per_list,nlist[0:nlist_v.size()], \
                               natoms_per_three_list, \
                               nlist_three[0:nlist_three_v.size()])
@@ -62,7 +63,7 @@ struct AdjacencyMatrixData {
 #pragma acc exit data delete(nlist_three[0:nlist_three_v.size()], \
                              natoms_per_three_list, \
                              nlist[0:nlist_v.size()], natoms_per_list, \
-                             nlists, components, usepbc, this[0:1])
+                             nlists, rowsums, components, usepbc, this[0:1])
   }
 #endif //__PLUMED_HAS_OPENACC
 };
@@ -105,7 +106,7 @@ public:
   typedef typename PTM::ParallelActionsOutput ParallelActionsOutput;
 private:
   PTM taskmanager;
-  bool nopbc, read_one_group;
+  bool nopbc, read_one_group, rowsums;
   LinkCells linkcells, threecells;
   std::vector<unsigned> ablocks, threeblocks;
   double nl_cut, nl_cut2;
@@ -121,6 +122,10 @@ public:
   void applyNonZeroRankForces( std::vector<double>& outforces ) override ;
   void getInputData( std::vector<double>& inputdata ) const override;
   void getInputData( std::vector<float>& inputdata ) const override;
+  void transferStashToValues( const std::vector<unsigned>& partialTaskList, const std::vector<double>& stash ) override ;
+  void transferStashToValues( const std::vector<unsigned>& partialTaskList, const std::vector<float>& stash ) override ;
+  void transferForcesToStash( const std::vector<unsigned>& partialTaskList, std::vector<double>& stash ) const override ;
+  void transferForcesToStash( const std::vector<unsigned>& partialTaskList, std::vector<float>& stash ) const override ;
   std::string writeInGraph() const override {
     if constexpr ( std::is_same_v<ContactMatrix,CV> ) {
       //TODO:this will change to  std::is_same_v<ContactMatrix<precision>,CV> when adding the mixed precision to the contact matrix
@@ -155,6 +160,7 @@ void AdjacencyMatrixBase<CV, myPTM>::registerKeywords( Keywords& keys ) {
   keys.reserve("atoms","GROUPC","a group of atoms that must be summed over when calculating each element of the adjacency matrix");
   keys.addFlag("COMPONENTS",false,"also calculate the components of the vector connecting the atoms in the contact matrix");
   keys.addFlag("NOPBC",false,"don't use pbc");
+  keys.addFlag("ROW_SUMS",false,"calculate the vector containing the sums of the rows of the matrix.  The matrix is never stored so this uses less memory than multiplying the matrix by a vector of ones");
   keys.add("compulsory","NL_CUTOFF","0.0","The cutoff for the neighbor list.  A value of 0 means we are not using a neighbor list");
   keys.add("compulsory","NL_STRIDE","1","The frequency with which we are updating the atoms in the neighbor list");
   CV::registerKeywords( keys );
@@ -163,7 +169,7 @@ void AdjacencyMatrixBase<CV, myPTM>::registerKeywords( Keywords& keys ) {
   keys.addOutputComponent("x","COMPONENTS","matrix","the projection of the bond on the x axis");
   keys.addOutputComponent("y","COMPONENTS","matrix","the projection of the bond on the y axis");
   keys.addOutputComponent("z","COMPONENTS","matrix","the projection of the bond on the z axis");
-  keys.setValueDescription("matrix","a matrix containing the weights for the bonds between each pair of atoms");
+  keys.setValueDescription("vector/matrix","a matrix containing the weights for the bonds between each pair of atoms or, if ROW_SUMS is used, a vector containing the sums of the rows of this matrix");
   keys.addDOI("10.1021/acs.jctc.6b01073");
 }
 
@@ -173,6 +179,7 @@ AdjacencyMatrixBase<CV, myPTM>::AdjacencyMatrixBase(const ActionOptions& ao):
   ActionWithMatrix(ao),
   taskmanager(this),
   read_one_group(false),
+  rowsums(false),
   linkcells(comm),
   threecells(comm) {
   std::vector<std::size_t> shape(2);
@@ -275,14 +282,26 @@ AdjacencyMatrixBase<CV, myPTM>::AdjacencyMatrixBase(const ActionOptions& ao):
   bool components;
   parseFlag("COMPONENTS",components);
   parseFlag("NOPBC",nopbc);
-  if( !components ) {
+  parseFlag("ROW_SUMS",rowsums);
+  if( rowsums ) {
+    if( components ) {
+      error("cannot use COMPONENTS and ROW_SUMS together");
+    }
+    log.printf("  calculating the sums of the rows of the matrix without storing the matrix\n");
+    std::vector<std::size_t> vshape(1);
+    vshape[0]=shape[0];
+    addValue( vshape );
+    setNotPeriodic();
+  } else if( !components ) {
     addValue( shape );
     setNotPeriodic();
   } else {
     addComponent( "w", shape );
     componentIsNotPeriodic("w");
   }
-  getPntrToComponent(0)->setDerivativeIsZeroWhenValueIsZero();
+  if( !rowsums ) {
+    getPntrToComponent(0)->setDerivativeIsZeroWhenValueIsZero();
+  }
   // Stuff for neighbor list
   parse("NL_CUTOFF",nl_cut);
   nl_cut2=nl_cut*nl_cut;
@@ -306,6 +325,7 @@ AdjacencyMatrixBase<CV, myPTM>::AdjacencyMatrixBase(const ActionOptions& ao):
   AdjacencyMatrixData<CV> matdata;
   matdata.usepbc = !nopbc;
   matdata.components = components;
+  matdata.rowsums = rowsums;
   matdata.nlists = getPntrToComponent(0)->getShape()[0];
   matdata.matrixdata.parseInput( this );
   taskmanager.setActionInput( matdata );
@@ -333,7 +353,7 @@ template <class CV, typename myPTM>
 void AdjacencyMatrixBase<CV, myPTM>::setLinkCellCutoff( const bool& symmetric,
     const double& lcut,
     double tcut ) {
-  if( read_one_group && symmetric ) {
+  if( read_one_group && symmetric && !rowsums ) {
     getPntrToComponent(0)->setSymmetric( true );
   }
   if( nl_cut>0 && lcut>nl_cut ) {
@@ -390,6 +410,42 @@ void AdjacencyMatrixBase<CV, myPTM>::getInputData( std::vector<float>& inputdata
   }
 }
 
+template <class CV, typename myPTM>
+void AdjacencyMatrixBase<CV, myPTM>::transferStashToValues( const std::vector<unsigned>& partialTaskList, const std::vector<double>& stash ) {
+  if( rowsums ) {
+    ActionWithVector::transferStashToValues( partialTaskList, stash );
+  } else {
+    ActionWithMatrix::transferStashToValues( partialTaskList, stash );
+  }
+}
+
+template <class CV, typename myPTM>
+void AdjacencyMatrixBase<CV, myPTM>::transferStashToValues( const std::vector<unsigned>& partialTaskList, const std::vector<float>& stash ) {
+  if( rowsums ) {
+    ActionWithVector::transferStashToValues( partialTaskList, stash );
+  } else {
+    ActionWithMatrix::transferStashToValues( partialTaskList, stash );
+  }
+}
+
+template <class CV, typename myPTM>
+void AdjacencyMatrixBase<CV, myPTM>::transferForcesToStash( const std::vector<unsigned>& partialTaskList, std::vector<double>& stash ) const {
+  if( rowsums ) {
+    ActionWithVector::transferForcesToStash( partialTaskList, stash );
+  } else {
+    ActionWithMatrix::transferForcesToStash( partialTaskList, stash );
+  }
+}
+
+template <class CV, typename myPTM>
+void AdjacencyMatrixBase<CV, myPTM>::transferForcesToStash( const std::vector<unsigned>& partialTaskList, std::vector<float>& stash ) const {
+  if( rowsums ) {
+    ActionWithVector::transferForcesToStash( partialTaskList, stash );
+  } else {
+    ActionWithMatrix::transferForcesToStash( partialTaskList, stash );
+  }
+}
+
 template <class CV, typename myPTM>
 void AdjacencyMatrixBase<CV, myPTM>::getMatrixColumnTitles( std::vector<std::string>& argnames ) const {
   std::string num;
@@ -473,6 +529,16 @@ void AdjacencyMatrixBase<CV, myPTM>::calculate() {
   // neighbourhood of the central atom
   maxcol = maxcol-1;
 
+  if( rowsums ) {
+    // Each row is a single value that depends on the central atom, all its neighbours and the third atoms
+    unsigned nder = 3 + 3*maxcol + 3*matdata.natoms_per_three_list + virialSize;
+    taskmanager.setupParallelTaskManager( nder, getNumberOfDerivatives() );
+    // The workspace holds the atoms and the derivatives of one element of the matrix
+    taskmanager.setWorkspaceSize( 3*(maxcol + 2 + matdata.natoms_per_three_list) + 6 + 3*matdata.natoms_per_three_list + virialSize );
+    taskmanager.runAllTasks();
+    return;
+  }
+
   // Reshape the matrix store if the number of columns has changed
   if( maxcol!=myval->getNumberOfColumns() ) {
     for(unsigned i=0; i<getNumberOfComponents(); ++i) {
@@ -554,6 +620,45 @@ void AdjacencyMatrixBase<CV, myPTM>::performTask( std::size_t task_index,
 
   // And calculate this row of the matrices
   std::size_t nderiv(6 + 3*adjinp.natoms + virialSize);
+  if( actiondata.rowsums ) {
+    // The elements are added to the sum of the row as soon as they are computed so the row is never stored
+    if( !input.noderiv ) {
+      for(unsigned i=0; i<output.derivatives.size(); ++i) {
+        output.derivatives[i] = 0.0;
+      }
+    }
+    View<double> pairderiv( output.buffer.data() + 3*(nneigh + n3neigh), nderiv );
+    const std::size_t threestart = 3*nneigh;
+    const std::size_t virstart = threestart + 3*adjinp.natoms;
+    double rowsum = 0.0;
+    for(unsigned i=1; i<nneigh; ++i ) {
+      adjinp.pos = Vector(atoms[i][0],atoms[i][1],atoms[i][2]);
+      double weight = 0.0;
+      if( !input.noderiv ) {
+        for(unsigned k=0; k<nderiv; ++k) {
+          pairderiv[k] = 0.0;
+        }
+      }
+      MatrixOutput adjout{View<double,1>{&weight}, pairderiv};
+      CV::calculateWeight( actiondata.matrixdata, adjinp, adjout );
+      rowsum += weight;
+      if( input.noderiv ) {
+        continue ;
+      }
+      for(unsigned k=0; k<3; ++k) {
+        output.derivatives[k] += pairderiv[k];
+        output.derivatives[3*i+k] += pairderiv[3+k];
+      }
+      for(unsigned k=0; k<3*adjinp.natoms; ++k) {
+        output.derivatives[threestart+k] += pairderiv[6+k];
+      }
+      for(unsigned k=0; k<virialSize; ++k) {
+        output.derivatives[virstart+k] += pairderiv[6+3*adjinp.natoms+k];
+      }
+    }
+    output.values[0] = rowsum;
+    return;
+  }
   const unsigned ncomponents =(actiondata.components) ? 4 : 1;
 
   // Must clear the derivatives here as otherwise sparsity pattern
@@ -600,6 +705,9 @@ void AdjacencyMatrixBase<CV, myPTM>::applyNonZeroRankForces( std::vector<double>
 template <class CV, typename myPTM>
 int AdjacencyMatrixBase<CV, myPTM>::getNumberOfValuesPerTask( std::size_t task_index,
     const AdjacencyMatrixData<CV>& actiondata ) {
+  if( actiondata.rowsums ) {
+    return 1;
+  }
   return actiondata.nlist[task_index] - 1;
 }
 
@@ -619,6 +727,37 @@ void AdjacencyMatrixBase<CV, myPTM>::getForceIndices( const std::size_t task_ind
   force_indices.indices[0][1] = three_task_index + 1;
   force_indices.indices[0][2] = three_task_index + 2;
 
+  if( actiondata.rowsums ) {
+    // The derivatives of the sum of the row are for all the atoms in the row, the third atoms and the virial
+    const unsigned nneigh = actiondata.nlist[task_index];
+    for(unsigned j=1; j<nneigh; ++j) {
+      const unsigned myatom = 3 * actiondata.nlist[fstart + j];
+      force_indices.indices[0][3*j  ] = myatom;
+      force_indices.indices[0][3*j+1] = myatom + 1;
+      force_indices.indices[0][3*j+2] = myatom + 2;
+    }
+    unsigned n = 3*nneigh;
+    if( actiondata.natoms_per_three_list>0 ) {
+      const unsigned n3neigh = actiondata.nlist_three[task_index];
+      const unsigned fstart3 = actiondata.nlists
+                               + task_index*(1 + actiondata.natoms_per_three_list);
+      for(unsigned j=1; j<n3neigh; ++j) {
+        unsigned my3atom = 3 * actiondata.nlist_three[fstart3 + j];
+        force_indices.indices[0][n  ] = my3atom;
+        force_indices.indices[0][n+1] = my3atom + 1;
+        force_indices.indices[0][n+2] = my3atom + 2;
+        n += 3;
+      }
+    }
+    const unsigned virstart = ntotal_force - 9;
+    for(unsigned k=0; k<virialSize; ++k) {
+      force_indices.indices[0][n+k] = virstart + k;
+    }
+    force_indices.threadsafe_derivatives_end[0] = 0;
+    force_indices.tot_indices[0] = n + virialSize;
+    return;
+  }
+
   const unsigned myatom = 3 * actiondata.nlist[fstart + 1 + colno];
   force_indices.indices[0][3] = myatom;
   force_indices.indices[0][4] = myatom + 1;
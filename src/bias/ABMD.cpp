@@ -86,6 +86,9 @@ class ABMD : public Bias {
 public:
   explicit ABMD(const ActionOptions&);
   void calculate() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   static void registerKeywords(Keywords& keys);
 };
 
@@ -127,6 +127,9 @@ public:
   explicit ExtendedLagrangian(const ActionOptions&);
   void calculate() override;
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   static void registerKeywords(Keywords& keys);
 };
 
@@ -162,6 +162,9 @@ public:
   explicit MaxEnt(const ActionOptions&);
   void calculate() override;
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   void update_lambda();
   static void registerKeywords(Keywords& keys);
   void ReadLagrangians(IFile &ifile);
@@ -26,10 +26,13 @@
 #include "core/FlexibleBin.h"
 #include "tools/Exception.h"
 #include "tools/Grid.h"
+#include "tools/KernelTree.h"
 #include "tools/Matrix.h"
 #include "tools/OpenMP.h"
 #include "tools/Random.h"
+#include "tools/SharedMemoryRing.h"
 #include "tools/File.h"
+#include "tools/BinaryHillsFile.h"
 #include "tools/Communicator.h"
 #include <ctime>
 #include <numeric>
@@ -123,6 +126,22 @@ Using NLIST is beneficial if you are using more than 2 collective variables as i
 expensive and memory consuming. Furthermore, as indicated above, if you are using this option you can have access to a value called
 `nlker`, which tells you how many Gaussians were evaluated in each step.
 
+The hills can also be stored in a kd-tree by using the TREE_FOLD keyword as illustrated below.
+
+```plumed
+d1: DISTANCE ATOMS=1,2
+d2: DISTANCE ATOMS=3,4
+d3: DISTANCE ATOMS=5,6
+d4: DISTANCE ATOMS=7,8
+m: METAD ARG=d1,d2,d3,d4 SIGMA=0.1,0.1,0.1,0.1 HEIGHT=1.2 PACE=500 TREE_FOLD=100
+PRINT ARG=d1,d2,d3,d4,m.bias FILE=colvar
+```
+
+Only the hills whose support contains the current position are found in the tree and evaluated, so the
+cost of calculating the bias grows with the logarithm of the number of hills.  As the Gaussians are truncated, the
+bias is the same that is obtained without the tree.  The recent hills are kept in a list and are always evaluated.
+When this list contains more than TREE_FOLD hills, the tree is built again with all the hills.
+
 The neighbor list is updated everytime the CVs move farther than a cut-off value
 from the position they were at last neighbor list update. Gaussians are added to the neigbhor list if their center
 is within 6.*DP2CUTOFF*sigma*sigma. While the list is updated if the CVs are farther from the center than 0.5 of the
@@ -163,6 +182,17 @@ PRINT ARG=d1,m.bias FILE=colvar STRIDE=10
 Notice that if you want to use this option you first need to save the GRID using GRID_WFILE (and GRID_WSTRIDE).  Using this
 option ensures that the grid file that is read in with GRID_RFILE is output.
 
+Reading a long HILLS file when restarting can take a considerable amount of time.  If you use the BINARY_HILLS flag the
+hills are written in a binary file.  When this file is read in, the hills are mapped in memory and used directly without
+parsing any text, so restarting is much faster.  The same holds for the files that are read at every WALKERS_RSTRIDE steps
+when multiple walkers are used.  Binary hills files can be analysed with [sum_hills](sum_hills.md) in the same way
+as text files, but they cannot be compressed.  Notice that the FMT keyword is ignored when BINARY_HILLS is used.
+
+```plumed
+d: DISTANCE ATOMS=1,10
+m: METAD ARG=d SIGMA=0.1 HEIGHT=0.1 PACE=500 FILE=HILLS.bin BINARY_HILLS
+```
+
 Notice, also that in the first input above the
 [RESTART](RESTART.md) action was used, while the second input used METAD's RESTART keyword.  If you use the first input
 every action in the input is restarted so the [PRINT](PRINT.md) command will append to the output file from the earlier calculation.
@@ -311,6 +341,28 @@ The bias potential experienced by all the walkers is synched between walkers eve
 WALKERS_RSTRIDE steps.  In addition, since version 2.2.5, hills files are automatically
 flushed every WALKERS_RSTRIDE steps.
 
+When all the walkers run on the same node, they can exchange the hills through shared memory
+rather than by reading the hills files of the other walkers.  To do so, use WALKERS_SHM to give the name of a file on a memory file system
+that all the walkers will map in memory, as in the input below:
+
+```plumed
+d1: DISTANCE ATOMS=3,5
+restraint: METAD ...
+   ARG=d1 SIGMA=0.05 HEIGHT=0.3 PACE=500
+   WALKERS_N=10
+   WALKERS_ID=3
+   WALKERS_SHM=/dev/shm/walkers
+   WALKERS_RSTRIDE=100
+...
+```
+
+Each walker publishes its hills in a ring buffer that can hold WALKERS_SHM_SIZE hills and reads the hills of the others
+every WALKERS_RSTRIDE steps.  Nothing is locked, so a walker never waits for the other walkers.  If a walker deposits more than WALKERS_SHM_SIZE hills before another walker reads them
+the calculation stops with an error, so make sure that the buffer is large enough.  The hills files are
+still written and they are read in when restarting, and the hills that are found both in the files and in shared memory are only added once.
+The shared memory file is deleted when the last walker finishes.  If all the walkers are killed the file is not deleted, but its content is discarded
+by the next calculation that uses it.  A walker that is killed while the others are running can be restarted and it joins them again.
+
 ## Reweighting a metadynamics simulation
 
 The $c(t)$ reweighting factor can also be calculated on the fly using the equations
@@ -534,11 +586,18 @@ private:
   std::vector<double> sigma0max_;
   // Gaussians
   std::vector<Gaussian> hills_;
+  // kd-tree with the supports of the hills and the hills found in it
+  std::unique_ptr<KernelTree> hillstree_;
+  std::vector<std::size_t> treehills_;
   std::unique_ptr<FlexibleBin> flexbin_;
   int adaptive_;
   OFile hillsOfile_;
   std::vector<std::unique_ptr<IFile>> ifiles_;
   std::vector<std::string> ifilesnames_;
+  // binary hills files and the number of hills that have been read from each of them
+  bool binaryHills_;
+  std::vector<std::unique_ptr<BinaryHillsFile>> bfiles_;
+  std::vector<std::size_t> bfilesread_;
   // Grids
   bool grid_;
   std::unique_ptr<GridBase> BiasGrid_;
@@ -550,6 +609,13 @@ private:
   std::string mw_dir_;
   int mw_id_;
   int mw_rstride_;
+  // multiple walkers in shared memory and the number of hills read from each walker
+  std::string mw_shm_;
+  std::size_t mw_shm_size_;
+  SharedMemoryRing mw_ring_;
+  std::vector<std::size_t> mw_cursors_;
+  // the number of hills of each walker that are in its hills file, the ones in shared memory that were already read from the file are skipped
+  std::vector<std::size_t> mw_hills_in_file_;
   bool walkers_mpi_;
   unsigned mpi_nw_;
   // flying gaussians
@@ -610,12 +676,17 @@ private:
   static void registerTemperingKeywords(const std::string &name_stem, const std::string &name, Keywords &keys);
   void   readTemperingSpecs(TemperingSpecs &t_specs);
   void   logTemperingSpecs(const TemperingSpecs &t_specs);
-  void   readGaussians(IFile*);
+  unsigned readGaussians(IFile*);
+  unsigned readGaussians(BinaryHillsFile*, std::size_t&);
+  void   openBinaryHills(unsigned);
+  void   readGaussiansFromRing();
   void   writeGaussian(const Gaussian&,OFile&);
   void   addGaussian(const Gaussian&);
+  void   addSeparableGaussian(const Gaussian&, const std::vector<unsigned>&, Grid&);
   double getHeight(const std::vector<double>&);
   void   temperHeight(double &height, const TemperingSpecs &t_specs, const double tempering_bias);
   double getBias(const std::vector<double>&);
+  void   findHillsInTree(const std::vector<double>&);
   double getBiasAndDerivatives(const std::vector<double>&, std::vector<double>&);
   double evaluateGaussian(const std::vector<double>&, const Gaussian&);
   double evaluateGaussianAndDerivatives(const std::vector<double>&, const Gaussian&,std::vector<double>&,std::vector<double>&);
@@ -631,6 +702,9 @@ public:
   explicit MetaD(const ActionOptions&);
   void calculate() override;
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   static void registerKeywords(Keywords& keys);
   bool checkNeedsGradients()const override;
 };
@@ -654,6 +728,7 @@ void MetaD::registerKeywords(Keywords& keys) {
   keys.add("compulsory","FILE","HILLS","a file in which the list of added hills is stored");
   keys.add("optional","HEIGHT","the heights of the Gaussian hills. Compulsory unless TAU and either BIASFACTOR or DAMPFACTOR are given");
   keys.add("optional","FMT","specify format for HILLS files (useful for decrease the number of digits in regtests)");
+  keys.addFlag("BINARY_HILLS",false,"write the hills in a binary file that is much faster to read when restarting");
   keys.add("optional","BIASFACTOR","use well tempered metadynamics and use this bias factor.  Please note you must also specify temp");
   keys.addFlag("CALC_WORK",false,"calculate the total accumulated work done by the bias since last restart");
   keys.add("optional","RECT","list of bias factors for all the replicas");
@@ -679,6 +754,7 @@ void MetaD::registerKeywords(Keywords& keys) {
   keys.add("optional","GRID_RFILE","a grid file from which the bias should be read at the initial step of the simulation");
   keys.addFlag("STORE_GRIDS",false,"store all the grid files the calculation generates. They will be deleted if this keyword is not present");
   keys.addFlag("NLIST",false,"Use neighbor list for kernels summation, faster but experimental");
+  keys.add("optional","TREE_FOLD","store the hills in a kd-tree that is built again every time this number of new hills has been added, so only the hills close to the current position are evaluated");
   keys.add("optional", "NLIST_PARAMETERS","(default=6.,0.5) the two cutoff parameters for the Gaussians neighbor list");
   keys.add("optional","ADAPTIVE","use a geometric (=GEOM) or diffusion (=DIFF) based hills width scheme. Sigma is one number that has distance units or time step dimensions");
   keys.add("optional","SIGMA_MAX","the upper bounds for the sigmas (in CV units) when using adaptive hills. Negative number means no bounds ");
@@ -687,6 +763,8 @@ void MetaD::registerKeywords(Keywords& keys) {
   keys.add("optional","WALKERS_N", "number of walkers");
   keys.add("optional","WALKERS_DIR", "shared directory with the hills files from all the walkers");
   keys.add("optional","WALKERS_RSTRIDE","stride for reading hills files");
+  keys.add("optional","WALKERS_SHM","file on a memory file system that is used to exchange the hills between walkers on the same node");
+  keys.add("compulsory","WALKERS_SHM_SIZE","10000","number of hills of each walker that are kept in shared memory when using WALKERS_SHM");
   keys.addFlag("WALKERS_MPI",false,"Switch on MPI version of multiple walkers - not compatible with WALKERS_* options other than WALKERS_DIR");
   keys.add("optional","INTERVAL","one dimensional lower and upper limits, outside the limits the system will not feel the biasing force.");
   keys.addFlag("FLYING_GAUSSIAN",false,"Switch on flying Gaussian method, must be used with WALKERS_MPI");
@@ -736,9 +814,10 @@ MetaD::MetaD(const ActionOptions& ao):
   isFirstStep_(true),
   height0_(std::numeric_limits<double>::max()),
   adaptive_(FlexibleBin::none),
+  binaryHills_(false),
   grid_(false),
   wgridstride_(0),
-  mw_n_(1), mw_dir_(""), mw_id_(0), mw_rstride_(1),
+  mw_n_(1), mw_dir_(""), mw_id_(0), mw_rstride_(1), mw_shm_size_(10000),
   walkers_mpi_(false), mpi_nw_(0),
   flying_(false),
   acceleration_(false), acc_(0.0), acc_restart_mean_(0.0),
@@ -780,6 +859,7 @@ MetaD::MetaD(const ActionOptions& ao):
   }
 
   parse("FMT",fmt_);
+  parseFlag("BINARY_HILLS",binaryHills_);
 
   // parse the sigma
   parseVector("SIGMA",sigma0_);
@@ -1053,6 +1133,19 @@ MetaD::MetaD(const ActionOptions& ao):
     nlist_param_[1]=nlist_param[1];
   }
 
+  // kd-tree of the hills
+  unsigned treefold=0;
+  parse("TREE_FOLD",treefold);
+  if(treefold>0) {
+    if(grid_) {
+      error("TREE_FOLD and GRID cannot be combined!");
+    }
+    if(nlist_) {
+      error("TREE_FOLD and NLIST cannot be combined!");
+    }
+    hillstree_=Tools::make_unique<KernelTree>(getNumberOfArguments(),treefold);
+  }
+
   // Reweighting factor rct
   parseFlag("CALC_RCT",calc_rct_);
   if (calc_rct_) {
@@ -1074,6 +1167,8 @@ MetaD::MetaD(const ActionOptions& ao):
   }
   parse("WALKERS_DIR",mw_dir_);
   parse("WALKERS_RSTRIDE",mw_rstride_);
+  parse("WALKERS_SHM",mw_shm_);
+  parse("WALKERS_SHM_SIZE",mw_shm_size_);
 
   // MPI version
   parseFlag("WALKERS_MPI",walkers_mpi_);
@@ -1280,7 +1375,16 @@ MetaD::MetaD(const ActionOptions& ao):
     if(mw_dir_!="") {
       log.printf("  directory with hills files %s\n",mw_dir_.c_str());
     }
+    if(mw_shm_!="") {
+      if(!SharedMemoryRing::available()) {
+        error("WALKERS_SHM cannot be used as shared memory is not available on this platform");
+      }
+      log.printf("  hills are exchanged through shared memory file %s that keeps %zu hills per walker\n",mw_shm_.c_str(),mw_shm_size_);
+    }
   } else {
+    if(mw_shm_!="") {
+      error("WALKERS_SHM can only be used with WALKERS_N");
+    }
     if(walkers_mpi_) {
       log.printf("  Multiple walkers active using MPI communnication\n");
       if(mw_dir_!="") {
@@ -1303,6 +1407,10 @@ MetaD::MetaD(const ActionOptions& ao):
     log.printf("  Flying Gaussian method with %d walkers active\n",mpi_nw_);
   }
 
+  if(hillstree_) {
+    log.printf("  hills are stored in a kd-tree that is built again every %u new hills\n",treefold);
+  }
+
   if(nlist_) {
     addComponent("nlker");
     componentIsNotPeriodic("nlker");
@@ -1552,6 +1660,22 @@ MetaD::MetaD(const ActionOptions& ao):
     comm.Bcast(mw_dir_,0);
   }
 
+  // the hills in shared memory are only read from the position they had before the hills files are read when restarting,
+  // and the ones that were published in the meanwhile and that are also in the files are skipped
+  mw_hills_in_file_.assign(mw_n_,0);
+  if(mw_shm_!="") {
+    const unsigned ncv=getNumberOfArguments();
+    mw_cursors_.assign(mw_n_,0);
+    if(comm.Get_rank()==0) {
+      mw_ring_.open(mw_shm_,mw_n_,mw_id_,3+ncv+ncv*(ncv+1)/2,mw_shm_size_);
+      if(getRestart()) {
+        for(int i=0; i<mw_n_; ++i) {
+          mw_cursors_[i]=mw_ring_.getNumberOfPublished(i);
+        }
+      }
+    }
+  }
+
   // creating std::vector of ifile* for hills reading
   // open all files at the beginning and read Gaussians if restarting
   bool restartedFromHills=false;  // restart from hills files
@@ -1581,11 +1705,34 @@ MetaD::MetaD(const ActionOptions& ao):
     IFile *ifile = ifiles_.back().get();
     ifilesnames_.push_back(fname);
     ifile->link(*this);
-    if(ifile->FileExist(fname)) {
+    bfiles_.emplace_back();
+    bfilesread_.push_back(0);
+    if(binaryHills_) {
+      // binary files are only opened once their header has been written
+      if(BinaryHillsFile::isBinary(fname)) {
+        openBinaryHills(i);
+        if(getRestart()&&!restartedFromGrid) {
+          log.printf("  Restarting from %s:",ifilesnames_[i].c_str());
+          mw_hills_in_file_[i]=readGaussians(bfiles_[i].get(),bfilesread_[i]);
+          restartedFromHills=true;
+        }
+        // the file of this walker is only used for writing
+        if(i==mw_id_) {
+          bfiles_[i].reset();
+        }
+      } else if(ifile->FileExist(fname) && getRestart()) {
+        error("file "+fname+" is not a binary hills file, remove the BINARY_HILLS flag to restart from it");
+      } else if(getRestart()&&!restartedFromGrid) {
+        error("restart file "+fname+" not found");
+      }
+    } else if(ifile->FileExist(fname)) {
+      if(getRestart() && BinaryHillsFile::isBinary(fname)) {
+        error("file "+fname+" is a binary hills file, use the BINARY_HILLS flag to restart from it");
+      }
       ifile->open(fname);
       if(getRestart()&&!restartedFromGrid) {
         log.printf("  Restarting from %s:",ifilesnames_[i].c_str());
-        readGaussians(ifiles_[i].get());
+        mw_hills_in_file_[i]=readGaussians(ifiles_[i].get());
         restartedFromHills=true;
       }
       ifiles_[i]->reset(false);
@@ -1698,20 +1845,40 @@ MetaD::MetaD(const ActionOptions& ao):
     hillsOfile_.enforceSuffix("");
   }
   hillsOfile_.open(ifilesnames_[mw_id_]);
-  if(fmt_.length()>0) {
-    hillsOfile_.fmtField(fmt_);
-  }
-  hillsOfile_.addConstantField("multivariate");
-  hillsOfile_.addConstantField("kerneltype");
-  if(doInt_) {
-    hillsOfile_.addConstantField("lower_int").printField("lower_int",lowI_);
-    hillsOfile_.addConstantField("upper_int").printField("upper_int",uppI_);
+  if(binaryHills_) {
+    if(!hillsOfile_.getFILE() || Tools::extension(hillsOfile_.getPath())=="gz") {
+      error("binary hills file "+hillsOfile_.getPath()+" cannot be compressed");
+    }
+    // the header is only written in new files, when appending the header was checked when reading the hills
+    std::fseek(hillsOfile_.getFILE(),0,SEEK_END);
+    if(std::ftell(hillsOfile_.getFILE())==0 && comm.Get_rank()==0) {
+      std::vector<BinaryHillsFile::Variable> vars(getNumberOfArguments());
+      for(unsigned i=0; i<getNumberOfArguments(); ++i) {
+        vars[i].name=getPntrToArgument(i)->getName();
+        if(getPntrToArgument(i)->isPeriodic()) {
+          getPntrToArgument(i)->getDomain(vars[i].min,vars[i].max);
+        }
+      }
+      BinaryHillsFile::writeHeader(hillsOfile_.getFILE(),vars);
+      std::fflush(hillsOfile_.getFILE());
+    }
+    log.printf("  hills are written in binary format\n");
+  } else {
+    if(fmt_.length()>0) {
+      hillsOfile_.fmtField(fmt_);
+    }
+    hillsOfile_.addConstantField("multivariate");
+    hillsOfile_.addConstantField("kerneltype");
+    if(doInt_) {
+      hillsOfile_.addConstantField("lower_int").printField("lower_int",lowI_);
+      hillsOfile_.addConstantField("upper_int").printField("upper_int",uppI_);
+    }
+    // output periodicities of variables
+    for(unsigned i=0; i<getNumberOfArguments(); ++i) {
+      hillsOfile_.setupPrintValue( getPntrToArgument(i) );
+    }
   }
   hillsOfile_.setHeavyFlush();
-  // output periodicities of variables
-  for(unsigned i=0; i<getNumberOfArguments(); ++i) {
-    hillsOfile_.setupPrintValue( getPntrToArgument(i) );
-  }
 
   bool concurrent=false;
   const ActionSet&actionSet(plumed.getActionSet());
@@ -1804,7 +1971,7 @@ void MetaD::logTemperingSpecs(const TemperingSpecs &t_specs) {
   }
 }
 
-void MetaD::readGaussians(IFile *ifile) {
+unsigned MetaD::readGaussians(IFile *ifile) {
   unsigned ncv=getNumberOfArguments();
   std::vector<double> center(ncv);
   std::vector<double> sigma(ncv);
@@ -1826,10 +1993,114 @@ void MetaD::readGaussians(IFile *ifile) {
     addGaussian(Gaussian(multivariate,height,center,sigma));
   }
   log.printf("      %d Gaussians read\n",nhills);
+  return nhills;
+}
+
+unsigned MetaD::readGaussians(BinaryHillsFile *bfile, std::size_t& nread) {
+  unsigned ncv=getNumberOfArguments();
+  std::vector<double> center(ncv);
+  std::vector<double> sigma;
+  int nhills=0;
+  // only the hills that were not read yet are added
+  const std::size_t ntot=bfile->update();
+  for(; nread<ntot; ++nread) {
+    View<const double> cc=bfile->getCenter(nread);
+    View<const double> ss=bfile->getSigma(nread);
+    std::copy(cc.begin(),cc.end(),center.begin());
+    sigma.assign(ss.begin(),ss.end());
+    double height=bfile->getHeight(nread);
+    // note that for gamma=1 we store directly -F
+    if(welltemp_ && biasf_>1.0) {
+      height*=(biasf_-1.0)/biasf_;
+    }
+    addGaussian(Gaussian(bfile->isMultivariate(nread),height,center,sigma));
+    nhills++;
+  }
+  log.printf("      %d Gaussians read\n",nhills);
+  return nhills;
+}
+
+void MetaD::readGaussiansFromRing() {
+  const unsigned ncv=getNumberOfArguments();
+  // the hills are read on the first rank and shared with the others
+  std::vector<double> records;
+  std::vector<unsigned> nhills(mw_n_,0);
+  if(comm.Get_rank()==0) {
+    std::vector<double> record;
+    for(int i=0; i<mw_n_; ++i) {
+      if(i==mw_id_) {
+        continue;
+      }
+      while(mw_ring_.read(i,mw_cursors_[i],record)) {
+        // this hill was already read from the hills file of the walker when restarting
+        if(record[2]<mw_hills_in_file_[i]) {
+          continue;
+        }
+        records.insert(records.end(),record.begin(),record.end());
+        nhills[i]++;
+      }
+    }
+  }
+  comm.Bcast(nhills,0);
+  const std::size_t rsize=3+ncv+ncv*(ncv+1)/2;
+  records.resize(rsize*std::accumulate(nhills.begin(),nhills.end(),std::size_t(0)));
+  comm.Bcast(records,0);
+  std::vector<double> center(ncv);
+  std::vector<double> sigma;
+  const double* record=records.data();
+  for(int i=0; i<mw_n_; ++i) {
+    if(i==mw_id_) {
+      continue;
+    }
+    for(unsigned j=0; j<nhills[i]; ++j) {
+      const bool multivariate=record[0]>0.5;
+      std::copy(record+3,record+3+ncv,center.begin());
+      sigma.assign(record+3+ncv,record+3+ncv+(multivariate ? ncv*(ncv+1)/2 : ncv));
+      addGaussian(Gaussian(multivariate,record[1],center,sigma));
+      record+=rsize;
+    }
+    log.printf("  Reading hills of walker %d from shared memory:      %d Gaussians read\n",i,nhills[i]);
+  }
+}
+
+void MetaD::openBinaryHills(unsigned i) {
+  bfiles_[i]=Tools::make_unique<BinaryHillsFile>();
+  bfiles_[i]->open(ifilesnames_[i]);
+  bfilesread_[i]=0;
+  const std::vector<BinaryHillsFile::Variable>& vars=bfiles_[i]->getVariables();
+  if(vars.size()!=getNumberOfArguments()) {
+    error("number of variables in hills file "+ifilesnames_[i]+" does not match the number of arguments");
+  }
+  for(unsigned j=0; j<vars.size(); ++j) {
+    if(vars[j].name!=getPntrToArgument(j)->getName()) {
+      error("variable "+vars[j].name+" in hills file "+ifilesnames_[i]+" does not match argument "+getPntrToArgument(j)->getName());
+    }
+    std::string rmin, rmax;
+    if(getPntrToArgument(j)->isPeriodic()) {
+      getPntrToArgument(j)->getDomain(rmin,rmax);
+    }
+    if(vars[j].min!=rmin || vars[j].max!=rmax) {
+      error("in hills file periodicity for variable " + vars[j].name + " does not match periodicity in input");
+    }
+  }
 }
 
 void MetaD::writeGaussian(const Gaussian& hill, OFile&file) {
   unsigned ncv=getNumberOfArguments();
+  if(binaryHills_) {
+    double height=hill.height;
+    // note that for gamma=1 we store directly -F
+    if(welltemp_ && biasf_>1.0) {
+      height*=biasf_/(biasf_-1.0);
+    }
+    // the widths of multivariate hills are written as they are stored, no conversion is needed
+    if(comm.Get_rank()==0) {
+      BinaryHillsFile::writeHill(file.getFILE(),getTimeStep()*getStep(),
+                                 View<const double>(hill.center.data(),hill.center.size()),hill.multivariate,
+                                 View<const double>(hill.sigma.data(),hill.sigma.size()),height,biasf_);
+    }
+    return;
+  }
   file.printField("time",getTimeStep()*getStep());
   for(unsigned i=0; i<ncv; ++i) {
     file.printField(getPntrToArgument(i),hill.center[i]);
@@ -1887,6 +2158,12 @@ void MetaD::addGaussian(const Gaussian& hill) {
   if(grid_) {
     size_t ncv=getNumberOfArguments();
     std::vector<unsigned> nneighb=getGaussianSupport(hill);
+    // diagonal hills on a dense grid are the product of one dimensional Gaussians
+    Grid* densegrid=dynamic_cast<Grid*>(BiasGrid_.get());
+    if(!hill.multivariate && !doInt_ && densegrid && comm.Get_size()==1) {
+      addSeparableGaussian(hill,nneighb,*densegrid);
+      return;
+    }
     std::vector<Grid::index_t> neighbors=BiasGrid_->getNeighbors(hill.center,nneighb);
     std::vector<double> der(ncv);
     std::vector<double> xx(ncv);
@@ -1933,6 +2210,133 @@ void MetaD::addGaussian(const Gaussian& hill) {
     }
   } else {
     hills_.push_back(hill);
+    if(hillstree_) {
+      // the support of the hill is contained in the box that encloses the ellipsoid where the Gaussian is not truncated
+      const unsigned ncv=getNumberOfArguments();
+      std::vector<double> width(ncv);
+      if(hill.multivariate) {
+        Matrix<double> mymatrix(ncv,ncv), myinv(ncv,ncv);
+        unsigned k=0;
+        for(unsigned i=0; i<ncv; i++) {
+          for(unsigned j=i; j<ncv; j++) {
+            mymatrix(i,j)=mymatrix(j,i)=hill.sigma[k];
+            k++;
+          }
+        }
+        Invert(mymatrix,myinv);
+        for(unsigned i=0; i<ncv; i++) {
+          width[i]=std::sqrt(2.0*dp2cutoff*myinv(i,i));
+        }
+      } else {
+        for(unsigned i=0; i<ncv; i++) {
+          width[i]=std::sqrt(2.0*dp2cutoff)*hill.sigma[i];
+        }
+      }
+      hillstree_->add(View<const double>(hill.center.data(),ncv),View<const double>(width.data(),ncv));
+    }
+  }
+}
+
+void MetaD::addSeparableGaussian(const Gaussian& hill, const std::vector<unsigned>& nneighb, Grid& grid) {
+  const unsigned ncv=getNumberOfArguments();
+  const std::vector<unsigned> nbin=grid.getNbin();
+  const std::vector<bool> pbc=grid.getIsPeriodic();
+  const std::vector<unsigned> center=grid.getIndices(hill.center);
+  // the points around the center are visited in the same order as in GridBase::getNeighbors.
+  // For each dimension, the offset in the grid index, the square of the scaled distance, the one dimensional
+  // Gaussian and the factor for the derivative are computed once for all the points at a given distance
+  std::vector<std::vector<long long>> offset(ncv);
+  std::vector<std::vector<double>> dp2(ncv), gauss(ncv), dfact(ncv);
+  std::vector<unsigned> unit(ncv,0);
+  for(unsigned j=0; j<ncv; ++j) {
+    const unsigned n=2*nneighb[j]+1;
+    offset[j].assign(n,-1);
+    dp2[j].assign(n,0.0);
+    gauss[j].assign(n,0.0);
+    dfact[j].assign(n,0.0);
+    Grid::index_t stride=0;
+    if(nbin[j]>1) {
+      unit[j]=1;
+      stride=grid.getIndex(unit);
+    }
+    for(unsigned k=0; k<n; ++k) {
+      long long i0=static_cast<long long>(k)-nneighb[j]+center[j];
+      if(!pbc[j] && (i0<0 || i0>=nbin[j])) {
+        continue;
+      }
+      if(pbc[j]) {
+        i0=( i0%static_cast<long long>(nbin[j]) + nbin[j] )%nbin[j];
+      }
+      unit[j]=i0;
+      const double dp=difference(j,hill.center[j],grid.getPoint(unit)[j])*hill.invsigma[j];
+      offset[j][k]=i0*stride;
+      dp2[j][k]=dp*dp;
+      gauss[j][k]=std::exp(-0.5*dp*dp);
+      dfact[j][k]=-dp*hill.invsigma[j]*stretchA;
+    }
+    unit[j]=0;
+  }
+
+  // the points along the first dimension are done together, the rows along the other dimensions are divided between threads.
+  // When a periodic dimension is shorter than the support of the hill, different rows can contain the same point
+  const unsigned nfast=2*nneighb[0]+1;
+  std::size_t nrows=1;
+  bool overlap=false;
+  for(unsigned j=1; j<ncv; ++j) {
+    nrows*=2*nneighb[j]+1;
+    overlap=overlap || 2*nneighb[j]+1>nbin[j];
+  }
+  const unsigned nt=overlap ? 1 : std::min<std::size_t>(OpenMP::getNumThreads(),nrows);
+  const double cutoff=2.0*dp2cutoff;
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<double> rowbias(nfast), der(ncv);
+    std::vector<unsigned> rowind(ncv,0);
+    #pragma omp for
+    for(std::size_t row=0; row<nrows; ++row) {
+      // find the point at the start of the row
+      long long base=0;
+      double rowdp2=0.0, rowgauss=hill.height;
+      std::size_t r=row;
+      bool inside=true;
+      for(unsigned j=1; j<ncv; ++j) {
+        rowind[j]=r%(2*nneighb[j]+1);
+        r/=2*nneighb[j]+1;
+        if(offset[j][rowind[j]]<0) {
+          inside=false;
+          break;
+        }
+        base+=offset[j][rowind[j]];
+        rowdp2+=dp2[j][rowind[j]];
+        rowgauss*=gauss[j][rowind[j]];
+      }
+      if(!inside) {
+        continue;
+      }
+      const double* dp20=dp2[0].data();
+      const double* gauss0=gauss[0].data();
+      double* bias=rowbias.data();
+      #pragma omp simd
+      for(unsigned k=0; k<nfast; ++k) {
+        bias[k]=( dp20[k]+rowdp2<cutoff ) ? rowgauss*gauss0[k] : 0.0;
+      }
+      for(unsigned k=0; k<nfast; ++k) {
+        if(offset[0][k]<0) {
+          continue;
+        }
+        double value=0.0;
+        if(dp20[k]+rowdp2<cutoff) {
+          der[0]=bias[k]*dfact[0][k];
+          for(unsigned j=1; j<ncv; ++j) {
+            der[j]=bias[k]*dfact[j][rowind[j]];
+          }
+          value=stretchA*bias[k]+hill.height*stretchB;
+        } else {
+          std::fill(der.begin(),der.end(),0.0);
+        }
+        grid.addValueAndDerivatives(base+offset[0][k],value,der);
+      }
+    }
   }
 }
 
@@ -2005,7 +2409,16 @@ double MetaD::getBias(const std::vector<double>& cv) {
     unsigned stride=comm.Get_size();
     unsigned rank=comm.Get_rank();
 
-    if(!nlist_) {
+    if(hillstree_) {
+      findHillsInTree(cv);
+      #pragma omp parallel num_threads(nt)
+      {
+        #pragma omp for reduction(+:bias) nowait
+        for(unsigned i=rank; i<treehills_.size(); i+=stride) {
+          bias+=evaluateGaussian(cv,hills_[treehills_[i]]);
+        }
+      }
+    } else if(!nlist_) {
       #pragma omp parallel num_threads(nt)
       {
         #pragma omp for reduction(+:bias) nowait
@@ -2028,6 +2441,17 @@ double MetaD::getBias(const std::vector<double>& cv) {
   return bias;
 }
 
+void MetaD::findHillsInTree(const std::vector<double>& cv) {
+  std::vector<double> x(cv);
+  // with INTERVAL the hills are evaluated at the closest point within the interval
+  if(doInt_) {
+    x[0]=std::min(std::max(x[0],lowI_),uppI_);
+  }
+  hillstree_->getKernelsAt(View<const double>(x.data(),x.size()),[this](unsigned i, double a, double b) {
+    return difference(i,a,b);
+  },treehills_);
+}
+
 double MetaD::getBiasAndDerivatives(const std::vector<double>& cv, std::vector<double>& der) {
   unsigned ncv=getNumberOfArguments();
   double bias=0.0;
@@ -2042,7 +2466,31 @@ double MetaD::getBiasAndDerivatives(const std::vector<double>& cv, std::vector<d
     unsigned stride=comm.Get_size();
     unsigned rank=comm.Get_rank();
 
-    if(!nlist_) {
+    if(hillstree_) {
+      findHillsInTree(cv);
+      if(treehills_.size()<2*nt*stride||nt==1) {
+        // for performance reasons and thread safety
+        std::vector<double> dp(ncv);
+        for(unsigned i=rank; i<treehills_.size(); i+=stride) {
+          bias+=evaluateGaussianAndDerivatives(cv,hills_[treehills_[i]],der,dp);
+        }
+      } else {
+        #pragma omp parallel num_threads(nt)
+        {
+          std::vector<double> omp_deriv(ncv,0.);
+          // for performance reasons and thread safety
+          std::vector<double> dp(ncv);
+          #pragma omp for reduction(+:bias) nowait
+          for(unsigned i=rank; i<treehills_.size(); i+=stride) {
+            bias+=evaluateGaussianAndDerivatives(cv,hills_[treehills_[i]],omp_deriv,dp);
+          }
+          #pragma omp critical
+          for(unsigned i=0; i<ncv; i++) {
+            der[i]+=omp_deriv[i];
+          }
+        }
+      }
+    } else if(!nlist_) {
       if(hills_.size()<2*nt*stride||nt==1) {
         // for performance reasons and thread safety
         std::vector<double> dp(ncv);
@@ -2439,6 +2887,9 @@ void MetaD::update() {
       // Flying Gaussian
       if (flying_) {
         hills_.clear();
+        if(hillstree_) {
+          hillstree_->clear();
+        }
         comm.Barrier();
       }
 
@@ -2464,6 +2915,17 @@ void MetaD::update() {
       Gaussian newhill=Gaussian(multivariate,height,cv,thissigma);
       addGaussian(newhill);
       writeGaussian(newhill,hillsOfile_);
+      if(mw_ring_.isOpen()) {
+        // hills are published with the layout that is used in readGaussiansFromRing,
+        // together with their position in the hills file of this walker
+        std::vector<double> record(3+ncv+ncv*(ncv+1)/2,0.0);
+        record[0]=multivariate ? 1.0 : 0.0;
+        record[1]=height;
+        record[2]=mw_hills_in_file_[mw_id_]++;
+        std::copy(cv.begin(),cv.end(),record.begin()+3);
+        std::copy(thissigma.begin(),thissigma.end(),record.begin()+3+ncv);
+        mw_ring_.publish(View<const double>(record.data(),record.size()));
+      }
     }
 
     // this is to update the hills neighbor list
@@ -2521,23 +2983,39 @@ void MetaD::update() {
 
   // if multiple walkers and time to read Gaussians
   if(mw_n_>1 && getStep()%mw_rstride_==0) {
-    for(int i=0; i<mw_n_; ++i) {
-      // don't read your own Gaussians
-      if(i==mw_id_) {
-        continue;
-      }
-      // if the file is not open yet
-      if(!(ifiles_[i]->isOpen())) {
-        // check if it exists now and open it!
-        if(ifiles_[i]->FileExist(ifilesnames_[i])) {
-          ifiles_[i]->open(ifilesnames_[i]);
+    if(mw_shm_!="") {
+      readGaussiansFromRing();
+    } else {
+      for(int i=0; i<mw_n_; ++i) {
+        // don't read your own Gaussians
+        if(i==mw_id_) {
+          continue;
+        }
+        if(binaryHills_) {
+          // the file is opened once the other walker has written its header
+          if(!bfiles_[i]) {
+            if(BinaryHillsFile::isBinary(ifilesnames_[i])) {
+              openBinaryHills(i);
+            }
+          } else {
+            log.printf("  Reading hills from %s:",ifilesnames_[i].c_str());
+            readGaussians(bfiles_[i].get(),bfilesread_[i]);
+          }
+          continue;
+        }
+        // if the file is not open yet
+        if(!(ifiles_[i]->isOpen())) {
+          // check if it exists now and open it!
+          if(ifiles_[i]->FileExist(ifilesnames_[i])) {
+            ifiles_[i]->open(ifilesnames_[i]);
+            ifiles_[i]->reset(false);
+          }
+          // otherwise read the new Gaussians
+        } else {
+          log.printf("  Reading hills from %s:",ifilesnames_[i].c_str());
+          readGaussians(ifiles_[i].get());
           ifiles_[i]->reset(false);
         }
-        // otherwise read the new Gaussians
-      } else {
-        log.printf("  Reading hills from %s:",ifilesnames_[i].c_str());
-        readGaussians(ifiles_[i].get());
-        ifiles_[i]->reset(false);
       }
     }
     // this is to update the hills neighbor list
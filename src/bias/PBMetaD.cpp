@@ -336,6 +336,9 @@ public:
   explicit PBMetaD(const ActionOptions&);
   void calculate() override;
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   static void registerKeywords(Keywords& keys);
   bool checkNeedsGradients()const override;
 };
@@ -35,11 +35,17 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <optional>
+#include <algorithm>
 #include "tools/Units.h"
 #include "tools/PDB.h"
 #include "tools/FileBase.h"
 #include "tools/IFile.h"
 #include "tools/TrajectoryParser.h"
+#include "tools/TrajectoryPrefetcher.h"
+#ifdef __PLUMED_HAS_ZLIB
+#include <zlib.h>
+#endif
 
 namespace PLMD {
 namespace cltools {
@@ -169,6 +175,52 @@ Notice that the xdrfile implementation of xtc and trr
 is more robust than the molfile one, since it provides support for generic cell shapes.
 In addition, if you install xdrfile you can then use the [DUMPATOMS](DUMPATOMS.md) command to write compressed xtc files.
 
+## Reading frames ahead
+
+Reading and decoding the trajectory can take a significant fraction of the time when the
+analysis is cheap. With the `--prefetch` option the frames are read on a separate thread,
+which stays up to the given number of frames ahead of the analysis:
+
+```plumed
+plumed driver --plumed plumed.dat --ixtc traj.xtc --prefetch 4
+```
+
+The result is identical to the one obtained without `--prefetch`.
+
+## Analyzing frames in parallel
+
+When the result obtained on a frame does not depend on the frames that were analyzed before it
+(e.g. when you only calculate CVs and print them) the frames can be split between the MPI processes
+with the `--frame-parallel` flag:
+
+```plumed
+mpirun -np 16 plumed driver --plumed plumed.dat --ixtc traj.xtc --frame-parallel
+```
+
+Every process analyzes a contiguous block of frames on its own and writes its output on separate files
+(`COLVAR.part1`, `COLVAR.part2`, …) that are appended to the files written by the first process at the end.
+The header lines (starting with `#!`) of these files are dropped when they are appended, also for gzipped files.
+If one of the processes stops with an error the files are not merged.
+The frames of xtc and trr files are counted and skipped without decoding them, using the index described below, so every process only decodes its own frames.
+Actions that depend on the previous frames, such as [METAD](METAD.md) or [AVERAGE](AVERAGE.md), cannot be used in this mode.
+Only the first process writes the log.
+
+## Analyzing a subset of the frames
+
+With `--frame-stride N` only one frame every N frames of the trajectory is analyzed. The step number still
+increases by the value given with `--trajectory-stride` for every frame in the trajectory, so that the steps
+in the output are the same that you would get analyzing all the frames:
+
+```plumed
+plumed driver --plumed plumed.dat --ixtc traj.xtc --frame-stride 10
+```
+
+The frames that are not analyzed are skipped without decoding the coordinates when reading xtc and trr files.
+For these files, the position of every frame is also stored in an index file with the name of the trajectory followed
+by `.idx` (e.g. `traj.xtc.idx`), which is written the first time that the frames are counted (e.g. with `--frame-parallel`).
+The index is reused in the following runs and it is extended if the trajectory has grown in the meanwhile.
+If the index cannot be written (e.g. because the directory is read-only) it is rebuilt every time.
+
 ## Multiple replicas
 
 When PLUMED is compiled with MPI support, you can emulate a multi-simulation setup with `driver` by providing the `--multi`
@@ -181,6 +233,146 @@ or default to the unsuffixed one.
 //+ENDPLUMEDOC
 //
 
+/// Append the file part at the end of the file path.
+/// The leading lines of part starting with #! (the header of PLUMED files) are skipped,
+/// since the same header is already in path. Gzipped files are decompressed and the
+/// rest of part is appended to path as a new gzip member.
+static bool appendFile(const std::string& path,const std::string& part) {
+  const bool gz=Tools::extension(path)=="gz";
+#ifndef __PLUMED_HAS_ZLIB
+  if(gz) {
+    return false;
+  }
+#endif
+  auto deleter=[](auto f) {
+    if(f) {
+      std::fclose(f);
+    }
+  };
+  std::unique_ptr<FILE,decltype(deleter)> src(nullptr,deleter);
+  std::unique_ptr<FILE,decltype(deleter)> dest(nullptr,deleter);
+#ifdef __PLUMED_HAS_ZLIB
+  auto gzdeleter=[](gzFile f) {
+    if(f) {
+      gzclose(f);
+    }
+  };
+  std::unique_ptr<gzFile_s,decltype(gzdeleter)> gzsrc(nullptr,gzdeleter);
+  std::unique_ptr<gzFile_s,decltype(gzdeleter)> gzdest(nullptr,gzdeleter);
+#endif
+  bool opened=false;
+  if(gz) {
+#ifdef __PLUMED_HAS_ZLIB
+    gzsrc.reset(gzopen(part.c_str(),"rb"));
+    opened=bool(gzsrc);
+#endif
+  } else {
+    src.reset(std::fopen(part.c_str(),"rb"));
+    opened=bool(src);
+  }
+  if(!opened) {
+    // this process did not write on this file
+    return true;
+  }
+  if(gz) {
+#ifdef __PLUMED_HAS_ZLIB
+    gzdest.reset(gzopen(path.c_str(),"ab"));
+    opened=bool(gzdest);
+#endif
+  } else {
+    dest.reset(std::fopen(path.c_str(),"ab"));
+    opened=bool(dest);
+  }
+  if(!opened) {
+    return false;
+  }
+  auto read=[&](char* buffer,std::size_t n) -> std::size_t {
+#ifdef __PLUMED_HAS_ZLIB
+    if(gz) {
+      const int r=gzread(gzsrc.get(),buffer,n);
+      return r>0 ? r : 0;
+    }
+#endif
+    return std::fread(buffer,1,n,src.get());
+  };
+  auto write=[&](const char* buffer,std::size_t n) -> bool {
+#ifdef __PLUMED_HAS_ZLIB
+    if(gz) {
+      return n==0 || gzwrite(gzdest.get(),buffer,n)==static_cast<int>(n);
+    }
+#endif
+    return std::fwrite(buffer,1,n,dest.get())==n;
+  };
+  // the header lines are dropped as long as we find them at the beginning of the file
+  bool header=true;
+  std::string pending;
+  std::vector<char> buffer(1024*1024);
+  std::size_t n;
+  while((n=read(buffer.data(),buffer.size()))>0) {
+    if(!header) {
+      if(!write(buffer.data(),n)) {
+        return false;
+      }
+      continue;
+    }
+    pending.append(buffer.data(),n);
+    std::size_t pos=0;
+    while(pending.size()-pos>=2) {
+      if(pending[pos]!='#' || pending[pos+1]!='!') {
+        header=false;
+        break;
+      }
+      const auto newline=pending.find('\n',pos);
+      if(newline==std::string::npos) {
+        break;
+      }
+      pos=newline+1;
+    }
+    pending.erase(0,pos);
+    if(!header) {
+      if(!write(pending.data(),pending.size())) {
+        return false;
+      }
+      pending.clear();
+    }
+  }
+  // what is left is a header line without a newline or less than two characters
+  if(header && pending.compare(0,2,"#!")!=0 && !write(pending.data(),pending.size())) {
+    return false;
+  }
+  return true;
+}
+
+/// With --frame-parallel the processes do not communicate while they analyze their frames.
+/// If one of them stops with an error the others would wait for it forever when the outputs are merged,
+/// so when this object is destroyed before finish() was called (i.e. because of an exception)
+/// it tells the others, which get the number of processes that failed from finish().
+class FrameParallelErrors {
+  Communicator* comm=nullptr;
+public:
+  void start(Communicator& c) {
+    comm=&c;
+  }
+  unsigned finish() {
+    unsigned failed=0;
+    if(comm) {
+      comm->Sum(failed);
+      comm=nullptr;
+    }
+    return failed;
+  }
+  ~FrameParallelErrors() {
+    if(comm) {
+      try {
+        unsigned failed=1;
+        comm->Sum(failed);
+      } catch(...) {
+        // the error that is being propagated is more important
+      }
+    }
+  }
+};
+
 template<typename real>
 class Driver : public CLTool {
 public:
@@ -205,6 +397,9 @@ void Driver<real>::registerKeywords( Keywords& keys ) {
            " currently working only for xtc/trr files read with --ixtc/--trr)"
           );
   keys.add("compulsory","--multi","0","set number of replicas for multi environment (needs MPI)");
+  keys.addFlag("--frame-parallel",false,"split the frames of the trajectory between the MPI processes, which analyze them independently, and merge the output files at the end (needs MPI)");
+  keys.add("compulsory","--frame-stride","1","analyze only one frame every this number of frames of the trajectory. The other frames are skipped (for xtc and trr files without decoding them)");
+  keys.add("compulsory","--prefetch","0","number of frames that are read ahead on a separate thread while plumed analyzes the current one (0 means that frames are read when they are needed)");
   keys.addFlag("--noatoms",false,"don't read in a trajectory.  Just use colvar files as specified in plumed.dat");
   keys.addFlag("--parse-only",false,"read the plumed input file and stop");
   keys.addFlag("--restart",false,"makes driver behave as if restarting");
@@ -344,6 +539,23 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     intracomm.Set_comm(pc.Get_comm());
   }
 
+// set up for frame parallel driver:
+  bool frameParallel=false;
+  parseFlag("--frame-parallel",frameParallel);
+  if(frameParallel) {
+    if(!Communicator::initialized()) {
+      error("--frame-parallel needs MPI");
+    }
+    if(multi) {
+      error("--frame-parallel cannot be used with --multi");
+    }
+    if(noatoms || parseOnly || debug_pd || debug_dd) {
+      error("--frame-parallel needs a trajectory and cannot be used to debug domain/particle decomposition");
+    }
+    // every process analyzes its frames alone
+    pc.Split(pc.Get_rank(),0,intracomm);
+  }
+
 // set up for debug replica exchange:
   bool debug_grex=parse("--debug-grex",fakein);
   int  grex_stride=0;
@@ -385,6 +597,15 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
 // the stride
   unsigned stride;
   parse("--trajectory-stride",stride);
+// the number of frames read ahead
+  unsigned prefetch;
+  parse("--prefetch",prefetch);
+// only one frame every frameStride is analyzed
+  unsigned frameStride;
+  parse("--frame-stride",frameStride);
+  if(frameStride==0) {
+    error("--frame-stride should be positive");
+  }
 // are we writing forces
   std::string dumpforces(""), debugforces(""), dumpforcesFmt("%f");;
   bool dumpfullvirial=false;
@@ -519,7 +740,9 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     }
   }
 
-  PlumedMain p;
+  // the object is destroyed before the end to close the output files when running with --frame-parallel
+  auto plumedMain=Tools::make_unique<PlumedMain>();
+  PlumedMain& p(*plumedMain);
   if( parseOnly ) {
     p.activateParseOnlyMode();
   }
@@ -542,7 +765,16 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     }
     p.cmd("setMPIComm",&intracomm.Get_comm());
   }
-  p.cmd("setLog",out);
+  if(frameParallel && pc.Get_rank()>0) {
+    // the other processes write on separate files, which are appended
+    // to the ones written by the first process at the end
+    std::string n;
+    Tools::convert(pc.Get_rank(),n);
+    p.setSuffix(".part"+n);
+    p.cmd("setLogFile","/dev/null");
+  } else {
+    p.cmd("setLog",out);
+  }
   p.cmd("setMDLengthUnits",units.getLength());
   p.cmd("setMDChargeUnits",units.getCharge());
   p.cmd("setMDMassUnits",units.getMass());
@@ -604,6 +836,68 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     }
   }
 
+// with --frame-parallel every process analyzes a contiguous block of frames
+  long long unsigned framesLeft=0;
+  FrameParallelErrors frameParallelErrors;
+  if(frameParallel) {
+    if(trajectoryFile=="-") {
+      error("--frame-parallel cannot read the trajectory from the standard input");
+    }
+    // the frames are counted by the first process, xtc and trr files are indexed
+    long long unsigned nframes=0;
+    int counted=1;
+    std::string countError;
+    if(pc.Get_rank()==0) {
+      TrajectoryParser counter;
+      counter.init(trajectory_fmt,trajectoryFile,use_molfile,command_line_natoms);
+      const long long int indexed=counter.nOfFrames();
+      if(indexed>=0) {
+        nframes=indexed;
+      }
+      while(indexed<0) {
+        auto errormessage=counter.skipFrame();
+        if(errormessage) {
+          if(*errormessage!="EOF") {
+            countError=*errormessage;
+            counted=0;
+          }
+          break;
+        }
+        nframes++;
+      }
+    }
+    pc.Bcast(counted,0);
+    pc.Bcast(nframes,0);
+    if(!counted) {
+      error("error while counting the frames of the trajectory: "+countError);
+    }
+    // from here on the processes work independently until the outputs are merged
+    frameParallelErrors.start(pc);
+    const long long unsigned nproc=pc.Get_size();
+    const long long unsigned rank=pc.Get_rank();
+    // the blocks contain the frames that are analyzed, i.e. one every frameStride
+    const long long unsigned nanalyzed=(nframes+frameStride-1)/frameStride;
+    if(nanalyzed<nproc) {
+      error("--frame-parallel needs at least one frame for each process");
+    }
+    const long long unsigned first=nanalyzed*rank/nproc;
+    framesLeft=nanalyzed*(rank+1)/nproc-first;
+    if(first>0 && parser.nOfFrames()>=0) {
+      auto errormessage=parser.seekFrame(first*frameStride);
+      if(errormessage) {
+        error(*errormessage);
+      }
+    } else {
+      for(long long unsigned i=0; i<first*frameStride; i++) {
+        auto errormessage=parser.skipFrame();
+        if(errormessage) {
+          error(*errormessage);
+        }
+      }
+    }
+    step+=first*frameStride*stride;
+  }
+
   std::string line;
   std::vector<real> coordinates;
   std::vector<real> forces;
@@ -628,14 +922,35 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
   Random rnd;
 
 
+// the frames are read on a separate thread, the parser must not be used directly anymore
+  std::unique_ptr<TrajectoryPrefetcher<real>> prefetcher;
+  const typename TrajectoryPrefetcher<real>::Frame* frame=nullptr;
+  if(prefetch>0 && !noatoms && !parseOnly) {
+    prefetcher=Tools::make_unique<TrajectoryPrefetcher<real>>(parser,prefetch,stride,pbc_cli_given,step,frameStride);
+  }
+
   bool lstep=true;
   while(true) {
     bool first_step=false;
+    if(frameParallel) {
+      if(framesLeft==0) {
+        break;
+      }
+      framesLeft--;
+    }
     if(!noatoms&&!parseOnly) {
 
       real timeStep=-1.0;
 
-      auto errormessage=parser.readHeader(step,timeStep);
+      std::optional<std::string> errormessage;
+      if(prefetcher) {
+        frame=&prefetcher->acquire();
+        errormessage=frame->error;
+        step=frame->step;
+        timeStep=frame->timeStep;
+      } else {
+        errormessage=parser.readHeader(step,timeStep);
+      }
 
       if (errormessage) {
         if (*errormessage =="EOF") {
@@ -648,7 +963,7 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
         p.cmd("setTimestep",real(timeStep));
         lstep = false;
       }
-      natoms=parser.nOfAtoms();
+      natoms=prefetcher ? frame->natoms : parser.nOfAtoms();
     }
     if(checknatoms<0 && !noatoms) {
       pd_nlocal=natoms;
@@ -690,6 +1005,13 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
       checknatoms=natoms;
       p.cmd("setNatoms",natoms);
       p.cmd("init");
+      if(frameParallel) {
+        for(const auto & a : p.getActionSet()) {
+          if(a->isHistoryDependent()) {
+            error("action " + a->getLabel() + " (" + a->getName() + ") depends on the frames analyzed before the current one and cannot be used with --frame-parallel");
+          }
+        }
+      }
       // Check if we have been asked to output the long version of the input and if there are shortcuts
       if( parseOnly && full_outputfile.length()>0 ) {
 
@@ -980,18 +1302,28 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
 
     int plumedStopCondition=0;
     if(!noatoms) {
-      auto errormessage=parser.readAtoms(
-                          stride,
-                          pbc_cli_given,
-                          debug_pd,
-                          pd_start,
-                          pd_nlocal,
-                          step,
-                          masses.data(),
-                          charges.data(),
-                          coordinates.data(),
-                          cell.data()
-                        );
+      std::optional<std::string> errormessage;
+      if(prefetcher) {
+        // errors were already reported when the frame was acquired
+        std::copy(frame->coordinates.begin(),frame->coordinates.end(),coordinates.begin());
+        std::copy(frame->cell.begin(),frame->cell.end(),cell.begin());
+        TrajectoryPrefetcher<real>::copyMassesAndCharges(*frame,masses.data(),charges.data());
+        prefetcher->release();
+        frame=nullptr;
+      } else {
+        errormessage=parser.readAtoms(
+                       stride,
+                       pbc_cli_given,
+                       debug_pd,
+                       pd_start,
+                       pd_nlocal,
+                       step,
+                       masses.data(),
+                       charges.data(),
+                       coordinates.data(),
+                       cell.data()
+                     );
+      }
 
       if (errormessage) {
         if (*errormessage =="EOF") {
@@ -1138,11 +1470,44 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     }
 
     step+=stride;
+    // the frames that are not analyzed are skipped, without decoding them for xtc and trr files
+    if(!prefetcher) {
+      for(unsigned i=1; i<frameStride && !noatoms; i++) {
+        if(parser.skipFrame()) {
+          // the end of the trajectory is found again when the next frame is read
+          break;
+        }
+        step+=stride;
+      }
+    }
   }
   if(!parseOnly) {
     p.cmd("runFinalJobs");
   }
 
+  if(frameParallel) {
+    // files are closed when plumed is destroyed
+    const auto outputs=p.getOutputFiles();
+    plumedMain.reset();
+    // this also waits for all the processes to close their files
+    if(frameParallelErrors.finish()>0) {
+      error("one of the processes stopped with an error, the parts of the output files were not merged");
+    }
+    if(pc.Get_rank()==0) {
+      for(const auto & path : outputs) {
+        for(int i=1; i<pc.Get_size(); i++) {
+          std::string n;
+          Tools::convert(i,n);
+          const std::string part=FileBase::appendSuffix(path,".part"+n);
+          if(!appendFile(path,part)) {
+            error("cannot append " + part + " to " + path);
+          }
+          std::remove(part.c_str());
+        }
+      }
+    }
+  }
+
   return 0;
 }
 
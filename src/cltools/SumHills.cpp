@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 #include "tools/File.h"
+#include "tools/BinaryHillsFile.h"
 #include "core/Value.h"
 #include "tools/Matrix.h"
 
@@ -612,6 +613,29 @@ bool CLToolSumHills::findCvsAndPeriodic(const std::string & filename,
                                         bool &multivariate,
                                         std::string &lowI_,
                                         std::string &uppI_) {
+  // binary hills files written with BINARY_HILLS contain the variables in their header
+  if(BinaryHillsFile::isBinary(filename)) {
+    BinaryHillsFile bfile;
+    bfile.open(filename);
+    cvs.clear();
+    pmin.clear();
+    pmax.clear();
+    for(const auto & var : bfile.getVariables()) {
+      size_t dot=var.name.find_first_of('.');
+      if(dot!=std::string::npos) {
+        cvs.emplace_back(std::vector<std::string> {var.name.substr(0,dot),var.name.substr(dot+1)});
+      } else {
+        cvs.emplace_back(std::vector<std::string> {var.name});
+      }
+      pmin.push_back(var.min.length()>0 ? var.min : "none");
+      pmax.push_back(var.max.length()>0 ? var.max : "none");
+    }
+    multivariate=bfile.getNumberOfHills()>0 && bfile.isMultivariate(0);
+    // interval bias is not stored in binary files
+    lowI_="-1.";
+    uppI_="-1.";
+    return true;
+  }
   IFile ifile;
   ifile.allowIgnoredFields();
   std::vector<std::string> fields;
@@ -70,6 +70,14 @@ COORDINATION GROUPA=1-10 GROUPB=20-100 R_0=0.3 NLIST NL_CUTOFF=0.5 NL_STRIDE=100
 COORDINATION GROUPA=1-10 GROUPB=20-100 R_0=0.3 NLISTCELLS NL_CUTOFF=0.5 NL_STRIDE=80
 ```
 
+Instead of choosing NL_STRIDE you can give a skin.  The list below contains all the pairs that are closer than 0.6 nm
+and it is built again with link cells only when one of the atoms has moved more than 0.05 nm since the last time it was built.
+The switching function must be zero beyond NL_CUTOFF-NL_SKIN, which is why D_MAX is used here.
+
+```plumed
+COORDINATION GROUPA=1-10 GROUPB=20-100 SWITCH={RATIONAL R_0=0.3 D_MAX=0.5} NLISTCELLS NL_CUTOFF=0.6 NL_SKIN=0.1
+```
+
 The following is a dummy example which should compute the value 0 because the self interaction
 of atom 1 is skipped. Notice that in plumed 2.0 "self interactions" were not skipped, and the
 same calculation should return 1.
@@ -108,6 +116,8 @@ public:
 // active methods:
   static void registerKeywords( Keywords& keys );
   double pairing(double distance,double&dfunc,unsigned i,unsigned j)const override;
+  void pairingBlock(View<const double> distance2,View<double> result,View<double> dfunc,
+                    View<const unsigned> first,View<const unsigned> second)const override;
 };
 
 PLUMED_REGISTER_ACTION(Coordination,"COORDINATION")
@@ -152,6 +162,7 @@ Coordination::Coordination(const ActionOptions&ao):
   }
 
   checkRead();
+  checkNeighborListCutoff(switchingFunction.get_dmax());
 
   log<<"  contacts are counted with cutoff "<<switchingFunction.description()<<"\n";
 }
@@ -162,6 +173,13 @@ double Coordination::pairing(double distance,double&dfunc,unsigned i,unsigned j)
   return switchingFunction.calculateSqr(distance,dfunc);
 }
 
+void Coordination::pairingBlock(View<const double> distance2,View<double> result,View<double> dfunc,
+                                View<const unsigned> first,View<const unsigned> second)const {
+  (void) first; // avoid warnings
+  (void) second; // avoid warnings
+  switchingFunction.calculateSqr(distance2,result,dfunc);
+}
+
 }
 
 }
@@ -23,10 +23,17 @@
 #include "tools/NeighborList.h"
 #include "tools/Communicator.h"
 #include "tools/OpenMP.h"
+#include "tools/ScratchArena.h"
+#include "core/PlumedMain.h"
+#include <algorithm>
+#include <array>
 
 namespace PLMD {
 namespace colvar {
 
+/// Number of pairs that are passed to pairingBlock() in one call
+static constexpr unsigned pairBlockSize=64;
+
 void CoordinationBase::registerKeywords( Keywords& keys ) {
   Colvar::registerKeywords(keys);
   keys.addFlag("SERIAL",false,"Perform the calculation in serial - for debug purpose");
@@ -35,6 +42,7 @@ void CoordinationBase::registerKeywords( Keywords& keys ) {
   keys.addFlag("NLISTCELLS",false,"Use a neighbor list to speed up the calculation - use the cell list implementation instead of the classical one");
   keys.add("optional","NL_CUTOFF","The cutoff for the neighbor list");
   keys.add("optional","NL_STRIDE","The frequency with which we are updating the atoms in the neighbor list");
+  keys.add("optional","NL_SKIN","Use a Verlet list built with the link cells that is rebuilt only when an atom has moved more than half of this distance. The switching function should be zero beyond NL_CUTOFF-NL_SKIN. NL_STRIDE is not needed with this option");
   keys.add("atoms","GROUPA","First list of atoms");
   keys.add("atoms","GROUPB","Second list of atoms (if empty, N*(N-1)/2 pairs in GROUPA are counted)");
 }
@@ -63,6 +71,7 @@ CoordinationBase::CoordinationBase(const ActionOptions&ao):
 // neighbor list stuff
   bool doneigh_classic=false;
   double nl_cut=0.0;
+  double nl_skin=0.0;
   int nl_st=0;
   parseFlag("NLIST",doneigh_classic);
   bool doneighcells=false;
@@ -76,29 +85,51 @@ CoordinationBase::CoordinationBase(const ActionOptions&ao):
     if(nl_cut<=0.0) {
       error("NL_CUTOFF should be explicitly specified and positive");
     }
+    parse("NL_SKIN",nl_skin);
     parse("NL_STRIDE",nl_st);
+    if(nl_skin>0.0) {
+      if(nl_skin>=nl_cut) {
+        error("NL_SKIN should be smaller than NL_CUTOFF");
+      }
+      if(dopair) {
+        error("NL_SKIN is not compatible with PAIR");
+      }
+      if(nl_st>0) {
+        error("NL_STRIDE should not be specified together with NL_SKIN, the list is checked at every step");
+      }
+      nl_st=1;
+    } else if(nl_skin<0.0) {
+      error("NL_SKIN should be positive");
+    }
     if(nl_st<=0) {
       error("NL_STRIDE should be explicitly specified and positive");
     }
+    nlCutoff=nl_cut;
+    nlSkin=nl_skin;
   }
 
   addValueWithDerivatives();
   setNotPeriodic();
   if(gb_lista.size()>0) {
     if(doneigh) {
-      nl=Tools::make_unique<NeighborList>(ga_lista,gb_lista,serial,dopair,pbc,getPbc(),comm,nl_cut,nl_st,doneighcells);
+      nl=Tools::make_unique<NeighborList>(ga_lista,gb_lista,serial,dopair,pbc,getPbc(),comm,nl_cut,nl_st,doneighcells,nl_skin);
     } else {
       nl=Tools::make_unique<NeighborList>(ga_lista,gb_lista,serial,dopair,pbc,getPbc(),comm);
     }
   } else {
     if(doneigh) {
-      nl=Tools::make_unique<NeighborList>(ga_lista,serial,pbc,getPbc(),comm,nl_cut,nl_st,doneighcells);
+      nl=Tools::make_unique<NeighborList>(ga_lista,serial,pbc,getPbc(),comm,nl_cut,nl_st,doneighcells,nl_skin);
     } else {
       nl=Tools::make_unique<NeighborList>(ga_lista,serial,pbc,getPbc(),comm);
     }
   }
 
   requestAtoms(nl->getFullAtomList());
+  requestSoAPositions();
+// with a neighbor list only few atoms have nonzero derivatives, so only those are stored and used to apply the forces
+  if(doneigh && !checkNumericalDerivatives()) {
+    getPntrToValue()->setSparseDerivatives(true);
+  }
 
   log.printf("  between two groups of %u and %u atoms\n",static_cast<unsigned>(ga_lista.size()),static_cast<unsigned>(gb_lista.size()));
   log.printf("  first group:\n");
@@ -126,24 +157,101 @@ CoordinationBase::CoordinationBase(const ActionOptions&ao):
   }
   if(doneigh) {
     log.printf("  using neighbor lists with\n");
-    log.printf("  update every %d steps and cutoff %f\n",nl_st,nl_cut);
+    if(nl_skin>0.0) {
+      log.printf("  cutoff %f and skin %f, the list is rebuilt with link cells when an atom moves more than %f\n",nl_cut,nl_skin,0.5*nl_skin);
+    } else {
+      log.printf("  update every %d steps and cutoff %f\n",nl_st,nl_cut);
+    }
+    if(getPntrToValue()->hasSparseDerivatives()) {
+      log.printf("  storing only the nonzero derivatives\n");
+    }
+  }
+}
+
+void CoordinationBase::checkNeighborListCutoff(double dmax) {
+  if(nlSkin>0.0 && dmax>nlCutoff-nlSkin) {
+    error("with NL_SKIN the pairing function should be zero beyond NL_CUTOFF-NL_SKIN, use a D_MAX smaller than "+std::to_string(nlCutoff-nlSkin)+" or a larger NL_CUTOFF");
   }
 }
 
 CoordinationBase::~CoordinationBase() {
 // destructor required to delete forward declared class
+  if(nl && nl->getSkin()>0.0 && nl->getNumberOfUpdates()>0) {
+    log.printf("  neighbor list of %s rebuilt %lu times in %lu steps\n",getLabel().c_str(),nl->getNumberOfRebuilds(),nl->getNumberOfUpdates());
+  }
+}
+
+void CoordinationBase::pairingBlock(View<const double> distance2,View<double> result,View<double> dfunc,
+                                    View<const unsigned> first,View<const unsigned> second)const {
+  for(unsigned k=0; k<distance2.size(); ++k) {
+    result[k]=pairing(distance2[k],dfunc[k],first[k],second[k]);
+  }
 }
 
 void CoordinationBase::prepare() {
   std::tie(firsttime,invalidateList) =nl->prepare(this,firsttime, invalidateList).get();
 }
 
+void CoordinationBase::addSparseDerivative(unsigned i,const Vector& d) {
+  if(!isTouched[i]) {
+    isTouched[i]=1;
+    touched.push_back(i);
+  }
+  sparseDeriv[i]+=d;
+}
+
+void CoordinationBase::sumSparseDerivatives() {
+  // only the atoms with nonzero derivatives are exchanged, and all the ranks
+  // add the contributions in the same order so they get the same derivatives
+  const unsigned nrank=comm.Get_size();
+  std::vector<int> counts(nrank),displs(nrank);
+  int mycount=touched.size();
+  comm.Allgather(mycount,counts);
+  int total=0;
+  for(unsigned r=0; r<nrank; ++r) {
+    displs[r]=total;
+    total+=counts[r];
+  }
+  std::vector<unsigned> myindices(touched);
+  std::vector<double> myvalues(3*touched.size());
+  for(unsigned k=0; k<touched.size(); ++k) {
+    for(unsigned j=0; j<3; ++j) {
+      myvalues[3*k+j]=sparseDeriv[touched[k]][j];
+    }
+    sparseDeriv[touched[k]].zero();
+    isTouched[touched[k]]=0;
+  }
+  touched.resize(0);
+  std::vector<unsigned> indices(total);
+  comm.Allgatherv(myindices.data(),mycount,indices.data(),counts.data(),displs.data());
+  for(unsigned r=0; r<nrank; ++r) {
+    counts[r]*=3;
+    displs[r]*=3;
+  }
+  std::vector<double> gathered(3*total);
+  comm.Allgatherv(myvalues.data(),3*mycount,gathered.data(),counts.data(),displs.data());
+  for(int k=0; k<total; ++k) {
+    addSparseDerivative(indices[k],Vector(gathered[3*k],gathered[3*k+1],gathered[3*k+2]));
+  }
+}
+
 // calculator
 void CoordinationBase::calculate() {
 
   double ncoord=0.;
   Tensor virial;
-  std::vector<Vector> deriv(getNumberOfAtoms());
+  // with sparse derivatives only the atoms that have a nonzero derivative are touched,
+  // otherwise the derivatives of all the atoms are accumulated in a buffer from the arena
+  const bool sparse=getPntrToValue()->hasSparseDerivatives();
+  ScratchArena& scratch=plumed.getScratchArena();
+  // the buffers are given back at the end of calculate(), which is called many times with NUMERICAL_DERIVATIVES
+  ScratchArena::Scope scope(scratch);
+  View<Vector> deriv( sparse ? View<Vector>(nullptr,0) : scratch.get<Vector>(getNumberOfAtoms()) );
+  if(sparse && sparseDeriv.size()!=getNumberOfAtoms()) {
+    sparseDeriv.assign(getNumberOfAtoms(),Vector());
+    isTouched.assign(getNumberOfAtoms(),0);
+    touched.resize(0);
+  }
 
   if(nl->getStride()>0 && invalidateList) {
     nl->update(getPositions());
@@ -171,43 +279,87 @@ void CoordinationBase::calculate() {
 
   #pragma omp parallel num_threads(nt)
   {
-    std::vector<Vector> omp_deriv(getPositions().size());
+    View<Vector> omp_deriv( nt>1 && !sparse ? scratch.get<Vector>(getPositions().size()) : View<Vector>(nullptr,0) );
+    // with sparse derivatives each thread keeps the list of its nonzero contributions
+    std::vector<std::pair<unsigned,Vector>> omp_sparse;
     Tensor omp_virial;
+    // the pairs are processed in blocks, so that the switching function
+    // can be calculated on all the distances of a block in a single call
+    std::array<Vector,pairBlockSize> distances;
+    std::array<double,pairBlockSize> distance2;
+    std::array<double,pairBlockSize> result;
+    std::array<double,pairBlockSize> dfunc;
+    std::array<unsigned,pairBlockSize> first;
+    std::array<unsigned,pairBlockSize> second;
+    const VectorSoA& positions=getSoAPositions();
+    const double* x=positions.x();
+    const double* y=positions.y();
+    const double* z=positions.z();
 
     #pragma omp for reduction(+:ncoord) nowait
-    for(unsigned int i=start; i<end; ++i) {
-
-      Vector distance;
-      const auto [i0, i1] = nl->getUpdatedPair(i);
-
-      if(getAbsoluteIndex(i0)==getAbsoluteIndex(i1)) {
-        continue;
+    for(unsigned int b=start; b<end; b+=pairBlockSize) {
+      const unsigned bend=std::min(b+pairBlockSize,end);
+      unsigned n=0;
+      for(unsigned int i=b; i<bend; ++i) {
+        const auto [i0, i1] = nl->getUpdatedPair(i);
+
+        if(getAbsoluteIndex(i0)==getAbsoluteIndex(i1)) {
+          continue;
+        }
+
+        first[n]=i0;
+        second[n]=i1;
+        ++n;
+      }
+      // the positions are gathered in a separate loop with no branches, so that
+      // the compiler can use vector gathers on the three arrays
+      double* dist=&distances[0][0];
+      #pragma omp simd
+      for(unsigned k=0; k<n; ++k) {
+        dist[3*k]=x[second[k]]-x[first[k]];
+        dist[3*k+1]=y[second[k]]-y[first[k]];
+        dist[3*k+2]=z[second[k]]-z[first[k]];
       }
-
       if(pbc) {
-        distance=pbcDistance(getPosition(i0),getPosition(i1));
-      } else {
-        distance=delta(getPosition(i0),getPosition(i1));
+        getPbc().apply(VectorView(&distances[0][0],n));
+      }
+      for(unsigned k=0; k<n; ++k) {
+        distance2[k]=distances[k].modulo2();
       }
 
-      double dfunc=0.;
-      ncoord += pairing(distance.modulo2(), dfunc,i0,i1);
-
-      Vector dd(dfunc*distance);
-      Tensor vv(dd,distance);
-      if(nt>1) {
-        omp_deriv[i0]-=dd;
-        omp_deriv[i1]+=dd;
-        omp_virial-=vv;
-      } else {
-        deriv[i0]-=dd;
-        deriv[i1]+=dd;
-        virial-=vv;
+      pairingBlock(View<const double>(distance2.data(),n),View<double>(result.data(),n),View<double>(dfunc.data(),n),
+                   View<const unsigned>(first.data(),n),View<const unsigned>(second.data(),n));
+
+      for(unsigned k=0; k<n; ++k) {
+        ncoord += result[k];
+
+        Vector dd(dfunc[k]*distances[k]);
+        Tensor vv(dd,distances[k]);
+        if(sparse) {
+          if(dfunc[k]!=0.0) {
+            omp_sparse.emplace_back(first[k],-dd);
+            omp_sparse.emplace_back(second[k],dd);
+            omp_virial-=vv;
+          }
+        } else if(nt>1) {
+          omp_deriv[first[k]]-=dd;
+          omp_deriv[second[k]]+=dd;
+          omp_virial-=vv;
+        } else {
+          deriv[first[k]]-=dd;
+          deriv[second[k]]+=dd;
+          virial-=vv;
+        }
       }
 
     }
     #pragma omp critical
-    if(nt>1) {
+    if(sparse) {
+      for(const auto & d : omp_sparse) {
+        addSparseDerivative(d.first,d.second);
+      }
+      virial+=omp_virial;
+    } else if(nt>1) {
       for(unsigned i=0; i<getPositions().size(); i++) {
         deriv[i]+=omp_deriv[i];
       }
@@ -217,14 +369,29 @@ void CoordinationBase::calculate() {
 
   if(!serial) {
     comm.Sum(ncoord);
-    if(!deriv.empty()) {
+    if(sparse) {
+      if(comm.Get_size()>1) {
+        sumSparseDerivatives();
+      }
+    } else if(deriv.size()>0) {
       comm.Sum(&deriv[0][0],3*deriv.size());
     }
     comm.Sum(virial);
   }
 
-  for(unsigned i=0; i<deriv.size(); ++i) {
-    setAtomsDerivatives(i,deriv[i]);
+  if(sparse) {
+    for(const auto i : touched) {
+      if(sparseDeriv[i].modulo2()>0.0) {
+        setAtomsDerivatives(i,sparseDeriv[i]);
+      }
+      sparseDeriv[i].zero();
+      isTouched[i]=0;
+    }
+    touched.resize(0);
+  } else {
+    for(unsigned i=0; i<deriv.size(); ++i) {
+      setAtomsDerivatives(i,deriv[i]);
+    }
   }
   setValue           (ncoord);
   setBoxDerivatives  (virial);
@@ -22,7 +22,9 @@
 #ifndef __PLUMED_colvar_CoordinationBase_h
 #define __PLUMED_colvar_CoordinationBase_h
 #include "Colvar.h"
+#include "tools/View.h"
 #include <memory>
+#include <vector>
 
 namespace PLMD {
 
@@ -34,9 +36,24 @@ class CoordinationBase : public Colvar {
   bool pbc;
   bool serial;
   std::unique_ptr<NeighborList> nl;
+/// The cutoff and the skin of the neighbor list
+  double nlCutoff=0.0;
+  double nlSkin=0.0;
   bool invalidateList;
   bool firsttime;
+/// With sparse derivatives, the derivatives of the atoms in touched (all the others are zero)
+  std::vector<Vector> sparseDeriv;
+  std::vector<char> isTouched;
+  std::vector<unsigned> touched;
+/// Add d to the derivative of atom i, with sparse derivatives
+  void addSparseDerivative(unsigned i,const Vector& d);
+/// Sum the sparse derivatives of all the ranks
+  void sumSparseDerivatives();
 
+protected:
+/// Check that the pairing function, which is zero beyond dmax, can be used with the neighbor list.
+/// With NL_SKIN the pairs that are farther than NL_CUTOFF-NL_SKIN might be missing from the list
+  void checkNeighborListCutoff(double dmax);
 public:
   explicit CoordinationBase(const ActionOptions&);
   ~CoordinationBase();
@@ -44,6 +61,10 @@ public:
   void calculate() override;
   void prepare() override;
   virtual double pairing(double distance,double&dfunc,unsigned i,unsigned j)const=0;
+/// Calculate the pairing function for a block of squared distances between the atoms in first and second.
+/// By default pairing() is called for each pair, override it if the block can be calculated faster
+  virtual void pairingBlock(View<const double> distance2,View<double> result,View<double> dfunc,
+                            View<const unsigned> first,View<const unsigned> second)const;
   static void registerKeywords( Keywords& keys );
 };
 
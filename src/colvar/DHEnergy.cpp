@@ -24,6 +24,8 @@
 #include "core/ActionRegister.h"
 #include "core/PlumedMain.h"
 
+#include <limits>
+
 namespace PLMD {
 namespace colvar {
 
@@ -115,6 +117,8 @@ DHEnergy::DHEnergy(const ActionOptions&ao):
   parse("TEMP",T);
   parse("EPSILON",epsilon);
   checkRead();
+  // the Debye-Huckel energy is never exactly zero
+  checkNeighborListCutoff(std::numeric_limits<double>::max());
   if( usingNaturalUnits() ) {
     error("DHENERGY cannot be used for calculations performed with natural units");
   }
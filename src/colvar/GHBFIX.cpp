@@ -109,6 +109,7 @@ GHBFIX::GHBFIX(const ActionOptions&ao):
   std::string energy_units ="plumed" ;
 
   parse("D_MAX",dmax);
+  checkNeighborListCutoff(dmax);
   dmax_squared = dmax*dmax;
   parse("D_0",d0);
   parse("C",c);
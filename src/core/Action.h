@@ -266,6 +266,14 @@ public:
 /// The set of all Actions in run for the final time in forward order.
   virtual void runFinalJobs() {}
 
+/// Check if the result of this action on a frame depends on the frames that were
+/// analyzed before it (e.g. because it accumulates averages or deposits a bias).
+/// Actions that return true cannot be used when the frames of a trajectory are
+/// analyzed independently, as in plumed driver --frame-parallel.
+  virtual bool isHistoryDependent() const {
+    return false;
+  }
+
 /// Tell to the Action to flush open files
   void fflush();
 
@@ -44,6 +44,7 @@ ActionAtomistic::~ActionAtomistic() {
 ActionAtomistic::ActionAtomistic(const ActionOptions&ao):
   Action(ao),
   unique_local_needs_update(true),
+  useSoAPositions(false),
   boxValue(NULL),
   lockRequestAtoms(false),
   donotretrieve(false),
@@ -120,6 +121,9 @@ void ActionAtomistic::requestAtoms(const std::vector<AtomNumber> & a, const bool
   int nat=a.size();
   indexes=a;
   actionPositions.resize(nat);
+  if(useSoAPositions) {
+    soaPositions.resize(nat);
+  }
   forces.resize(nat);
   masses.resize(nat);
   charges.resize(nat);
@@ -212,8 +216,14 @@ void ActionAtomistic::calculateAtomicNumericalDerivatives( ActionWithValue* a, c
     for(int k=0; k<3; k++) {
       savedPositions[i][k]=actionPositions[i][k];
       actionPositions[i][k]=actionPositions[i][k]+delta;
+      if(useSoAPositions) {
+        soaPositions.set(i,actionPositions[i]);
+      }
       a->calculate();
       actionPositions[i][k]=savedPositions[i][k];
+      if(useSoAPositions) {
+        soaPositions.set(i,actionPositions[i]);
+      }
       for(unsigned j=0; j<nval; j++) {
         value[j*natoms+i][k]=a->getOutputQuantity(j);
       }
@@ -230,12 +240,14 @@ void ActionAtomistic::calculateAtomicNumericalDerivatives( ActionWithValue* a, c
       for(unsigned j=0; j<natoms; j++) {
         actionPositions[j]=actionPbc.scaledToReal(actionPositions[j]);
       }
+      updateSoAPositions();
       a->calculate();
       box(i,k)=arg0;
       actionPbc.setBox(box);
       for(unsigned j=0; j<natoms; j++) {
         actionPositions[j]=savedPositions[j];
       }
+      updateSoAPositions();
       for(unsigned j=0; j<nval; j++) {
         valuebox[j](i,k)=a->getOutputQuantity(j);
       }
@@ -496,6 +508,7 @@ void ActionAtomistic::retrieveAtoms( const bool& force ) {
       j++;
     }
   }
+  updateSoAPositions();
 
 }
 
@@ -536,6 +549,38 @@ void ActionAtomistic::setForcesOnAtoms(const std::vector<double>& forcesToApply,
   setForcesOnCell( forcesToApply, ind );
 }
 
+void ActionAtomistic::setForcesOnAtoms(const std::vector<double>& forcesToApply, const std::vector<unsigned>& nonzero, unsigned& ind) {
+  if( donotforce || (indexes.size()==0 && getName()!="FIXEDATOM") ) {
+    return;
+  }
+  for(unsigned i=0; i<value_depends.size(); ++i) {
+    xpos[value_depends[i]]->hasForce = true;
+    ypos[value_depends[i]]->hasForce = true;
+    zpos[value_depends[i]]->hasForce = true;
+  }
+
+  const unsigned start=ind, end=ind+3*atom_value_ind.size();
+  for(const auto & j : nonzero) {
+    if( j<start || j>=end ) {
+      continue;
+    }
+    const auto & a=atom_value_ind[(j-start)/3];
+    switch( (j-start)%3 ) {
+    case 0:
+      xpos[a.first]->inputForce[a.second] += forcesToApply[j];
+      break;
+    case 1:
+      ypos[a.first]->inputForce[a.second] += forcesToApply[j];
+      break;
+    default:
+      zpos[a.first]->inputForce[a.second] += forcesToApply[j];
+    }
+  }
+  ind=end;
+
+  setForcesOnCell( forcesToApply, ind );
+}
+
 void ActionAtomistic::setForcesOnCell(const std::vector<double>& forcesToApply, unsigned& ind) {
   setForcesOnCell(forcesToApply.data(),forcesToApply.size(),ind);
 }
@@ -568,6 +613,7 @@ void ActionAtomistic::readAtomsFromPDB(const PDB& pdb) {
     }
     actionPositions[j]=pdb.getPositions()[indexes[j].index()];
   }
+  updateSoAPositions();
   for(unsigned j=0; j<indexes.size(); j++) {
     charges[j]=pdb.getBeta()[indexes[j].index()];
   }
@@ -604,6 +650,18 @@ void ActionAtomistic::makeWhole() {
       second=first+pbcDistance(first,second);
     }
   }
+  updateSoAPositions();
+}
+
+void ActionAtomistic::requestSoAPositions() {
+  useSoAPositions=true;
+  updateSoAPositions();
+}
+
+void ActionAtomistic::updateSoAPositions() {
+  if(useSoAPositions) {
+    soaPositions.assign(View<const Vector>(actionPositions.data(),actionPositions.size()));
+  }
 }
 
 void ActionAtomistic::getGradient( const unsigned& ind, Vector& deriv, std::map<AtomNumber,Vector>& gradients ) const {
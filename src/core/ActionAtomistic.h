@@ -26,6 +26,7 @@
 #include "tools/Tensor.h"
 #include "tools/Pbc.h"
 #include "tools/ForwardDecl.h"
+#include "tools/VectorSoA.h"
 #include "Value.h"
 #include <vector>
 #include <map>
@@ -60,6 +61,8 @@ class ActionAtomistic :
   bool unique_local_needs_update;
   std::vector<AtomNumber>  unique_local;
   std::vector<Vector>   actionPositions;       // positions of the needed atoms
+  bool                  useSoAPositions;       // keep a structure-of-arrays copy of the positions
+  VectorSoA             soaPositions;
   double                energy;
   Value*                boxValue;
   ForwardDecl<Pbc>      pbc_fwd;
@@ -84,6 +87,8 @@ class ActionAtomistic :
 /// Values that hold information about atom positions and charges
   std::vector<Value*>   xpos, ypos, zpos, masv, chargev;
   void updateUniqueLocal( const bool& useunique, const std::vector<int>& g2l );
+/// Copy the positions to the structure-of-arrays copy
+  void updateSoAPositions();
 protected:
   bool                  massesWereSet;
   bool                  chargesWereSet;
@@ -116,6 +121,12 @@ public:
   const Tensor & getBox()const;
 /// Get the array of all positions
   const std::vector<Vector> & getPositions()const;
+/// Keep a structure-of-arrays copy of the positions (x, y and z in separate aligned arrays).
+/// Should be called in the constructor by actions with loops that benefit from it
+  void requestSoAPositions();
+/// Get the structure-of-arrays copy of the positions, requestSoAPositions() must have been called.
+/// It is updated together with the positions, also by makeWhole() and by the numerical derivatives
+  const VectorSoA & getSoAPositions()const;
 /// Get the array of all masses
   const std::vector<double>& getMasses()const;
 /// Get the array of all charges
@@ -162,6 +173,8 @@ public:
   const Pbc & getPbc() const;
 /// Add the forces to the atoms
   void setForcesOnAtoms( const std::vector<double>& forcesToApply, unsigned& ind );
+/// Add the forces to the atoms when only the forces in the list nonzero can be different from zero
+  void setForcesOnAtoms( const std::vector<double>& forcesToApply, const std::vector<unsigned>& nonzero, unsigned& ind );
 /// Add the virial forces
   void setForcesOnCell(const std::vector<double>& forcesToApply, unsigned& ind);
 /// Add the virial forces (span-like syntax)
@@ -249,6 +262,12 @@ const std::vector<Vector> & ActionAtomistic::getPositions()const {
   return actionPositions;
 }
 
+inline
+const VectorSoA & ActionAtomistic::getSoAPositions()const {
+  plumed_dbg_massert(useSoAPositions,"the structure-of-arrays positions have not been requested");
+  return soaPositions;
+}
+
 inline
 const std::vector<double> & ActionAtomistic::getMasses()const {
   return masses;
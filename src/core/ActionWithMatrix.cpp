@@ -21,6 +21,7 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "ActionWithMatrix.h"
 #include "tools/Communicator.h"
+#include "tools/CSRMatrix.h"
 
 namespace PLMD {
 
@@ -97,6 +98,20 @@ void ActionWithMatrix::updateBookeepingArrays( RequiredMatrixElements& outmat )
   }
 }
 
+void ActionWithMatrix::updateBookeepingArrays( const CSRMatrix& pattern, RequiredMatrixElements& outmat ) {
+  RequiredMatrixElementsUpdater updater(outmat);
+  Value* myval = getPntrToComponent(0);
+  myval->setMatrixFromCSR( pattern );
+  outmat.ncols = myval->getNumberOfColumns();
+  outmat.resize( myval->matrix_bookeeping.size() );
+  for(unsigned i=0; i<outmat.size(); ++i) {
+    outmat[i] = myval->matrix_bookeeping[i];
+  }
+  for(unsigned i=1; i<getNumberOfComponents(); ++i) {
+    getPntrToComponent(i)->copyBookeepingArrayFromArgument( myval );
+  }
+}
+
 void ActionWithMatrix::transferStashToValues( const std::vector<unsigned>& partialTaskList, const std::vector<double>& stash ) {
   unsigned ncomp = getNumberOfComponents();
   unsigned ncols = getPntrToComponent(0)->getNumberOfColumns();
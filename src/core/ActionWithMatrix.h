@@ -27,6 +27,8 @@
 
 namespace PLMD {
 
+class CSRMatrix;
+
 //this class serves as a workaround for moving data with openacc without specifying --memory=managed
 class RequiredMatrixElements {
   std::vector<std::size_t> bookeeping{};
@@ -74,6 +76,8 @@ protected:
   bool diagzero;
 /// Update all the arrays for doing bookeeping
   void updateBookeepingArrays( RequiredMatrixElements& mat );
+/// Update all the arrays for doing bookeeping so only the elements in the input sparse matrix are computed
+  void updateBookeepingArrays( const CSRMatrix& pattern, RequiredMatrixElements& mat );
 public:
   static void registerKeywords( Keywords& keys );
   explicit ActionWithMatrix(const ActionOptions&);
@@ -356,8 +356,22 @@ bool ActionWithValue::checkForForces() {
   // Make sure forces to apply is empty of forces
   if( forcesForApply.size()!=nder ) {
     forcesForApply.resize( nder );
+    forcesAreSparse=false;
+  }
+
+  bool allsparse=true;
+  for(unsigned i=0; i<nvalsWithForce; ++i) {
+    if( !values[valsToForce[i]]->hasSparseDerivatives() ) {
+      allsparse=false;
+      break;
+    }
+  }
+  if( allsparse ) {
+    checkForSparseForces( nvalsWithForce );
+    return true;
   }
   std::fill(forcesForApply.begin(),forcesForApply.end(),0);
+  forcesAreSparse=false;
 
   unsigned stride=1;
   unsigned rank=0;
@@ -413,4 +427,31 @@ bool ActionWithValue::checkForForces() {
   return true;
 }
 
+void ActionWithValue::checkForSparseForces( const unsigned nvalsWithForce ) {
+  // Only the forces that were set in the last step have to be cleared
+  if( forcesAreSparse ) {
+    for(const auto & j : sparseForces) {
+      forcesForApply[j]=0;
+      isSparseForce[j]=0;
+    }
+  } else {
+    std::fill(forcesForApply.begin(),forcesForApply.end(),0);
+    isSparseForce.assign(forcesForApply.size(),0);
+  }
+  sparseForces.resize(0);
+  // The derivatives are the same on all the ranks so there is no need to divide this loop
+  for(unsigned i=0; i<nvalsWithForce; ++i) {
+    const Value* myval=values[valsToForce[i]].get();
+    double ff=myval->inputForce[0];
+    for(const auto & j : myval->getNonzeroDerivatives()) {
+      if( !isSparseForce[j] ) {
+        isSparseForce[j]=1;
+        sparseForces.push_back(j);
+      }
+      forcesForApply[j] += ff*myval->data[1+j];
+    }
+  }
+  forcesAreSparse=true;
+}
+
 }
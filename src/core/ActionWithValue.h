@@ -76,6 +76,13 @@ private:
 /// A vector that is used to hold the forces that we will apply on the input quantities
   std::vector<double> forcesForApply;
   std::vector<unsigned> valsToForce;
+/// Are the elements of forcesForApply that can be nonzero listed in sparseForces
+  bool forcesAreSparse=false;
+/// The elements of forcesForApply that can be nonzero when all the values with forces have sparse derivatives
+  std::vector<unsigned> sparseForces;
+  std::vector<unsigned char> isSparseForce;
+/// Accumulate the forces from values that have sparse derivatives
+  void checkForSparseForces( const unsigned nvalsWithForce );
 /// Are we skipping the calculation of the derivatives
   bool noderiv;
 /// Are we using numerical derivatives to differentiate
@@ -124,6 +131,10 @@ protected:
   bool checkForForces();
 /// Get the forces to apply
   const std::vector<double>& getForcesToApply() const;
+/// Are only the forces to apply in getSparseForcesToApply() nonzero
+  bool forcesToApplyAreSparse() const;
+/// Get the list of the forces to apply that can be nonzero
+  const std::vector<unsigned>& getSparseForcesToApply() const;
 public:
   explicit ActionWithValue(const ActionOptions&ao);
   ~ActionWithValue();
@@ -246,6 +257,16 @@ const std::vector<double>& ActionWithValue::getForcesToApply() const {
   return forcesForApply;
 }
 
+inline
+bool ActionWithValue::forcesToApplyAreSparse() const {
+  return forcesAreSparse;
+}
+
+inline
+const std::vector<unsigned>& ActionWithValue::getSparseForcesToApply() const {
+  return sparseForces;
+}
+
 inline
 Value* ActionWithValue::getPntrToValue() {
   plumed_dbg_massert(values.size()==1,"The number of components is not equal to one");
@@ -52,7 +52,9 @@ void Colvar::apply() {
     return ;
   }
   unsigned ind=0;
-  if( getNumberOfAtoms()>0 ) {
+  if( getNumberOfAtoms()>0 && forcesToApplyAreSparse() ) {
+    setForcesOnAtoms( getForcesToApply(), getSparseForcesToApply(), ind );
+  } else if( getNumberOfAtoms()>0 ) {
     setForcesOnAtoms( getForcesToApply(), ind );
   } else {
     setForcesOnCell( getForcesToApply(), ind );
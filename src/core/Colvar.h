@@ -72,6 +72,12 @@ public:
 
 inline
 void Colvar::setAtomsDerivatives(Value*v,int i,const Vector&d) {
+  if( v->hasSparseDerivatives() ) {
+    v->addSparseDerivative(3*i+0,d[0]);
+    v->addSparseDerivative(3*i+1,d[1]);
+    v->addSparseDerivative(3*i+2,d[2]);
+    return;
+  }
   v->addDerivative(3*i+0,d[0]);
   v->addDerivative(3*i+1,d[1]);
   v->addDerivative(3*i+2,d[2]);
@@ -81,6 +87,14 @@ void Colvar::setAtomsDerivatives(Value*v,int i,const Vector&d) {
 inline
 void Colvar::setBoxDerivatives(Value* v,const Tensor&d) {
   unsigned nat=getNumberOfAtoms();
+  if( v->hasSparseDerivatives() ) {
+    for(unsigned i=0; i<3; ++i) {
+      for(unsigned j=0; j<3; ++j) {
+        v->addSparseDerivative(3*nat+3*i+j,d(i,j));
+      }
+    }
+    return;
+  }
   v->addDerivative(3*nat+0,d(0,0));
   v->addDerivative(3*nat+1,d(0,1));
   v->addDerivative(3*nat+2,d(0,2));
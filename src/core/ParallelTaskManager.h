@@ -24,14 +24,19 @@
 
 #include "ActionWithVector.h"
 #include "ActionWithMatrix.h"
+#include "PlumedMain.h"
 #include "tools/Communicator.h"
 #include "tools/OpenMP.h"
 #include "tools/View.h"
 #include "tools/View2D.h"
+#include "tools/WorkStealingScheduler.h"
+#include "tools/ScratchArena.h"
 
 #include "tools/ColvarOutput.h"
 #include "tools/OpenACC.h"
 
+#include <chrono>
+
 namespace PLMD {
 
 struct ArgumentsBookkeeping {
@@ -427,6 +432,10 @@ protected:
   bool serial;
 /// Are we using acc for parallisation
   bool useacc;
+/// Are we using the work stealing scheduler to distribute tasks over threads
+  bool worksteal;
+/// The scheduler that balances the tasks over the threads and collects load imbalance statistics
+  WorkStealingScheduler scheduler;
 /// Number of derivatives calculated for each task
   std::size_t nderivatives_per_task;
 /// The number of forces on each thread
@@ -452,6 +461,7 @@ protected:
 public:
   static void registerKeywords( Keywords& keys );
   ParallelTaskManager(ActionWithVector* av);
+  ~ParallelTaskManager();
 /// Setup the parallel task manager the three arguments are
 /// nder = number of derivatives per scalar
 /// nforce_ts = number of forces that are modified by multiple tasks
@@ -492,6 +502,8 @@ template <class T>
 void ParallelTaskManager<T>::registerKeywords( Keywords& keys ) {
   keys.addFlag("SERIAL",false,"do the calculation in serial.  Do not parallelize");
   keys.addFlag("USEGPU",false,"run this calculation on the GPU");
+  keys.add("compulsory","TASK_SCHEDULE","STATIC","how the tasks are distributed over the OpenMP threads. STATIC divides the tasks evenly between the threads. "
+           "WORKSTEAL divides the tasks into chunks with the same measured cost and lets threads that have finished their chunks take chunks from the other threads");
   keys.addLinkInDocForFlag("USEGPU","gpu.md");
   keys.addLinkInDocForFlag("SERIAL", "actions.md");
 }
@@ -502,6 +514,7 @@ ParallelTaskManager<T>::ParallelTaskManager(ActionWithVector* av):
   comm(av->comm),
   ismatrix(false),
   useacc(false),
+  worksteal(false),
   nderivatives_per_task(0),
   nthreaded_forces(0),
   myinput(ParallelActionsInput::create(av->getPbc())),
@@ -524,6 +537,21 @@ ParallelTaskManager<T>::ParallelTaskManager(ActionWithVector* av):
   if( serial ) {
     action->log.printf("  not using MPI to parallelise this action\n");
   }
+  std::string schedule;
+  action->parse("TASK_SCHEDULE",schedule);
+  if( schedule=="WORKSTEAL" ) {
+    worksteal=true;
+    action->log.printf("  using work stealing to distribute tasks over threads\n");
+  } else if( schedule!="STATIC" ) {
+    action->error("TASK_SCHEDULE should be STATIC or WORKSTEAL");
+  }
+}
+
+template <class T>
+ParallelTaskManager<T>::~ParallelTaskManager() {
+  if( (worksteal || action->plumed.detailedTimers) && scheduler.hasStatistics() && action->log.isOpen() ) {
+    action->log << scheduler.report( action->getLabel() );
+  }
 }
 
 template <class T>
@@ -646,14 +674,27 @@ void ParallelTaskManager<T>::runAllTasks() {
     if( nt==0 ) {
       nt=1;
     }
+    // Number of tasks this rank is responsible for
+    unsigned nmytasks = nactive_tasks>rank ? (nactive_tasks-rank+stride-1)/stride : 0;
+    if( worksteal ) {
+      unsigned ntasks=0;
+      action->getNumberOfTasks( ntasks );
+      scheduler.resizeTasks( ntasks );
+      scheduler.prepare( nmytasks, nt, [&](unsigned k) {
+        return partialTaskList[rank+k*stride];
+      } );
+    } else {
+      scheduler.resetThreadTimes( nt );
+    }
 
+    // The workspaces come from the scratch arena so nothing is allocated once the first steps are done
+    ScratchArena& scratch=action->plumed.getScratchArena();
+    ScratchArena::Scope scope( scratch );
     #pragma omp parallel num_threads(nt)
     {
-      std::vector<precision> buffer( workspace_size );
-      std::vector<precision> derivatives( nderivatives_per_task );
-      #pragma omp for nowait
-      for(unsigned i=rank; i<nactive_tasks; i+=stride) {
-        std::size_t task_index = partialTaskList[i];
+      View<precision> buffer( scratch.get<precision>( workspace_size ) );
+      View<precision> derivatives( scratch.get<precision>( nderivatives_per_task ) );
+      auto runTask=[&]( std::size_t task_index ) {
         std::size_t val_pos = task_index*myinput.nscalars;
         auto myout = ParallelActionsOutput::create ( myinput.nscalars,
                      value_stash.data()+val_pos,
@@ -663,8 +704,33 @@ void ParallelTaskManager<T>::runAllTasks() {
                      buffer.data() );
         // Calculate the stuff in the loop for this action
         T::performTask( task_index, actiondata, myinput, myout );
+      };
+      const unsigned t=OpenMP::getThreadNum();
+      double busy=0;
+      if( worksteal ) {
+        // Time each task so that the chunks are balanced by cost in the next step
+        unsigned begin, end;
+        while( scheduler.nextChunk( t, begin, end ) ) {
+          for(unsigned k=begin; k<end; ++k) {
+            std::size_t task_index = partialTaskList[rank+k*stride];
+            auto tstart = std::chrono::steady_clock::now();
+            runTask( task_index );
+            double cost = std::chrono::duration<double>( std::chrono::steady_clock::now()-tstart ).count();
+            scheduler.setTaskCost( task_index, cost );
+            busy += cost;
+          }
+        }
+      } else {
+        auto tstart = std::chrono::steady_clock::now();
+        #pragma omp for nowait
+        for(unsigned i=rank; i<nactive_tasks; i+=stride) {
+          runTask( partialTaskList[i] );
+        }
+        busy = std::chrono::duration<double>( std::chrono::steady_clock::now()-tstart ).count();
       }
+      scheduler.addThreadTime( t, busy );
     }
+    scheduler.finishStep();
     // MPI Gather everything
     if( !serial ) {
       comm.Sum( value_stash );
@@ -727,19 +793,29 @@ void ParallelTaskManager<T>::applyForces( std::vector<double>& forcesForApply )
     if( nt==0 ) {
       nt=1;
     }
+    if( worksteal ) {
+      // Reuse the costs that were measured when the tasks were run in the forward loop
+      unsigned ntasks=0;
+      action->getNumberOfTasks( ntasks );
+      scheduler.resizeTasks( ntasks );
+      unsigned nmytasks = nactive_tasks>rank ? (nactive_tasks-rank+stride-1)/stride : 0;
+      scheduler.prepare( nmytasks, nt, [&](unsigned k) {
+        return partialTaskList[rank+k*stride];
+      } );
+    }
+    ScratchArena& scratch=action->plumed.getScratchArena();
+    ScratchArena::Scope scope( scratch );
     #pragma omp parallel num_threads(nt)
     {
       const unsigned t=OpenMP::getThreadNum();
       omp_forces[t].assign( omp_forces[t].size(), 0.0 );
-      std::vector<precision> buffer( workspace_size );
-      std::vector<precision> fake_vals( myinput.sizeOfFakeVals() );
-      std::vector<precision> derivatives( nderivatives_per_task );
-      std::vector<std::size_t> indices(ForceIndexHolder::indexesPerScalar(myinput));
+      View<precision> buffer( scratch.get<precision>( workspace_size ) );
+      View<precision> fake_vals( scratch.get<precision>( myinput.sizeOfFakeVals() ) );
+      View<precision> derivatives( scratch.get<precision>( nderivatives_per_task ) );
+      View<std::size_t> indices( scratch.get<std::size_t>( ForceIndexHolder::indexesPerScalar(myinput) ) );
 
       auto force_indices = ForceIndexHolder::create( myinput,indices.data() );
-      #pragma omp for nowait
-      for(unsigned i=rank; i<nactive_tasks; i+=stride) {
-        std::size_t task_index = partialTaskList[i];
+      auto applyTask=[&]( std::size_t task_index ) {
         auto myout = ParallelActionsOutput::create( myinput.nscalars,
                      fake_vals.data(),
                      derivatives.size(),
@@ -782,6 +858,19 @@ void ParallelTaskManager<T>::applyForces( std::vector<double>& forcesForApply )
                                     View<precision>(omp_forces[t].data(),
                                         omp_forces[t].size()) );
         }
+      };
+      if( worksteal ) {
+        unsigned begin, end;
+        while( scheduler.nextChunk( t, begin, end ) ) {
+          for(unsigned k=begin; k<end; ++k) {
+            applyTask( partialTaskList[rank+k*stride] );
+          }
+        }
+      } else {
+        #pragma omp for nowait
+        for(unsigned i=rank; i<nactive_tasks; i+=stride) {
+          applyTask( partialTaskList[i] );
+        }
       }
 
       #pragma omp critical
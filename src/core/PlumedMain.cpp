@@ -39,10 +39,12 @@
 #include "tools/DLLoader.h"
 #include "tools/Exception.h"
 #include "tools/IFile.h"
+#include "tools/OFile.h"
 #include "tools/Log.h"
 #include "tools/OpenMP.h"
 #include "tools/Tools.h"
 #include "tools/Stopwatch.h"
+#include "tools/ScratchArena.h"
 #include "tools/TypesafePtr.h"
 #include "lepton/Exception.h"
 #include "DataPassingTools.h"
@@ -287,6 +289,7 @@ PlumedMain::PlumedMain():
   datoms_fwd(*this),
 // automatically write on log in destructor
   stopwatch_fwd(log),
+  scratch_fwd(&log),
   actionSet_fwd(*this),
   passtools(DataPassingTools::create(sizeof(double))) {
   passtools->usingNaturalUnits=false;
@@ -1285,6 +1288,14 @@ void PlumedMain::justCalculate() {
     }
   }
 
+  // Actions that do not depend on each other can be calculated at the same time.
+  // This is not done on the first step as the values that depend on masses and
+  // charges are set up in input order then.
+  if( concurrentActions && !firststep && !detailedTimers && OpenMP::getNumThreads()>1 ) {
+    justCalculateConcurrently();
+    return;
+  }
+
   int iaction=0;
 // calculate the active actions in order (assuming *backward* dependence)
   for(const auto & pp : actionSet) {
@@ -1308,42 +1319,10 @@ void PlumedMain::justCalculate() {
           swh=stopwatch.startStop("4A " + spaces + actionNumberLabel+" "+p->getLabel());
         }
         ActionWithValue*av=p->castToActionWithValue();
-        ActionAtomistic*aa=p->castToActionAtomistic();
-        {
-          if(av) {
-            av->clearInputForces();
-          }
-          if(av) {
-            av->clearDerivatives();
-          }
-          if( av && av->calculateOnUpdate() ) {
-            continue ;
-          }
-        }
-        {
-          if(aa)
-            if(aa->isActive()) {
-              aa->retrieveAtoms();
-            }
-        }
-        if(p->checkNumericalDerivatives()) {
-          p->calculateNumericalDerivatives();
-        } else {
-          p->calculate();
-        }
-        // This retrieves components called bias
-        if(av) {
+        if( calculateAction( p, firststep ) && av ) {
+          // This retrieves components called bias
           bias+=av->getOutputQuantity("bias");
           work+=av->getOutputQuantity("work");
-          av->setGradientsIfNeeded();
-        }
-        // This makes all values that depend on the (fixed) masses and charges constant
-        if( firststep ) {
-          p->setupConstantValues( true );
-        }
-        ActionWithVirtualAtom*avv=p->castToActionWithVirtualAtom();
-        if(avv) {
-          avv->setGradientsIfNeeded();
         }
       }
     } catch(...) {
@@ -1353,6 +1332,184 @@ void PlumedMain::justCalculate() {
   }
 }
 
+bool PlumedMain::calculateAction( Action* p, bool firststep ) {
+  ActionWithValue*av=p->castToActionWithValue();
+  ActionAtomistic*aa=p->castToActionAtomistic();
+  {
+    if(av) {
+      av->clearInputForces();
+    }
+    if(av) {
+      av->clearDerivatives();
+    }
+    if( av && av->calculateOnUpdate() ) {
+      return false;
+    }
+  }
+  {
+    if(aa)
+      if(aa->isActive()) {
+        aa->retrieveAtoms();
+      }
+  }
+  if(p->checkNumericalDerivatives()) {
+    p->calculateNumericalDerivatives();
+  } else {
+    p->calculate();
+  }
+  if(av) {
+    av->setGradientsIfNeeded();
+  }
+  // This makes all values that depend on the (fixed) masses and charges constant
+  if( firststep ) {
+    p->setupConstantValues( true );
+  }
+  ActionWithVirtualAtom*avv=p->castToActionWithVirtualAtom();
+  if(avv) {
+    avv->setGradientsIfNeeded();
+  }
+  return true;
+}
+
+namespace {
+
+/// The dependency graph between the actions that are active at a given step.
+/// Each action is run on an OpenMP task as soon as all the actions it depends on
+/// have been calculated.
+class ConcurrentActionGraph {
+  std::vector<Action*> actions;
+/// The actions that are waiting for each action
+  std::vector<std::vector<unsigned> > dependents;
+/// The number of actions each action is still waiting for
+  std::unique_ptr<std::atomic<unsigned>[]> npending;
+/// The actions that were calculated (as opposed to calculated on update)
+  std::vector<char> calculated;
+/// The first error that was found and the action that raised it
+  std::exception_ptr error;
+  std::string errorLabel;
+  std::function<bool(Action*)> calculateAction;
+/// Actions that do not have a value or that pass data from the MD code are run alone
+  static bool canRunConcurrently( Action* p ) {
+    return p->castToActionWithValue() && !p->castToActionForInterface() && !p->castToPbcAction();
+  }
+public:
+  ConcurrentActionGraph( const ActionSet& actionSet, std::function<bool(Action*)> calc );
+  void run( unsigned i );
+  void runAll( unsigned nt );
+  const std::vector<Action*>& getActions() const {
+    return actions;
+  }
+  bool wasCalculated( unsigned i ) const {
+    return calculated[i];
+  }
+};
+
+ConcurrentActionGraph::ConcurrentActionGraph( const ActionSet& actionSet, std::function<bool(Action*)> calc ):
+  calculateAction(calc) {
+  std::map<const Action*,unsigned> index;
+  for(const auto & pp : actionSet) {
+    if( pp->isActive() ) {
+      index[pp.get()]=actions.size();
+      actions.push_back( pp.get() );
+    }
+  }
+  unsigned n=actions.size();
+  dependents.resize(n);
+  calculated.assign(n,0);
+  npending.reset( new std::atomic<unsigned>[n] );
+  // Actions that cannot run concurrently act as barriers: they wait for all the actions that
+  // come before them in the input and all the actions that come after them wait for them
+  int lastbarrier=-1;
+  std::vector<unsigned> deps;
+  for(unsigned i=0; i<n; ++i) {
+    deps.resize(0);
+    if( canRunConcurrently( actions[i] ) ) {
+      for(const auto & d : actions[i]->getDependencies()) {
+        auto it=index.find(d);
+        if( it!=index.end() && it->second<i ) {
+          deps.push_back( it->second );
+        }
+      }
+      if( lastbarrier>=0 ) {
+        deps.push_back( lastbarrier );
+      }
+    } else {
+      for(unsigned j=lastbarrier<0 ? 0 : lastbarrier; j<i; ++j) {
+        deps.push_back(j);
+      }
+      lastbarrier=i;
+    }
+    std::sort( deps.begin(), deps.end() );
+    deps.erase( std::unique( deps.begin(), deps.end() ), deps.end() );
+    npending[i].store( deps.size() );
+    for(const auto & d : deps) {
+      dependents[d].push_back(i);
+    }
+  }
+}
+
+void ConcurrentActionGraph::run( unsigned i ) {
+  try {
+    calculated[i] = calculateAction( actions[i] );
+  } catch(...) {
+    #pragma omp critical(ConcurrentActionGraphError)
+    {
+      if( !error ) {
+        error=std::current_exception();
+        errorLabel=actions[i]->getLabel();
+      }
+    }
+    // Actions that depend on this one are not calculated
+    return;
+  }
+  for(unsigned j : dependents[i]) {
+    if( npending[j].fetch_sub(1)==1 ) {
+      #pragma omp task firstprivate(j)
+      run(j);
+    }
+  }
+}
+
+void ConcurrentActionGraph::runAll( unsigned nt ) {
+  #pragma omp parallel num_threads(nt)
+  {
+    #pragma omp single
+    {
+      for(unsigned i=0; i<actions.size(); ++i) {
+        if( npending[i].load()==0 ) {
+          #pragma omp task firstprivate(i)
+          run(i);
+        }
+      }
+    }
+  }
+  if( error ) {
+    try {
+      std::rethrow_exception( error );
+    } catch(...) {
+      plumed_error_nested() << "An error happened while calculating " << errorLabel;
+    }
+  }
+}
+
+}
+
+void PlumedMain::justCalculateConcurrently() {
+  ConcurrentActionGraph graph( actionSet, [this](Action* p) {
+    return calculateAction( p, false );
+  } );
+  graph.runAll( OpenMP::getNumThreads() );
+  // Biases are summed in input order so the result does not depend on the order the actions were run
+  const auto & actions( graph.getActions() );
+  for(unsigned i=0; i<actions.size(); ++i) {
+    ActionWithValue*av=actions[i]->castToActionWithValue();
+    if( av && graph.wasCalculated(i) ) {
+      bias+=av->getOutputQuantity("bias");
+      work+=av->getOutputQuantity("work");
+    }
+  }
+}
+
 void PlumedMain::justApply() {
   backwardPropagate();
   update();
@@ -1557,6 +1714,17 @@ void PlumedMain::fflush() {
   }
 }
 
+std::vector<std::string> PlumedMain::getOutputFiles()const {
+  std::vector<std::string> paths;
+  for(const auto & f : files) {
+    if(dynamic_cast<const OFile*>(f)) {
+      paths.push_back(f->getPath());
+    }
+  }
+  std::sort(paths.begin(),paths.end());
+  return paths;
+}
+
 void PlumedMain::insertFile(FileBase&f) {
   files.insert(&f);
 }
@@ -1647,6 +1815,7 @@ void PlumedMain::setUnits( const bool& natural, const Units& u ) {
 }
 
 void PlumedMain::startStep() {
+  scratch.reset();
   for(const auto & ip : inputs) {
     ip->resetForStepStart();
   }
@@ -53,6 +53,7 @@ namespace PLMD {
 
 
 
+class Action;
 class ActionAtomistic;
 class ActionPilot;
 class ActionForInterface;
@@ -62,6 +63,7 @@ class ActionSet;
 class DLLoader;
 class Communicator;
 class Stopwatch;
+class ScratchArena;
 class Citations;
 class ExchangePatterns;
 class FileBase;
@@ -159,6 +161,12 @@ private:
   ForwardDecl<Stopwatch> stopwatch_fwd;
   Stopwatch& stopwatch=*stopwatch_fwd;
 
+/// Forward declaration.
+/// Scratch buffers that are given back at the start of every step.
+/// Should be placed after log since it writes its statistics there.
+  ForwardDecl<ScratchArena> scratch_fwd;
+  ScratchArena& scratch=*scratch_fwd;
+
 /// Forward declaration.
   ForwardDecl<Citations> citations_fwd;
 /// tools/Citations.holder
@@ -262,6 +270,9 @@ public:
 /// Flag to switch on detailed timers
   bool detailedTimers=false;
 
+/// Flag to calculate actions that do not depend on each other at the same time
+  bool concurrentActions=false;
+
 /// GpuDevice Identifier
   int gpuDeviceId=-1;
 
@@ -399,6 +410,18 @@ public:
     Perform the forward loop on active actions.
   */
   void justCalculate();
+private:
+  /**
+    Calculate one action in the forward loop.
+    Returns false if the action is only calculated during update.
+  */
+  bool calculateAction( Action* p, bool firststep );
+  /**
+    Perform the forward loop running actions that do not depend on each other
+    concurrently on OpenMP tasks.
+  */
+  void justCalculateConcurrently();
+public:
   /**
     Backward propagate and update.
     Shortcut for backwardPropagate() + update()
@@ -428,6 +451,10 @@ public:
   const ActionSet & getActionSet()const;
 /// Referenge to the log stream
   Log & getLog();
+/// Reference to the arena that holds the scratch buffers for this step
+  ScratchArena & getScratchArena() {
+    return scratch;
+  }
 /// Return the number of the step
   long long int getStep()const {
     return step;
@@ -456,6 +483,8 @@ public:
   void eraseFile(FileBase&);
 /// Flush all files
   void fflush();
+/// Get the paths of the files that are open for writing
+  std::vector<std::string> getOutputFiles()const;
 /// Check if restarting
   bool getRestart()const;
 /// Set restart flag
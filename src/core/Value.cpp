@@ -26,6 +26,7 @@
 #include "tools/OpenMP.h"
 #include "tools/OFile.h"
 #include "tools/Communicator.h"
+#include "tools/CSRMatrix.h"
 #include "PlumedMain.h"
 
 namespace PLMD {
@@ -120,6 +121,16 @@ bool Value::applyForce(std::vector<double>& forces ) const {
     return false;
   }
   plumed_dbg_massert( data.size()-1==forces.size()," forces array has wrong size" );
+  if( sparseDerivatives ) {
+    // the caller owns forces and may have left anything in it, so the whole vector is cleared here.
+    // The O(N) cost is avoided in ActionWithValue::checkForSparseForces, which only clears the
+    // entries set in the previous step
+    std::fill( forces.begin(), forces.end(), 0 );
+    for(const auto & i : nonzeroDerivatives) {
+      forces[i]=inputForce[0]*data[1+i];
+    }
+    return true;
+  }
   const unsigned N=data.size()-1;
   for(unsigned i=0; i<N; ++i) {
     forces[i]=inputForce[0]*data[1+i];
@@ -127,6 +138,19 @@ bool Value::applyForce(std::vector<double>& forces ) const {
   return true;
 }
 
+void Value::setSparseDerivatives( const bool s ) {
+  plumed_massert( shape.size()==0 && hasDeriv, "sparse derivatives can only be used for scalars with derivatives" );
+  sparseDerivatives=s;
+  // Start from a clean list that is consistent with the derivatives that are stored
+  std::fill( data.begin()+1, data.end(), 0 );
+  nonzeroDerivatives.resize(0);
+  if( sparseDerivatives ) {
+    isNonzeroDerivative.assign( data.size()-1, 0 );
+  } else {
+    isNonzeroDerivative.clear();
+  }
+}
+
 void Value::setNotPeriodic() {
   min=0;
   max=0;
@@ -438,6 +462,39 @@ void Value::retrieveEdgeList( unsigned& nedge, std::vector<std::pair<unsigned,un
   }
 }
 
+void Value::getMatrixAsCSR( CSRMatrix& csr ) const {
+  plumed_dbg_assert( shape.size()==2 && !hasDeriv );
+  csr.clear( shape[0], shape[1] );
+  csr.columns.reserve( shape[0]*ncols );
+  csr.values.reserve( shape[0]*ncols );
+  for(unsigned i=0; i<shape[0]; ++i) {
+    unsigned ncol = getRowLength(i);
+    for(unsigned j=0; j<ncol; ++j) {
+      csr.columns.push_back( getRowIndex(i,j) );
+      csr.values.push_back( data[i*ncols+j] );
+    }
+    csr.rowStart[i+1] = csr.columns.size();
+  }
+}
+
+void Value::setMatrixFromCSR( const CSRMatrix& csr ) {
+  plumed_dbg_assert( shape.size()==2 && !hasDeriv );
+  plumed_assert( csr.nrows==shape[0] && csr.ncols==shape[1] );
+  // there must be at least one column or the rows have nowhere to store their lengths
+  reshapeMatrixStore( std::max<std::size_t>( csr.getMaxRowLength(), 1 ) );
+  for(unsigned i=0; i<shape[0]; ++i) {
+    unsigned ncol = csr.getRowLength(i);
+    matrix_bookeeping[(1+ncols)*i] = ncol;
+    for(unsigned j=0; j<ncol; ++j) {
+      matrix_bookeeping[(1+ncols)*i+1+j] = csr.columns[csr.rowStart[i]+j];
+      data[i*ncols+j] = csr.values[csr.rowStart[i]+j];
+    }
+    for(unsigned j=ncol; j<ncols; ++j) {
+      data[i*ncols+j] = 0;
+    }
+  }
+}
+
 void Value::readBinary(std::istream&i) {
   i.read(reinterpret_cast<char*>(&data[0]),data.size()*sizeof(double));
 }
@@ -35,6 +35,7 @@ namespace PLMD {
 
 class OFile;
 class Communicator;
+class CSRMatrix;
 class ActionWithValue;
 class ActionAtomistic;
 
@@ -106,6 +107,12 @@ private:
   double inv_max_minus_min=0.0;
 /// Is the derivative of this quantity zero when the value is zero
   bool derivativeIsZeroWhenValueIsZero=false;
+/// Are the nonzero derivatives of this scalar listed in nonzeroDerivatives
+  bool sparseDerivatives=false;
+/// The indices of the derivatives that are nonzero
+  std::vector<unsigned> nonzeroDerivatives;
+/// This is true for the derivatives that are in nonzeroDerivatives
+  std::vector<unsigned char> isNonzeroDerivative;
 /// Complete the setup of the periodicity
   void setupPeriodicity();
 // bring value within PBCs
@@ -161,6 +168,14 @@ public:
   void addDerivative(unsigned i,double d);
 /// Set the value of the ith component of the derivatives array
   void setDerivative(unsigned i, double d);
+/// Keep a list of the derivatives that are nonzero so that only these are cleared and used to apply forces
+  void setSparseDerivatives( const bool s );
+/// Is a list of the nonzero derivatives being kept
+  bool hasSparseDerivatives() const ;
+/// Add some derivative to the ith component of the derivatives array and put it in the list of nonzero derivatives
+  void addSparseDerivative(unsigned i,double d);
+/// Get the list of the nonzero derivatives (only when hasSparseDerivatives() is true)
+  const std::vector<unsigned>& getNonzeroDerivatives() const ;
 /// Get the derivative with respect to component n
   double getDerivative(const unsigned n) const;
 /// Clear the input force on the variable
@@ -245,6 +260,10 @@ public:
   bool isSymmetric() const ;
 /// Retrieve the non-zero edges in a matrix
   void retrieveEdgeList( unsigned& nedge, std::vector<std::pair<unsigned,unsigned> >& active, std::vector<double>& elems );
+/// Get all the elements that are stored for a matrix (including the ones that are zero) in CSR format
+  void getMatrixAsCSR( CSRMatrix& csr ) const ;
+/// Store only the elements of a matrix that are in the input CSR matrix and set them equal to the values there
+  void setMatrixFromCSR( const CSRMatrix& csr );
 /// Get the number of derivatives that the grid has
   unsigned getNumberOfGridDerivatives() const ;
 /// get the derivative of a grid at a point n with resepct to argument j
@@ -329,6 +348,9 @@ void Value::resizeDerivatives(int n) {
   }
   if(hasDeriv) {
     data.resize(1+n);
+    if( sparseDerivatives ) {
+      setSparseDerivatives( true );
+    }
   }
 }
 
@@ -344,6 +366,26 @@ void Value::setDerivative(unsigned i, double d) {
   data[1+i]=d;
 }
 
+inline
+bool Value::hasSparseDerivatives() const {
+  return sparseDerivatives;
+}
+
+inline
+void Value::addSparseDerivative(unsigned i,double d) {
+  plumed_dbg_massert(sparseDerivatives && i<getNumberOfDerivatives(),"derivative is out of bounds");
+  if( !isNonzeroDerivative[i] ) {
+    isNonzeroDerivative[i]=1;
+    nonzeroDerivatives.push_back(i);
+  }
+  data[1+i]+=d;
+}
+
+inline
+const std::vector<unsigned>& Value::getNonzeroDerivatives() const {
+  return nonzeroDerivatives;
+}
+
 inline
 void Value::clearInputForce() {
   if( !hasForce ) {
@@ -373,6 +415,12 @@ void Value::clearDerivatives( const bool force ) {
   value_set=false;
   if( shape.size()>0 ) {
     std::fill(data.begin(), data.end(), 0);
+  } else if( sparseDerivatives ) {
+    for(const auto & i : nonzeroDerivatives) {
+      data[1+i]=0;
+      isNonzeroDerivative[i]=0;
+    }
+    nonzeroDerivatives.resize(0);
   } else if( data.size()>1 ) {
     std::fill(data.begin()+1, data.end(), 0);
   }
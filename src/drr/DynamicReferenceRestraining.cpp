@@ -242,6 +242,9 @@ public:
   explicit DynamicReferenceRestraining(const ActionOptions &);
   void calculate();
   void update();
+  bool isHistoryDependent() const {
+    return true;
+  }
   void save(const string &filename, long long int step);
   void load(const string &filename);
   void backupFile(const string &filename);
@@ -158,6 +158,9 @@ public:
   explicit FISST(const ActionOptions&);
   void calculate();
   void update();
+  bool isHistoryDependent() const {
+    return true;
+  }
   void turnOnDerivatives();
   static void registerKeywords(Keywords& keys);
   ~FISST();
@@ -24,6 +24,7 @@
 #include "tools/Exception.h"
 #include "tools/Communicator.h"
 #include "tools/BiasRepresentation.h"
+#include "tools/BinaryHillsFile.h"
 #include "tools/KernelFunctions.h"
 #include "tools/File.h"
 #include "tools/Tools.h"
@@ -51,6 +52,9 @@ There are currently no examples for this keyword.
 class FilesHandler {
   std::vector <std::string> filenames;
   std::vector <std::unique_ptr<IFile>>  ifiles;
+/// The files in binary format (null for text files) and the number of hills read from the current one
+  std::vector <std::unique_ptr<BinaryHillsFile>> bfiles;
+  std::size_t nbinaryread=0;
   Action *action;
   Log *log;
   bool parallelread;
@@ -63,6 +67,9 @@ public:
                Log &mylog);
   bool readBunch(BiasRepresentation *br, int stride=-1);
   bool scanOneHill(BiasRepresentation *br, IFile *ifile );
+  bool scanOneHill(BiasRepresentation *br, BinaryHillsFile *bfile );
+/// Open file number i
+  void openFile(BiasRepresentation *br, unsigned i);
   void getMinMaxBin(const std::vector<Value*> & vals,
                     Communicator &cc,
                     std::vector<double> &vmin,
@@ -88,6 +95,11 @@ FilesHandler::FilesHandler(const std::vector<std::string> &fnames,
     ifile->link(act);
     plumed_massert((ifile->FileExist(filenames[i])), "the file "+filenames[i]+" does not exist " );
     ifiles.emplace_back(std::move(ifile));
+    if( BinaryHillsFile::isBinary(filenames[i]) ) {
+      bfiles.emplace_back(Tools::make_unique<BinaryHillsFile>());
+    } else {
+      bfiles.emplace_back();
+    }
   }
 
 }
@@ -103,17 +115,13 @@ bool FilesHandler::readBunch(BiasRepresentation *br, int stride) {
     (*log)<<"  doing serialread \n";
     // read one by one hills
     // is the type defined? if not, assume it is a gaussian
-    IFile *ff;
-    ff=ifiles[beingread].get();
     if(!isopen) {
-      (*log)<<"  opening file "<<filenames[beingread]<<"\n";
-      ff->open(filenames[beingread]);
-      isopen=true;
+      openFile(br,beingread);
     }
     int n=0;
     while(true) {
       bool fileisover=true;
-      while(scanOneHill(br,ff)) {
+      while( bfiles[beingread] ? scanOneHill(br,bfiles[beingread].get()) : scanOneHill(br,ifiles[beingread].get()) ) {
         // here do the dump if needed
         n=br->getNumberOfKernels();
         if(stride>0 && n%stride==0 && n!=0  ) {
@@ -124,15 +132,14 @@ bool FilesHandler::readBunch(BiasRepresentation *br, int stride) {
       }
       if(fileisover) {
         (*log)<<"  closing file "<<filenames[beingread]<<"\n";
-        ff->close();
+        if(!bfiles[beingread]) {
+          ifiles[beingread]->close();
+        }
         isopen=false;
         (*log)<<"  now total "<<br->getNumberOfKernels()<<" kernels \n";
         beingread++;
         if(beingread<ifiles.size()) {
-          ff=ifiles[beingread].get();
-          ff->open(filenames[beingread]);
-          (*log)<<"  opening file "<<filenames[beingread]<<"\n";
-          isopen=true;
+          openFile(br,beingread);
         } else {
           morefiles=false;
           (*log)<<"  final chunk: now with "<<n<<" kernels  \n";
@@ -177,6 +184,44 @@ void FilesHandler::getMinMaxBin(const std::vector<Value*> & vals,
   br.getMinMaxBin(vmin,vmax,vbin);
   //for(unsigned i=0;i<vals.size();i++){cerr<<"XXX "<<vmin[i]<<" "<<vmax[i]<<" "<<vbin[i]<<"\n";}
 }
+
+void FilesHandler::openFile(BiasRepresentation *br, unsigned i) {
+  (*log)<<"  opening file "<<filenames[i]<<"\n";
+  isopen=true;
+  if(!bfiles[i]) {
+    ifiles[i]->open(filenames[i]);
+    return;
+  }
+  // the variables in a binary file are only checked once as all the hills have the same variables
+  bfiles[i]->open(filenames[i]);
+  nbinaryread=0;
+  const std::vector<BinaryHillsFile::Variable>& vars=bfiles[i]->getVariables();
+  plumed_massert(vars.size()==br->getNumberOfDimensions(),"the number of variables in "+filenames[i]+" does not match the input");
+  for(unsigned j=0; j<vars.size(); ++j) {
+    plumed_massert(vars[j].name==br->getName(j),"variable "+vars[j].name+" in "+filenames[i]+" does not match the input");
+    std::string mini="", maxi="";
+    if(br->getPtrToValue(j)->isPeriodic()) {
+      br->getPtrToValue(j)->getDomain(mini,maxi);
+    }
+    plumed_massert(mini==vars[j].min && maxi==vars[j].max,"the input periodicity in hills and in value definition does not match");
+  }
+}
+
+bool FilesHandler::scanOneHill(BiasRepresentation *br, BinaryHillsFile *bfile ) {
+  if(nbinaryread>=bfile->getNumberOfHills()) {
+    return false;
+  }
+  View<const double> center=bfile->getCenter(nbinaryread);
+  View<const double> sigma=bfile->getSigma(nbinaryread);
+  br->pushKernel(std::vector<double>(center.begin(),center.end()),
+                 std::vector<double>(sigma.begin(),sigma.end()),
+                 bfile->isMultivariate(nbinaryread),
+                 bfile->getHeight(nbinaryread),
+                 bfile->getBiasFactor(nbinaryread));
+  nbinaryread++;
+  return true;
+}
+
 bool FilesHandler::scanOneHill(BiasRepresentation *br, IFile *ifile ) {
   double dummy;
   if(ifile->scanField("time",dummy)) {
@@ -152,6 +152,9 @@ public:
   void calculate() override {}
   void apply() override {}
   void update() override ;
+  bool isHistoryDependent() const override {
+    return true;
+  }
 };
 
 PLUMED_REGISTER_ACTION(Accumulate,"ACCUMULATE")
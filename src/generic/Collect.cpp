@@ -153,6 +153,9 @@ public:
   void calculate() override {}
   void apply() override {}
   void update() override ;
+  bool isHistoryDependent() const override {
+    return true;
+  }
 };
 
 PLUMED_REGISTER_ACTION(Collect,"COLLECT")
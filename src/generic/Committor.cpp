@@ -70,6 +70,10 @@ public:
   explicit Committor(const ActionOptions&ao);
   void calculate() override;
   void apply() override {}
+/// The basin that was visited last is remembered and the simulation is stopped when a basin is reached
+  bool isHistoryDependent() const override {
+    return true;
+  }
 };
 
 PLUMED_REGISTER_ACTION(Committor,"COMMITTOR")
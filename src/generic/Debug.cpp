@@ -23,6 +23,7 @@
 #include "core/ActionPilot.h"
 #include "core/ActionSet.h"
 #include "core/PlumedMain.h"
+#include "tools/Communicator.h"
 
 namespace PLMD {
 namespace generic {
@@ -41,6 +42,25 @@ a: DEBUG DETAILED_TIMERS
 b: DEBUG logRequestedAtoms STRIDE=2
 ```
 
+When PLUMED is run with several OpenMP threads on a single MPI process, the CONCURRENT_ACTIONS flag
+can be used to calculate the actions that do not depend on each other at the same time.  This is useful
+when the input contains many collective variables that are each too cheap to use all the threads.
+The actions are calculated in the order given by the dependencies between them rather than in the order
+they appear in the input.  Any OpenMP parallelism inside the actions themselves is not used in this mode.
+
+The actions still call the MPI collectives of their (single process) communicator, so when PLUMED
+has been compiled with MPI the flag is only honored if MPI has been initialized with MPI_THREAD_MULTIPLE.
+If MPI has been initialized with a lower thread level a warning is printed and the actions are calculated
+one at a time.  The `plumed` executable initializes MPI without thread support, so with an MPI build
+you should use `plumed --no-mpi driver` to take advantage of this flag.
+
+```plumed
+c: DEBUG CONCURRENT_ACTIONS
+d1: DISTANCE ATOMS=1,2
+d2: DISTANCE ATOMS=3,4
+t: TORSION ATOMS=1,2,3,4
+```
+
 */
 //+ENDPLUMEDOC
 class Debug:
@@ -50,6 +70,7 @@ class Debug:
   bool logRequestedAtoms;
   bool novirial;
   bool detailedTimers;
+  bool concurrentActions;
 public:
   explicit Debug(const ActionOptions&ao);
 /// Register all the relevant keywords for the action
@@ -70,6 +91,7 @@ void Debug::registerKeywords( Keywords& keys ) {
                " in PLUMED<2.6 and this flag can be activated only as 'logRequestedAtoms'");
   keys.addFlag("NOVIRIAL",false,"switch off the virial contribution for the entirety of the simulation");
   keys.addFlag("DETAILED_TIMERS",false,"switch on detailed timers");
+  keys.addFlag("CONCURRENT_ACTIONS",false,"calculate actions that do not depend on each other at the same time using the available OpenMP threads");
   keys.add("optional","FILE","the name of the file on which to output these quantities");
 }
 
@@ -99,6 +121,18 @@ Debug::Debug(const ActionOptions&ao):
     log.printf("  Detailed timing on\n");
     plumed.detailedTimers=true;
   }
+  parseFlag("CONCURRENT_ACTIONS",concurrentActions);
+  if(concurrentActions) {
+    if( comm.Get_size()>1 || multi_sim_comm.Get_size()>1 ) {
+      warning("CONCURRENT_ACTIONS can only be used when running PLUMED on a single MPI process with no replicas, actions will be calculated one at a time");
+    } else if( !Communicator::threadMultiple() ) {
+      // the actions call MPI from different threads, even if the communicator only has one process
+      warning("CONCURRENT_ACTIONS requires MPI to be initialized with MPI_THREAD_MULTIPLE (or plumed --no-mpi), actions will be calculated one at a time");
+    } else {
+      log.printf("  Calculating independent actions concurrently\n");
+      plumed.concurrentActions=true;
+    }
+  }
   ofile.link(*this);
   std::string file;
   parse("FILE",file);
@@ -168,6 +168,7 @@ class DumpVector :
   public ActionPilot {
 private:
   bool onefile;
+  bool binary;
   std::vector<std::string> argnames;
   std::string fmt, filename;
   void buildArgnames();
@@ -189,7 +190,7 @@ void DumpVector::registerKeywords( Keywords& keys ) {
   keys.addInputKeyword("compulsory","ARG","vector/matrix","the labels of vectors/matrices that should be output in the file");
   keys.add("compulsory","STRIDE","0","the frequency with which the grid should be output to the file.");
   keys.add("compulsory","FILE","density","the file on which to write the vetors");
-  keys.add("optional","FMT","the format that should be used to output real numbers");
+  keys.add("optional","FMT","the format that should be used to output real numbers. Use BINARY to write a binary file, which is also done when the name of the file ends with .bin or .bin.gz");
   keys.addFlag("PRINT_ONE_FILE",false,"output vectors one after the other in a single file");
 }
 
@@ -211,6 +212,10 @@ DumpVector::DumpVector(const ActionOptions&ao):
   log.printf("  outputting data with label %s to file named %s",getPntrToArgument(0)->getName().c_str(), filename.c_str() );
   parse("FMT",fmt);
   log.printf(" with format %s \n", fmt.c_str() );
+  binary = fmt=="BINARY" || OFile::hasBinaryExtension(filename);
+  if( binary ) {
+    log.printf("  in binary format\n");
+  }
   fmt = " " + fmt;
   if( onefile ) {
     log.printf("  printing all grids on a single file \n");
@@ -245,6 +250,9 @@ void DumpVector::update() {
   } else {
     ofile.setBackupString("analysis");
   }
+  if( binary ) {
+    ofile.setBinaryFormat();
+  }
   ofile.open( filename );
 
   unsigned totargs = 0;
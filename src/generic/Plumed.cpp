@@ -174,6 +174,10 @@ public:
   bool actionHasForces() override {
     return true;
   }
+/// The actions in the underlying plumed object cannot be inspected, so they are assumed to depend on the previous frames
+  bool isHistoryDependent() const override {
+    return true;
+  }
 };
 
 PLUMED_REGISTER_ACTION(Plumed,"PLUMED")
@@ -109,6 +109,22 @@ Keep into account that even on steps when the action is not updated (and thus th
 the argument will be activated. In other words, if you use `UPDATE_FROM` to start printing at a given time,
 the collective variables this PRINT statement depends on will be computed also before that time.
 
+## Binary output
+
+If you print many quantities, or if you print them very often, formatting the numbers takes time and the
+output files become very large. With the input below the numbers are written in a binary file,
+without any formatting and without losing any precision:
+
+```plumed
+d: DISTANCE ATOMS1=1,2 ATOMS2=3,4 ATOMS3=5,6
+PRINT ARG=d FILE=colvar.bin
+```
+
+Files whose names end with `.bin` or `.bin.gz` are written in binary format, and the same can be obtained with `FMT=BINARY`.
+Binary files can be read with [READ](READ.md) or by any other action that reads colvar files, and
+the values are read without any parsing. Notice that binary files use the byte order of the machine on which
+they are written.
+
 ## PRINT and RESTART
 
 If you run a calculation with the following input:
@@ -201,7 +217,7 @@ void Print::registerKeywords(Keywords& keys) {
   keys.addInputKeyword("compulsory","ARG","scalar/vector/matrix","the labels of the values that you would like to print to the file");
   keys.add("compulsory","STRIDE","1","the frequency with which the quantities of interest should be output");
   keys.add("optional","FILE","the name of the file on which to output these quantities");
-  keys.add("compulsory","FMT","%f","the format that should be used to output real numbers");
+  keys.add("compulsory","FMT","%f","the format that should be used to output real numbers. Use BINARY to write a binary file, which is also done when the name of the file ends with .bin or .bin.gz");
   keys.add("hidden","_ROTATE","some funky thing implemented by GBussi");
   keys.use("RESTART");
   keys.use("UPDATE_FROM");
@@ -223,8 +239,16 @@ Print::Print(const ActionOptions&ao):
     ofile.link(log);
   }
   parse("FMT",fmt);
-  fmt=" "+fmt;
-  log.printf("  with format %s\n",fmt.c_str());
+  if(fmt=="BINARY" || OFile::hasBinaryExtension(file)) {
+    if(file.length()==0) {
+      error("binary output cannot be written on the log");
+    }
+    ofile.setBinaryFormat();
+    log.printf("  in binary format\n");
+  } else {
+    fmt=" "+fmt;
+    log.printf("  with format %s\n",fmt.c_str());
+  }
   for(unsigned i=0; i<getNumberOfArguments(); ++i) {
     ofile.setupPrintValue( getPntrToArgument(i) );
   }
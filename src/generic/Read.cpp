@@ -137,6 +137,10 @@ public:
   IFile* getFile();
   unsigned getNumberOfDerivatives() override;
   void turnOnDerivatives() override;
+/// The lines of the file are read one after the other, so the value on a frame depends on how many frames were read before
+  bool isHistoryDependent() const override {
+    return true;
+  }
 };
 
 PLUMED_REGISTER_ACTION(Read,"READ")
@@ -277,6 +277,9 @@ public:
   ~Metainference();
   void calculate() override;
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   static void registerKeywords(Keywords& keys);
 };
 
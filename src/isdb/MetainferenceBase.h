@@ -203,6 +203,9 @@ public:
   void unlockRequests() override;
   void calculateNumericalDerivatives( ActionWithValue* a ) override;
   void apply() override;
+  bool isHistoryDependent() const override {
+    return doscore_;
+  }
   void setArgDerivatives(Value *v, const double &d);
   void setAtomsDerivatives(Value*v, const unsigned i, const Vector&d);
   void setBoxDerivatives(Value*v, const Tensor&d);
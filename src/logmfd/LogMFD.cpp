@@ -430,6 +430,9 @@ public:
   explicit LogMFD(const ActionOptions&);
   void calculate();
   void update();
+  bool isHistoryDependent() const {
+    return true;
+  }
   void updateNVE();
   void updateNVT();
   void updateVS();
@@ -145,6 +145,9 @@ public:
   void calculate() {}
   void apply() {}
   void update();
+  bool isHistoryDependent() const {
+    return true;
+  }
 };
 
 PLUMED_REGISTER_ACTION(PathDisplacements,"AVERAGE_PATH_DISPLACEMENT")
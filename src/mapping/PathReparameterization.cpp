@@ -100,6 +100,9 @@ public:
   void calculate() {}
   void apply() {}
   void update();
+  bool isHistoryDependent() const {
+    return true;
+  }
 };
 
 PLUMED_REGISTER_ACTION(PathReparameterization,"REPARAMETERIZE_PATH")
@@ -24,6 +24,7 @@
 
 #include "core/ActionWithMatrix.h"
 #include "core/ParallelTaskManager.h"
+#include "tools/CSRMatrix.h"
 
 namespace PLMD {
 namespace matrixtools {
@@ -72,6 +73,8 @@ public:
   constexpr static bool isDissimilarities=helpers::isDissimilarities<CV>;
 private:
   PTM taskmanager;
+/// The elements of the input matrices and of their product that are stored when the matrices are sparse
+  CSRMatrix arg0pattern, arg1pattern, product;
 public:
   static void registerKeywords( Keywords& keys );
   explicit MatrixTimesMatrix(const ActionOptions&);
@@ -187,7 +190,16 @@ void MatrixTimesMatrix<CV, myPTM>::calculate() {
       }
     }
   }
-  updateBookeepingArrays( taskmanager.getActionInput().outmat );
+  // If the second matrix is sparse the product is sparse so only the elements that can be non zero are computed
+  if( getNumberOfMasks()<=0 && !diagzero && getPntrToComponent(0)->isDerivativeZeroWhenValueIsZero() &&
+      getPntrToArgument(1)->getNumberOfColumns()<getPntrToArgument(1)->getShape()[1] ) {
+    getPntrToArgument(0)->getMatrixAsCSR( arg0pattern );
+    getPntrToArgument(1)->getMatrixAsCSR( arg1pattern );
+    arg0pattern.multiplyPattern( arg1pattern, product );
+    updateBookeepingArrays( product, taskmanager.getActionInput().outmat );
+  } else {
+    updateBookeepingArrays( taskmanager.getActionInput().outmat );
+  }
   //unsigned nvals = getPntrToComponent(0)->getNumberOfColumns();
   taskmanager.setupParallelTaskManager( 2*getPntrToArgument(0)->getNumberOfColumns(),
                                         getPntrToArgument(1)->getNumberOfStoredValues() );
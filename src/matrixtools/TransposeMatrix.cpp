@@ -21,6 +21,7 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "MatrixOperationBase.h"
 #include "core/ActionRegister.h"
+#include "tools/CSRMatrix.h"
 
 //+PLUMEDOC MCOLVAR TRANSPOSE
 /*
@@ -69,6 +70,15 @@ namespace PLMD {
 namespace matrixtools {
 
 class TransposeMatrix : public MatrixOperationBase {
+private:
+/// Is the input a sparse matrix that is transposed without making it dense
+  bool sparse;
+/// The input matrix and its transpose in CSR format
+  CSRMatrix argmat, transposed;
+/// The index in the store of the input of each element in the transpose
+  std::vector<std::size_t> argindex;
+/// Calculate the transpose of a sparse matrix
+  void transposeSparse( Value* myarg, Value* myval );
 public:
   static void registerKeywords( Keywords& keys );
 /// Constructor
@@ -98,7 +108,8 @@ void TransposeMatrix::registerKeywords( Keywords& keys ) {
 
 TransposeMatrix::TransposeMatrix(const ActionOptions& ao):
   Action(ao),
-  MatrixOperationBase(ao) {
+  MatrixOperationBase(ao),
+  sparse(false) {
   if( getPntrToArgument(0)->isSymmetric() ) {
     error("input matrix is symmetric.  Transposing will achieve nothing!");
   }
@@ -127,6 +138,9 @@ TransposeMatrix::TransposeMatrix(const ActionOptions& ao):
   }
   if( shape.size()==2 ) {
     getPntrToComponent(0)->reshapeMatrixStore( shape[1] );
+    if( getPntrToArgument(0)->getRank()==2 && getPntrToArgument(0)->isDerivativeZeroWhenValueIsZero() ) {
+      getPntrToComponent(0)->setDerivativeIsZeroWhenValueIsZero();
+    }
   }
 }
 
@@ -184,6 +198,15 @@ void TransposeMatrix::calculate() {
       myval->setShape( shape );
       myval->reshapeMatrixStore( shape[1] );
     }
+    // Sparse matrices with derivatives that are zero when the values are zero stay sparse
+    sparse = myarg->getNumberOfColumns()<myarg->getShape()[1] && myval->isDerivativeZeroWhenValueIsZero();
+    if( sparse ) {
+      transposeSparse( myarg, myval );
+      return;
+    }
+    if( myval->getNumberOfColumns()<myval->getShape()[1] ) {
+      myval->reshapeMatrixStore( myval->getShape()[1] );
+    }
     std::vector<double> vals;
     std::vector<std::pair<unsigned,unsigned> > pairs;
     std::vector<std::size_t> shape( myval->getShape() );
@@ -195,6 +218,25 @@ void TransposeMatrix::calculate() {
   }
 }
 
+void TransposeMatrix::transposeSparse( Value* myarg, Value* myval ) {
+  myarg->getMatrixAsCSR( argmat );
+  std::vector<std::size_t> origin;
+  argmat.transpose( transposed, &origin );
+  myval->setMatrixFromCSR( transposed );
+  // Keep track of where each element is in the store of the input so the forces can be passed back
+  unsigned ncols = myarg->getNumberOfColumns();
+  argindex.resize( origin.size() );
+  for(unsigned i=0; i<argmat.nrows; ++i) {
+    for(std::size_t k=argmat.rowStart[i]; k<argmat.rowStart[i+1]; ++k) {
+      argindex[k] = i*ncols + k - argmat.rowStart[i];
+    }
+  }
+  for(unsigned k=0; k<origin.size(); ++k) {
+    origin[k] = argindex[origin[k]];
+  }
+  argindex.swap( origin );
+}
+
 void TransposeMatrix::apply() {
   if( doNotCalculateDerivatives() ) {
     return;
@@ -209,6 +251,13 @@ void TransposeMatrix::apply() {
       for(unsigned i=0; i<nv; ++i) {
         myarg->addForce( i, myval->getForce(i) );
       }
+    } else if( sparse ) {
+      unsigned ncols = myval->getNumberOfColumns();
+      for(unsigned i=0; i<transposed.nrows; ++i) {
+        for(std::size_t k=transposed.rowStart[i]; k<transposed.rowStart[i+1]; ++k) {
+          myarg->addForce( argindex[k], myval->getForce( i*ncols + k - transposed.rowStart[i] ), false );
+        }
+      }
     } else {
       MatrixOperationBase::apply();
     }
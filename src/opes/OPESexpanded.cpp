@@ -127,7 +127,7 @@ private:
   std::vector<const double *> ECVs_;
   std::vector<const double *> derECVs_;
   std::vector<opes::ExpansionCVs*> pntrToECVsClass_;
-  std::vector< std::vector<unsigned> > index_k_;
+  std::vector<unsigned> index_k_; //index_k_[j*deltaF_.size()+i], so that the ECVs of each CV are contiguous
 // A note on indexes usage:
 //  j -> underlying CVs
 //  i -> DeltaFs
@@ -169,11 +169,15 @@ private:
   void dumpStateToFile();
   void updateDeltaF(double);
   double getExpansion(const unsigned) const;
+  double getLogSumExp(std::vector<double>&,const bool);
 
 public:
   explicit OPESexpanded(const ActionOptions&);
   void calculate() override;
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   static void registerKeywords(Keywords& keys);
 };
 
@@ -523,64 +527,15 @@ void OPESexpanded::calculate() {
     return;
   }
 
-//get diffMax, to avoid over/underflow
-  double diffMax=-std::numeric_limits<double>::max();
-  #pragma omp parallel num_threads(NumOMP_)
-  {
-    #pragma omp for reduction(max:diffMax)
-    for(unsigned i=0; i<deltaF_.size(); i++) {
-      diff_[i]=(-getExpansion(i)+deltaF_[i]/kbt_);
-      if(diff_[i]>diffMax) {
-        diffMax=diff_[i];
-      }
-    }
-  }
-  if(NumParallel_>1) {
-    comm.Max(diffMax);
-  }
-
 //calculate the bias and the forces
-  double sum=0;
-  std::vector<double> der_sum_cv(ncv_,0);
-  if(NumOMP_==1) {
-    for(unsigned i=0; i<deltaF_.size(); i++) {
-      double add_i=std::exp(diff_[i]-diffMax);
-      sum+=add_i;
-      //set derivatives
-      for(unsigned j=0; j<ncv_; j++) {
-        der_sum_cv[j]-=derECVs_[j][index_k_[i][j]]*add_i;
-      }
-    }
-  } else {
-    #pragma omp parallel num_threads(NumOMP_)
-    {
-      std::vector<double> omp_der_sum_cv(ncv_,0);
-      #pragma omp for reduction(+:sum) nowait
-      for(unsigned i=0; i<deltaF_.size(); i++) {
-        double add_i=std::exp(diff_[i]-diffMax);
-        sum+=add_i;
-        //set derivatives
-        for(unsigned j=0; j<ncv_; j++) {
-          omp_der_sum_cv[j]-=derECVs_[j][index_k_[i][j]]*add_i;
-        }
-      }
-      #pragma omp critical
-      for(unsigned j=0; j<ncv_; j++) {
-        der_sum_cv[j]+=omp_der_sum_cv[j];
-      }
-    }
-  }
-  if(NumParallel_>1) {
-    //each MPI process has part of the full deltaF_ vector, so must Sum
-    comm.Sum(sum);
-    comm.Sum(der_sum_cv);
-  }
+  std::vector<double> der_cv(ncv_);
+  const double logsum=getLogSumExp(der_cv,true);
 
 //set bias and forces
-  const double bias=-kbt_*(diffMax+std::log(sum/deltaF_size_));
+  const double bias=-kbt_*(logsum-std::log(deltaF_size_));
   setBias(bias);
   for(unsigned j=0; j<ncv_; j++) {
-    setOutputForce(j,kbt_*der_sum_cv[j]/sum);
+    setOutputForce(j,kbt_*der_cv[j]);
   }
 }
 
@@ -642,35 +597,8 @@ void OPESexpanded::update() {
 
     //calculate work if requested
     if(calc_work_) {
-      //some copy and paste from calculate()
-      //get diffMax, to avoid over/underflow
-      double diffMax=-std::numeric_limits<double>::max();
-      #pragma omp parallel num_threads(NumOMP_)
-      {
-        #pragma omp for reduction(max:diffMax)
-        for(unsigned i=0; i<deltaF_.size(); i++) {
-          diff_[i]=(-getExpansion(i)+deltaF_[i]/kbt_);
-          if(diff_[i]>diffMax) {
-            diffMax=diff_[i];
-          }
-        }
-      }
-      if(NumParallel_>1) {
-        comm.Max(diffMax);
-      }
-      //calculate the bias
-      double sum=0;
-      #pragma omp parallel num_threads(NumOMP_)
-      {
-        #pragma omp for reduction(+:sum) nowait
-        for(unsigned i=0; i<deltaF_.size(); i++) {
-          sum+=std::exp(diff_[i]-diffMax);
-        }
-      }
-      if(NumParallel_>1) {
-        comm.Sum(sum);
-      }
-      const double new_bias=-kbt_*(diffMax+std::log(sum/deltaF_size_));
+      std::vector<double> dummy(ncv_); //derivatives are not needed
+      const double new_bias=-kbt_*(getLogSumExp(dummy,false)-std::log(deltaF_size_));
       //accumulate work
       work_+=new_bias-current_bias;
       getPntrToComponent("work")->set(work_);
@@ -741,7 +669,7 @@ void OPESexpanded::init_linkECVs() {
   diff_.resize(deltaF_.size());
   ECVs_.resize(ncv_);
   derECVs_.resize(ncv_);
-  index_k_.resize(deltaF_.size(),std::vector<unsigned>(ncv_));
+  index_k_.resize(ncv_*deltaF_.size());
   unsigned index_j=0;
   unsigned sizeSkip=deltaF_size_;
   for(unsigned l=0; l<pntrToECVsClass_.size(); l++) {
@@ -754,13 +682,13 @@ void OPESexpanded::init_linkECVs() {
       derECVs_[index_j+h]=pntrToECVsClass_[l]->getPntrToDerECVs(h);
       if(NumParallel_==1) {
         for(unsigned i=0; i<deltaF_size_; i++) {
-          index_k_[i][index_j+h]=l_index_k[(i/sizeSkip)%l_index_k.size()][h];
+          index_k_[(index_j+h)*deltaF_.size()+i]=l_index_k[(i/sizeSkip)%l_index_k.size()][h];
         }
       } else {
         const unsigned start=(deltaF_size_/NumParallel_)*rank_+std::min(rank_,deltaF_size_%NumParallel_);
         unsigned iter=0;
         for(unsigned i=start; i<start+deltaF_.size(); i++) {
-          index_k_[iter++][index_j+h]=l_index_k[(i/sizeSkip)%l_index_k.size()][h];
+          index_k_[(index_j+h)*deltaF_.size()+iter++]=l_index_k[(i/sizeSkip)%l_index_k.size()][h];
         }
       }
     }
@@ -796,10 +724,9 @@ void OPESexpanded::init_fromObs() { //This could probably be faster and/or requi
 //initialize deltaF_ from obs
 //for the first point, t=0, the ECVs are calculated by initECVs_observ, setting also any initial guess
   index_j=0;
-  for(unsigned i=0; i<deltaF_.size(); i++)
-    for(unsigned j=0; j<ncv_; j++) {
-      deltaF_[i]+=kbt_*ECVs_[j][index_k_[i][j]];
-    }
+  for(unsigned i=0; i<deltaF_.size(); i++) {
+    deltaF_[i]+=kbt_*getExpansion(i);
+  }
   for(unsigned t=1; t<obs_steps_; t++) { //starts from t=1
     unsigned index_j=0;
     for(unsigned l=0; l<pntrToECVsClass_.size(); l++) {
@@ -917,10 +844,105 @@ void OPESexpanded::updateDeltaF(double bias) {
 double OPESexpanded::getExpansion(unsigned i) const {
   double expansion=0;
   for(unsigned j=0; j<ncv_; j++) {
-    expansion+=ECVs_[j][index_k_[i][j]];  //the index_k could be trivially guessed for most ECVs, but unfourtunately not all
+    expansion+=ECVs_[j][index_k_[j*deltaF_.size()+i]];  //the index_k could be trivially guessed for most ECVs, but unfourtunately not all
   }
   return expansion;
 }
 
+double OPESexpanded::getLogSumExp(std::vector<double>& der_cv,const bool calc_der) {
+//returns log(sum_i exp(diff_i)), with diff_i=-expansion_i+deltaF_i/kbt_, and the derivatives of the sum divided by the sum
+//each thread goes through blocks of deltaFs that fit in cache, and rescales its partial sums when a larger diff_i is found,
+//so the exponentials never overflow and each block is read only once
+  constexpr unsigned block_size=256;
+  const unsigned size=deltaF_.size();
+  double max_diff=-std::numeric_limits<double>::max();
+  double sum=0;
+  std::fill(der_cv.begin(),der_cv.end(),0.);
+  #pragma omp parallel num_threads(NumOMP_)
+  {
+    double omp_max_diff=-std::numeric_limits<double>::max();
+    double omp_sum=0;
+    std::vector<double> omp_der_cv(ncv_,0);
+    #pragma omp for nowait
+    for(unsigned b=0; b<size; b+=block_size) {
+      const unsigned n=std::min(block_size,size-b);
+      double* diff=diff_.data()+b;
+      const double* deltaF=deltaF_.data()+b;
+      #pragma omp simd
+      for(unsigned i=0; i<n; i++) {
+        diff[i]=deltaF[i]/kbt_;
+      }
+      for(unsigned j=0; j<ncv_; j++) {
+        const double* ECVs=ECVs_[j];
+        const unsigned* index_k=index_k_.data()+j*size+b;
+        #pragma omp simd
+        for(unsigned i=0; i<n; i++) {
+          diff[i]-=ECVs[index_k[i]];
+        }
+      }
+      double block_max_diff=omp_max_diff;
+      #pragma omp simd reduction(max:block_max_diff)
+      for(unsigned i=0; i<n; i++) {
+        block_max_diff=std::max(block_max_diff,diff[i]);
+      }
+      if(block_max_diff>omp_max_diff) {
+        const double rescale=std::exp(omp_max_diff-block_max_diff);
+        omp_sum*=rescale;
+        for(unsigned j=0; j<ncv_; j++) {
+          omp_der_cv[j]*=rescale;
+        }
+        omp_max_diff=block_max_diff;
+      }
+      double block_sum=0;
+      #pragma omp simd reduction(+:block_sum)
+      for(unsigned i=0; i<n; i++) {
+        diff[i]=std::exp(diff[i]-omp_max_diff); //diff_ now holds the terms of the sum
+        block_sum+=diff[i];
+      }
+      omp_sum+=block_sum;
+      if(calc_der) {
+        for(unsigned j=0; j<ncv_; j++) {
+          const double* derECVs=derECVs_[j];
+          const unsigned* index_k=index_k_.data()+j*size+b;
+          double block_der=0;
+          #pragma omp simd reduction(+:block_der)
+          for(unsigned i=0; i<n; i++) {
+            block_der-=derECVs[index_k[i]]*diff[i];
+          }
+          omp_der_cv[j]+=block_der;
+        }
+      }
+    }
+    #pragma omp critical
+    {
+      const double new_max_diff=std::max(max_diff,omp_max_diff);
+      const double rescale=std::exp(max_diff-new_max_diff);
+      const double omp_rescale=std::exp(omp_max_diff-new_max_diff);
+      sum=sum*rescale+omp_sum*omp_rescale;
+      for(unsigned j=0; j<ncv_; j++) {
+        der_cv[j]=der_cv[j]*rescale+omp_der_cv[j]*omp_rescale;
+      }
+      max_diff=new_max_diff;
+    }
+  }
+  if(NumParallel_>1) {
+    //each MPI process has part of the full deltaF_ vector, so must Sum
+    double all_max_diff=max_diff;
+    comm.Max(all_max_diff);
+    const double rescale=std::exp(max_diff-all_max_diff);
+    sum*=rescale;
+    for(unsigned j=0; j<ncv_; j++) {
+      der_cv[j]*=rescale;
+    }
+    comm.Sum(sum);
+    comm.Sum(der_cv);
+    max_diff=all_max_diff;
+  }
+  for(unsigned j=0; j<ncv_; j++) {
+    der_cv[j]/=sum;
+  }
+  return max_diff+std::log(sum);
+}
+
 }
 }
@@ -19,10 +19,16 @@
 #include "bias/Bias.h"
 #include "core/PlumedMain.h"
 #include "core/ActionRegister.h"
+#include "tools/BinaryTable.h"
 #include "tools/Communicator.h"
 #include "tools/File.h"
+#include "tools/Grid.h"
+#include "tools/KernelTree.h"
 #include "tools/OpenMP.h"
 
+#include <iostream>
+#include <thread>
+
 namespace PLMD {
 namespace opes {
 
@@ -84,6 +90,11 @@ Restart can be done from a KERNELS file, but it might be not perfect (due to lim
 For an exact restart you must use STATE_RFILE to read a checkpoint with all the needed info.
 To save such checkpoints, define a STATE_WFILE and choose how often to print them with STATE_WSTRIDE.
 By default this file is overwritten, but you can instead append to it using the flag STORE_STATES.
+With many kernels, writing the checkpoint can take a noticeable time.
+With the flag STATE_BINARY the checkpoint is written in a binary format, which is compressed if the name of the file ends with `.gz`.
+The binary file is written by a separate thread while the simulation goes on, first to a temporary file that then replaces the old checkpoint,
+so that a valid checkpoint is always available.
+Binary checkpoints are recognized automatically when they are given as STATE_RFILE.
 
 Multiple walkers are supported only with MPI communication, via the keyword WALKERS_MPI.
 
@@ -123,6 +134,39 @@ opes: OPES_METAD ...
 PRINT FMT=%g STRIDE=500 FILE=Colvar.data ARG=phi,psi,opes.*
 ```
 
+When many kernels are deposited, e.g. in long simulations with more than two CVs where the compression is less effective, the kernels can be stored in a kd-tree by using the TREE_FOLD keyword.
+The tree is then used to find the kernels that can be merged with a new one, to build the neighbor list, and, if NLIST is not used, to evaluate only the kernels that are within KERNEL_CUTOFF from the current position.
+Kernels that are added or changed by a merge are kept in a separate list until TREE_FOLD of them are accumulated, at which point the tree is built again.
+The result is the same as without the tree.
+
+```plumed
+phi: TORSION ATOMS=5,7,9,15
+psi: TORSION ATOMS=7,9,15,17
+chi: TORSION ATOMS=9,15,17,19
+opes: OPES_METAD ARG=phi,psi,chi PACE=500 BARRIER=50 TREE_FOLD=100
+```
+
+When the cost of the force field is small, the sum of the kernels can become the most expensive part of the calculation.
+In this case the sum of the kernels can be stored on a grid by using GRID_MIN, GRID_MAX and GRID_BIN.
+The grid is updated every PACE only in the region covered by the kernels that have been added, merged or removed,
+and the probability estimate and its derivatives are obtained with a spline interpolation, so the cost of each step does not depend on the number of kernels.
+Since the kernels shrink as the simulation proceeds, the grid spacing should be a fraction of the smallest SIGMA expected, which can be enforced with SIGMA_MIN.
+Outside the grid the kernels are summed directly.
+
+```plumed
+phi: TORSION ATOMS=5,7,9,15
+psi: TORSION ATOMS=7,9,15,17
+opes: OPES_METAD ...
+  ARG=phi,psi
+  PACE=500
+  BARRIER=50
+  SIGMA_MIN=0.05,0.05
+  GRID_MIN=-pi,-pi
+  GRID_MAX=pi,pi
+  GRID_BIN=500,500
+...
+```
+
 Next is an example of how to define a custom target distribution different from the well-tempered one.
 Here we chose to focus more on the transition state, that is around $\phi=0$.
 Our target distribution is a Gaussian centered there, thus the target free energy we want to sample is a parabola, $F^{\text{tg}}(\mathbf{s})=-\frac{1}{\beta} \log [p^{\text{tg}}(\mathbf{s})]$.
@@ -216,6 +260,16 @@ private:
   double evaluateKernel(const kernel&,const std::vector<double>&,std::vector<double>&,std::vector<double>&);
   std::vector<kernel> kernels_; //all compressed kernels
   OFile kernelsOfile_;
+//kd-tree of the kernels, used to find the kernels close to a point
+  std::unique_ptr<KernelTree> tree_;
+  std::vector<std::size_t> tree_found_;
+  void findKernelsInTree(const std::vector<double>&,const double);
+//grid with the sum of the kernels and its derivatives
+  std::unique_ptr<Grid> grid_;
+  std::vector<double> grid_min_;
+  std::vector<double> grid_max_;
+  void addKernelToGrid(const kernel&);
+  bool isInsideGrid(const std::vector<double>&) const;
 //neighbour list stuff
   bool nlist_;
   double nlist_param_[2];
@@ -237,6 +291,14 @@ private:
   OFile stateOfile_;
   int wStateStride_;
   bool storeOldStates_;
+//binary state, written by a separate thread
+  bool stateBinary_;
+  std::string stateBinaryPath_;
+  BinaryTable stateTable_;
+  std::thread stateWriter_;
+  std::string stateWriterError_;
+  void waitForStateWriter();
+  void readBinaryState(const std::string&);
 
   double getProbAndDerivatives(const std::vector<double>&,std::vector<double>&);
   void addKernel(const double,const std::vector<double>&,const std::vector<double>&);
@@ -247,8 +309,12 @@ private:
 
 public:
   explicit OPESmetad(const ActionOptions&);
+  ~OPESmetad();
   void calculate() override;
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   static void registerKeywords(Keywords& keys);
 };
 
@@ -335,6 +401,10 @@ void OPESmetad<mode>::registerKeywords(Keywords& keys) {
   keys.add("optional","NLIST_PARAMETERS","( default=3.0,0.5 ) the two cutoff parameters for the kernels neighbor list");
   keys.addFlag("NLIST",false,"use neighbor list for kernels summation, faster but experimental");
   keys.addFlag("NLIST_PACE_RESET",false,"force the reset of the neighbor list at each PACE. Can be useful with WALKERS_MPI");
+  keys.add("optional","TREE_FOLD","store the kernels in a kd-tree that is built again every time this number of kernels has been added or changed. The tree is used to find the kernels to merge, to build the neighbor list and to sum the kernels");
+  keys.add("optional","GRID_MIN","the lower bounds of the grid on which the sum of the kernels is stored");
+  keys.add("optional","GRID_MAX","the upper bounds of the grid on which the sum of the kernels is stored");
+  keys.add("optional","GRID_BIN","the number of bins of the grid on which the sum of the kernels is stored");
   keys.addFlag("FIXED_SIGMA",false,"do not decrease sigma as the simulation proceeds. Can be added in a RESTART, to keep in check the number of compressed kernels");
   keys.addFlag("RECURSIVE_MERGE_OFF",false,"do not recursively attempt kernel merging when a new one is added");
   keys.addFlag("NO_ZED",false,"do not normalize over the explored CV space, Z_n=1");
@@ -345,6 +415,7 @@ void OPESmetad<mode>::registerKeywords(Keywords& keys) {
   keys.add("optional","STATE_WFILE","write to this file the compressed kernels and all the info needed to RESTART the simulation");
   keys.add("optional","STATE_WSTRIDE","number of MD steps between writing the STATE_WFILE. Default is only on CPT events (but not all MD codes set them)");
   keys.addFlag("STORE_STATES",false,"append to STATE_WFILE instead of ovewriting it each time");
+  keys.addFlag("STATE_BINARY",false,"write STATE_WFILE in binary format from a separate thread. The file is compressed if its name ends with .gz");
 //miscellaneous
   keys.addInputKeyword("optional","EXCLUDED_REGION","scalar","kernels are not deposited when the action provided here has a nonzero value, see example above");
   if(!mode::explore) {
@@ -497,6 +568,33 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
   }
   nlist_center_.resize(ncv_);
   nlist_dev2_.resize(ncv_,0.);
+  unsigned tree_fold=0;
+  parse("TREE_FOLD",tree_fold);
+  if(tree_fold>0) {
+    tree_=Tools::make_unique<KernelTree>(ncv_,tree_fold);
+  }
+
+//setup grid
+  std::vector<std::string> gmin;
+  parseVector("GRID_MIN",gmin);
+  std::vector<std::string> gmax;
+  parseVector("GRID_MAX",gmax);
+  std::vector<unsigned> gbin;
+  parseVector("GRID_BIN",gbin);
+  if(gmin.size()>0 || gmax.size()>0 || gbin.size()>0) {
+    plumed_massert(gmin.size()==ncv_ && gmax.size()==ncv_ && gbin.size()==ncv_,"GRID_MIN, GRID_MAX and GRID_BIN must all be given, with one value per ARG");
+    grid_=Tools::make_unique<Grid>(getLabel()+".prob",getArguments(),gmin,gmax,gbin,true,true);
+    const std::vector<std::string> actualmin=grid_->getMin();
+    const std::vector<std::string> actualmax=grid_->getMax();
+    grid_min_.resize(ncv_);
+    grid_max_.resize(ncv_);
+    for(unsigned i=0; i<ncv_; i++) {
+      plumed_massert(gmin[i]==actualmin[i],"GRID_MIN of "+getPntrToArgument(i)->getName()+" must be adjusted to "+actualmin[i]+" to fit periodicity");
+      plumed_massert(gmax[i]==actualmax[i],"GRID_MAX of "+getPntrToArgument(i)->getName()+" must be adjusted to "+actualmax[i]+" to fit periodicity");
+      Tools::convert(gmin[i],grid_min_[i]);
+      Tools::convert(gmax[i],grid_max_[i]);
+    }
+  }
   nlist_steps_=0;
   nlist_update_=true;
 
@@ -545,6 +643,14 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
   parse("STATE_WSTRIDE",wStateStride_);
   storeOldStates_=false;
   parseFlag("STORE_STATES",storeOldStates_);
+  stateBinary_=false;
+  parseFlag("STATE_BINARY",stateBinary_);
+  if(stateBinary_) {
+    plumed_massert(!storeOldStates_,"STORE_STATES cannot be used with STATE_BINARY");
+    plumed_massert(stateFileName.length()>0,"filename for storing simulation status not specified, use STATE_WFILE");
+    //otherwise the error would only be found by the thread that writes the file
+    plumed_massert(Tools::extension(stateFileName)!="gz" || BinaryTable::canCompress(),"STATE_WFILE cannot be compressed with STATE_BINARY, since PLUMED was compiled without zlib");
+  }
   if(wStateStride_!=0 || storeOldStates_) {
     plumed_massert(stateFileName.length()>0,"filename for storing simulation status not specified, use STATE_WFILE");
   }
@@ -598,7 +704,9 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
     }
     IFile ifile;
     ifile.link(*this);
-    if(ifile.FileExist(restartFileName)) {
+    if(stateRestart && ifile.FileExist(restartFileName) && BinaryTable::isBinary(ifile.getPath())) {
+      readBinaryState(ifile.getPath());
+    } else if(ifile.FileExist(restartFileName)) {
       bool tmp_nlist=nlist_;
       nlist_=false; // NLIST is not needed while restarting
       ifile.open(restartFileName);
@@ -700,6 +808,12 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
           ifile.scanField("height",height);
           ifile.scanField();
           kernels_.emplace_back(height,center,sigma);
+          if(tree_) {
+            tree_->add(View<const double>(center.data(),ncv_),View<const double>(sigma.data(),ncv_));
+          }
+        }
+        if(tree_) {
+          tree_->build();
         }
         log.printf("    a total of %lu kernels where read\n",kernels_.size());
       } else {
@@ -766,6 +880,11 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
   } else if(restartFileName.length()>0) {
     log.printf(" +++ WARNING +++ the provided STATE_RFILE will be ignored, since RESTART was not requested\n");
   }
+  if(grid_) {
+    for(const auto& k : kernels_) {
+      addKernelToGrid(k);
+    }
+  }
 
 //sync all walkers to avoid opening files before reading is over (see also METAD)
   comm.Barrier();
@@ -811,6 +930,10 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
       stateOfile_.enforceSuffix("");
     }
     stateOfile_.open(stateFileName);
+    if(stateBinary_) { //the file is opened only to get the same name and backup as a text file
+      stateBinaryPath_=stateOfile_.getPath();
+      stateOfile_.close();
+    }
     if(fmt.length()>0) {
       stateOfile_.fmtField(" "+fmt);
     }
@@ -909,6 +1032,15 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
   if(nlist_pace_reset_) {
     log.printf(" -- NLIST_PACE_RESET: forcing the neighbor list to update every PACE\n");
   }
+  if(tree_) {
+    log.printf(" -- TREE_FOLD: kernels are stored in a kd-tree that is built again every %u new or changed kernels\n",tree_fold);
+  }
+  if(grid_) {
+    log.printf(" -- GRID: the sum of the kernels is stored on a grid and interpolated with splines. Outside the grid the kernels are summed directly\n");
+    for(unsigned i=0; i<ncv_; i++) {
+      log.printf("    %s: from %s to %s with %u bins\n",getPntrToArgument(i)->getName().c_str(),gmin[i].c_str(),gmax[i].c_str(),gbin[i]);
+    }
+  }
   if(no_Zed_) {
     log.printf(" -- NO_ZED: using fixed normalization factor = %g\n",Zed_);
   }
@@ -918,6 +1050,9 @@ OPESmetad<mode>::OPESmetad(const ActionOptions& ao)
   if(wStateStride_==-1) {
     log.printf("  state checkpoints are written on file %s only on CPT events (or never if MD code does define them!)\n",stateFileName.c_str());
   }
+  if(stateBinary_) {
+    log.printf("  state checkpoints are written in binary format by a separate thread\n");
+  }
   if(walkers_mpi) {
     log.printf(" -- WALKERS_MPI: if multiple replicas are present, they will share the same bias via MPI\n");
   }
@@ -980,7 +1115,15 @@ void OPESmetad<mode>::calculate() {
 
 //set bias and forces
   std::vector<double> der_prob(ncv_,0);
-  const double prob=getProbAndDerivatives(cv,der_prob);
+  double prob;
+  if(grid_ && isInsideGrid(cv)) {
+    prob=grid_->getValueAndDerivatives(cv,der_prob)/KDEnorm_;
+    for(unsigned i=0; i<ncv_; i++) {
+      der_prob[i]/=KDEnorm_;
+    }
+  } else {
+    prob=getProbAndDerivatives(cv,der_prob);
+  }
   const double bias=kbt_*bias_prefactor_*std::log(prob/Zed_+epsilon_);
   setBias(bias);
   for(unsigned i=0; i<ncv_; i++) {
@@ -1165,6 +1308,11 @@ void OPESmetad<mode>::update() {
       }
     }
     getPntrToComponent("nker")->set(kernels_.size());
+    if(grid_) { //only the region of the new and removed kernels changes
+      for(const auto& k : delta_kernels_) {
+        addKernelToGrid(k);
+      }
+    }
     if(nlist_) {
       getPntrToComponent("nlker")->set(nlist_index_.size());
       if(nlist_pace_reset_) {
@@ -1258,7 +1406,14 @@ void OPESmetad<mode>::update() {
 template <class mode>
 double OPESmetad<mode>::getProbAndDerivatives(const std::vector<double>& cv,std::vector<double>& der_prob) {
   double prob=0.0;
-  if(!nlist_) {
+  if(tree_ && !nlist_) {
+    // only the kernels that are not truncated at cv are summed
+    findKernelsInTree(cv,std::sqrt(cutoff2_));
+    std::vector<double> dist(ncv_);
+    for(unsigned nk=rank_; nk<tree_found_.size(); nk+=NumParallel_) {
+      prob+=evaluateKernel(kernels_[tree_found_[nk]],cv,der_prob,dist);
+    }
+  } else if(!nlist_) {
     if(NumOMP_==1 || (unsigned)kernels_.size()<2*NumOMP_*NumParallel_) {
       // for performances and thread safety
       std::vector<double> dist(ncv_);
@@ -1327,6 +1482,9 @@ void OPESmetad<mode>::addKernel(const double height,const std::vector<double>& c
       no_match=false;
       delta_kernels_.emplace_back(-1*kernels_[taker_k].height,kernels_[taker_k].center,kernels_[taker_k].sigma);
       mergeKernels(kernels_[taker_k],kernel(height,center,sigma));
+      if(tree_) {
+        tree_->set(taker_k,View<const double>(kernels_[taker_k].center.data(),ncv_),View<const double>(kernels_[taker_k].sigma.data(),ncv_));
+      }
       delta_kernels_.push_back(kernels_[taker_k]);
       if(recursive_merge_) { //the overhead is worth it if it keeps low the total number of kernels
         unsigned giver_k=taker_k;
@@ -1340,6 +1498,10 @@ void OPESmetad<mode>::addKernel(const double height,const std::vector<double>& c
           mergeKernels(kernels_[taker_k],kernels_[giver_k]);
           delta_kernels_.push_back(kernels_[taker_k]);
           kernels_.erase(kernels_.begin()+giver_k);
+          if(tree_) {
+            tree_->set(taker_k,View<const double>(kernels_[taker_k].center.data(),ncv_),View<const double>(kernels_[taker_k].sigma.data(),ncv_));
+            tree_->remove(giver_k);
+          }
           if(nlist_) {
             unsigned giver_nk=0;
             bool found_giver=false;
@@ -1363,6 +1525,9 @@ void OPESmetad<mode>::addKernel(const double height,const std::vector<double>& c
   }
   if(no_match) {
     kernels_.emplace_back(height,center,sigma);
+    if(tree_) {
+      tree_->add(View<const double>(center.data(),ncv_),View<const double>(sigma.data(),ncv_));
+    }
     delta_kernels_.emplace_back(height,center,sigma);
     if(nlist_) {
       nlist_index_.push_back(kernels_.size()-1);
@@ -1391,6 +1556,28 @@ unsigned OPESmetad<mode>::getMergeableKernel(const std::vector<double>& giver_ce
   //returns kernels_.size() if no match is found
   unsigned min_k=kernels_.size();
   double min_norm2=threshold2_;
+  if(tree_ && !nlist_) {
+    // all the processes find the same kernels in the tree, so there is nothing to share
+    findKernelsInTree(giver_center,std::sqrt(threshold2_));
+    for(const auto k : tree_found_) {
+      if(k==giver_k) { //a kernel should not be merged with itself
+        continue;
+      }
+      double norm2=0;
+      for(unsigned i=0; i<ncv_; i++) {
+        const double dist_i=difference(i,giver_center[i],kernels_[k].center[i])/kernels_[k].sigma[i];
+        norm2+=dist_i*dist_i;
+        if(norm2>=min_norm2) {
+          break;
+        }
+      }
+      if(norm2<min_norm2) {
+        min_norm2=norm2;
+        min_k=k;
+      }
+    }
+    return min_k;
+  }
   if(!nlist_) {
     #pragma omp parallel num_threads(NumOMP_)
     {
@@ -1475,7 +1662,20 @@ void OPESmetad<mode>::updateNlist(const std::vector<double>& new_center) {
   nlist_center_=new_center;
   nlist_index_.clear();
   //first we gather all the nlist_index
-  if(NumOMP_==1 || (unsigned)kernels_.size()<2*NumOMP_*NumParallel_) {
+  if(tree_) {
+    // all the processes find the same kernels in the tree
+    findKernelsInTree(nlist_center_,std::sqrt(nlist_param_[0]*cutoff2_));
+    for(const auto k : tree_found_) {
+      double norm2_k=0;
+      for(unsigned i=0; i<ncv_; i++) {
+        const double dist_ik=difference(i,nlist_center_[i],kernels_[k].center[i])/kernels_[k].sigma[i];
+        norm2_k+=dist_ik*dist_ik;
+      }
+      if(norm2_k<=nlist_param_[0]*cutoff2_) {
+        nlist_index_.push_back(k);
+      }
+    }
+  } else if(NumOMP_==1 || (unsigned)kernels_.size()<2*NumOMP_*NumParallel_) {
     for(unsigned k=rank_; k<kernels_.size(); k+=NumParallel_) {
       double norm2_k=0;
       for(unsigned i=0; i<ncv_; i++) {
@@ -1508,7 +1708,7 @@ void OPESmetad<mode>::updateNlist(const std::vector<double>& new_center) {
       std::sort(nlist_index_.begin(),nlist_index_.end());
     }
   }
-  if(NumParallel_>1) {
+  if(NumParallel_>1 && !tree_) {
     std::vector<int> all_nlist_size(NumParallel_);
     all_nlist_size[rank_]=nlist_index_.size();
     comm.Sum(all_nlist_size);
@@ -1553,6 +1753,169 @@ void OPESmetad<mode>::updateNlist(const std::vector<double>& new_center) {
   nlist_update_=false;
 }
 
+template <class mode>
+void OPESmetad<mode>::findKernelsInTree(const std::vector<double>& x,const double scale) {
+  tree_->getKernelsAt(View<const double>(x.data(),ncv_),[this](unsigned i,double a,double b) {
+    return difference(i,a,b);
+  },tree_found_,scale);
+}
+
+template <class mode>
+void OPESmetad<mode>::addKernelToGrid(const kernel& G) {
+  //the grid points that are within the cutoff in each direction
+  const std::vector<unsigned> nbin=grid_->getNbin();
+  const std::vector<bool> pbc=grid_->getIsPeriodic();
+  const std::vector<double> dx=grid_->getDx();
+  std::vector<std::vector<unsigned>> points(ncv_);
+  std::size_t npoints=1;
+  for(unsigned i=0; i<ncv_; i++) {
+    const double cutoff_i=std::sqrt(cutoff2_)*G.sigma[i];
+    const long long first=std::floor((G.center[i]-cutoff_i-grid_min_[i])/dx[i]);
+    const long long last=std::ceil((G.center[i]+cutoff_i-grid_min_[i])/dx[i]);
+    const long long n=nbin[i];
+    for(long long k=first; k<=last && k-first<n; k++) { //a periodic point is taken only once
+      if(pbc[i]) {
+        points[i].push_back(((k%n)+n)%n);
+      } else if(k>=0 && k<n) {
+        points[i].push_back(k);
+      }
+    }
+    npoints*=points[i].size();
+  }
+  //each point is visited only once, so the threads never add to the same point
+  #pragma omp parallel num_threads(NumOMP_) if(npoints>=2*NumOMP_)
+  {
+    std::vector<unsigned> indices(ncv_);
+    std::vector<double> point(ncv_);
+    std::vector<double> der(ncv_);
+    std::vector<double> dist(ncv_);
+    #pragma omp for
+    for(std::size_t p=0; p<npoints; p++) {
+      std::size_t r=p;
+      for(unsigned i=0; i<ncv_; i++) {
+        indices[i]=points[i][r%points[i].size()];
+        r/=points[i].size();
+      }
+      grid_->getPoint(indices,point);
+      std::fill(der.begin(),der.end(),0.);
+      const double val=evaluateKernel(G,point,der,dist);
+      if(val!=0) {
+        grid_->addValueAndDerivatives(grid_->getIndex(indices),val,der);
+      }
+    }
+  }
+}
+
+template <class mode>
+bool OPESmetad<mode>::isInsideGrid(const std::vector<double>& cv) const {
+  for(unsigned i=0; i<ncv_; i++) {
+    if(!getPntrToArgument(i)->isPeriodic() && (cv[i]<grid_min_[i] || cv[i]>grid_max_[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class mode>
+OPESmetad<mode>::~OPESmetad() {
+  if(stateWriter_.joinable()) {
+    stateWriter_.join();
+  }
+  //no exception here, but the last checkpoint might be missing
+  if(stateWriterError_.length()>0) {
+    log.printf(" +++ WARNING +++ error while writing the binary STATE file: %s\n",stateWriterError_.c_str());
+    std::cerr<<"PLUMED WARNING: error while writing the binary STATE file of "<<getLabel()<<": "<<stateWriterError_<<"\n";
+  }
+}
+
+template <class mode>
+void OPESmetad<mode>::waitForStateWriter() {
+  if(stateWriter_.joinable()) {
+    stateWriter_.join();
+  }
+  if(stateWriterError_.length()>0) {
+    plumed_merror("error while writing the binary STATE file: "+stateWriterError_);
+  }
+}
+
+template <class mode>
+void OPESmetad<mode>::readBinaryState(const std::string& fname) {
+  log.printf("  RESTART - make sure all used options are compatible\n");
+  log.printf("    restarting from the binary STATE file: %s\n",fname.c_str());
+  BinaryTable table;
+  table.read(fname);
+  auto getField=[&table,&fname](const std::string& name) {
+    double value;
+    plumed_massert(table.getConstantField(name,value),"RESTART - field "+name+" is missing in file "+fname);
+    return value;
+  };
+  std::string old_action_name;
+  table.getConstantField("action",old_action_name);
+  plumed_massert(getName()+"_state"==old_action_name,"RESTART - mismatch between old and new action name. Expected '"+getName()+"_state', but found '"+old_action_name+"'");
+  const double old_biasfactor=getField("biasfactor");
+  if(std::isinf(old_biasfactor)!=std::isinf(biasfactor_) || std::abs(biasfactor_-old_biasfactor)>1e-6*biasfactor_) {
+    log.printf(" +++ WARNING +++ previous bias factor was %g while now it is %g\n",old_biasfactor,biasfactor_);
+  }
+  const double old_epsilon=getField("epsilon");
+  if(std::abs(epsilon_-old_epsilon)>1e-6*epsilon_) {
+    log.printf(" +++ WARNING +++ previous epsilon was %g while now it is %g. diff = %g\n",old_epsilon,epsilon_,epsilon_-old_epsilon);
+  }
+  const double cutoff=sqrt(cutoff2_);
+  const double old_cutoff=getField("kernel_cutoff");
+  if(std::abs(cutoff-old_cutoff)>1e-6*cutoff) {
+    log.printf(" +++ WARNING +++ previous kernel_cutoff was %g while now it is %g. diff = %g\n",old_cutoff,cutoff,cutoff-old_cutoff);
+  }
+  const double threshold=sqrt(threshold2_);
+  const double old_threshold=getField("compression_threshold");
+  if(std::abs(threshold-old_threshold)>1e-6*threshold) {
+    log.printf(" +++ WARNING +++ previous compression_threshold was %g while now it is %g. diff = %g\n",old_threshold,threshold,threshold-old_threshold);
+  }
+  Zed_=getField("zed");
+  sum_weights_=getField("sum_weights");
+  sum_weights2_=getField("sum_weights2");
+  counter_=getField("counter");
+  if(adaptive_sigma_) {
+    adaptive_counter_=getField("adaptive_counter");
+    for(unsigned i=0; i<ncv_; i++) {
+      const std::string arg_iw=getPntrToArgument(i)->getName()+(NumWalkers_==1?"":"_"+std::to_string(walker_rank_));
+      sigma0_[i]=getField("sigma0_"+arg_iw);
+      av_cv_[i]=getField("av_cv_"+arg_iw);
+      av_M2_[i]=getField("av_M2_"+arg_iw);
+    }
+  }
+  std::vector<std::string> columns;
+  for(unsigned i=0; i<ncv_; i++) {
+    columns.push_back(getPntrToArgument(i)->getName());
+    if(getPntrToArgument(i)->isPeriodic()) {
+      std::string arg_min,arg_max;
+      getPntrToArgument(i)->getDomain(arg_min,arg_max);
+      std::string file_min,file_max;
+      table.getConstantField("min_"+getPntrToArgument(i)->getName(),file_min);
+      table.getConstantField("max_"+getPntrToArgument(i)->getName(),file_max);
+      plumed_massert(file_min==arg_min,"RESTART - mismatch between old and new ARG periodicity");
+      plumed_massert(file_max==arg_max,"RESTART - mismatch between old and new ARG periodicity");
+    }
+  }
+  for(unsigned i=0; i<ncv_; i++) {
+    columns.push_back("sigma_"+getPntrToArgument(i)->getName());
+  }
+  columns.push_back("height");
+  plumed_massert(table.getColumns()==columns,"RESTART - mismatch between old and new ARG");
+  for(std::size_t k=0; k<table.getNumberOfRows(); k++) {
+    const View<const double> row=table.getRow(k);
+    std::vector<double> center(row.begin(),row.begin()+ncv_);
+    std::vector<double> sigma(row.begin()+ncv_,row.begin()+2*ncv_);
+    kernels_.emplace_back(row[2*ncv_],center,sigma);
+    if(tree_) {
+      tree_->add(View<const double>(center.data(),ncv_),View<const double>(sigma.data(),ncv_));
+    }
+  }
+  if(tree_) {
+    tree_->build();
+  }
+  log.printf("    a total of %lu kernels where read\n",kernels_.size());
+}
+
 template <class mode>
 void OPESmetad<mode>::dumpStateToFile() {
 //gather adaptive sigma info if needed
@@ -1574,6 +1937,65 @@ void OPESmetad<mode>::dumpStateToFile() {
     comm.Bcast(all_av_M2,0);
   }
 
+  if(stateBinary_) {
+    waitForStateWriter();
+    if(comm.Get_rank()>0 || stateBinaryPath_=="/dev/null") {
+      return;
+    }
+    //the table is filled here, and the thread only has to write it
+    stateTable_.clear();
+    stateTable_.addConstantField("action",getName()+"_state");
+    stateTable_.addConstantField("biasfactor",biasfactor_);
+    stateTable_.addConstantField("epsilon",epsilon_);
+    stateTable_.addConstantField("kernel_cutoff",sqrt(cutoff2_));
+    stateTable_.addConstantField("compression_threshold",sqrt(threshold2_));
+    stateTable_.addConstantField("zed",Zed_);
+    stateTable_.addConstantField("sum_weights",sum_weights_);
+    stateTable_.addConstantField("sum_weights2",sum_weights2_);
+    stateTable_.addConstantField("counter",counter_);
+    if(adaptive_sigma_) {
+      stateTable_.addConstantField("adaptive_counter",adaptive_counter_);
+      for(unsigned w=0; w<NumWalkers_; w++)
+        for(unsigned i=0; i<ncv_; i++) {
+          const std::string arg_iw=getPntrToArgument(i)->getName()+(NumWalkers_==1?"":"_"+std::to_string(w));
+          stateTable_.addConstantField("sigma0_"+arg_iw,NumWalkers_==1?sigma0_[i]:all_sigma0[w*ncv_+i]);
+          stateTable_.addConstantField("av_cv_"+arg_iw,NumWalkers_==1?av_cv_[i]:all_av_cv[w*ncv_+i]);
+          stateTable_.addConstantField("av_M2_"+arg_iw,NumWalkers_==1?av_M2_[i]:all_av_M2[w*ncv_+i]);
+        }
+    }
+    std::vector<std::string> columns;
+    for(unsigned i=0; i<ncv_; i++) {
+      columns.push_back(getPntrToArgument(i)->getName());
+      if(getPntrToArgument(i)->isPeriodic()) {
+        std::string arg_min,arg_max;
+        getPntrToArgument(i)->getDomain(arg_min,arg_max);
+        stateTable_.addConstantField("min_"+getPntrToArgument(i)->getName(),arg_min);
+        stateTable_.addConstantField("max_"+getPntrToArgument(i)->getName(),arg_max);
+      }
+    }
+    for(unsigned i=0; i<ncv_; i++) {
+      columns.push_back("sigma_"+getPntrToArgument(i)->getName());
+    }
+    columns.push_back("height");
+    stateTable_.setColumns(columns);
+    std::vector<double> row(2*ncv_+1);
+    for(unsigned k=0; k<kernels_.size(); k++) {
+      std::copy(kernels_[k].center.begin(),kernels_[k].center.end(),row.begin());
+      std::copy(kernels_[k].sigma.begin(),kernels_[k].sigma.end(),row.begin()+ncv_);
+      row[2*ncv_]=kernels_[k].height;
+      stateTable_.addRow(View<const double>(row.data(),row.size()));
+    }
+    const bool compress=(Tools::extension(stateBinaryPath_)=="gz");
+    stateWriter_=std::thread([this,compress]() {
+      try {
+        stateTable_.write(stateBinaryPath_,compress);
+      } catch(const std::exception& e) {
+        stateWriterError_=e.what();
+      }
+    });
+    return;
+  }
+
 //rewrite header or rewind file
   if(storeOldStates_) {
     stateOfile_.clearFields();
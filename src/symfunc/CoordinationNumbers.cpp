@@ -258,6 +258,7 @@ void CoordinationNumbers::shortcutKeywords( Keywords& keys ) {
   keys.add("compulsory","R_0","The r_0 parameter of the switching function");
   keys.add("optional","SWITCH","the switching function that it used in the construction of the contact matrix");
   keys.add("optional","MASK","the label for a vector that is used to determine which rows of the matrix are computed");
+  keys.add("optional","TASK_SCHEDULE","how the rows of the contact matrix are distributed over the OpenMP threads (STATIC or WORKSTEAL)");
   keys.linkActionInDocs("SWITCH","LESS_THAN");
   multicolvar::MultiColvarShortcuts::shortcutKeywords( keys );
   keys.needsAction("CONTACT_MATRIX");
@@ -266,12 +267,13 @@ void CoordinationNumbers::shortcutKeywords( Keywords& keys ) {
 }
 
 void CoordinationNumbers::expandMatrix( const bool& components, const std::string& lab, const std::string& sp_str,
-                                        const std::string& spa_str, const std::string& spb_str, ActionShortcut* action ) {
+                                        const std::string& spa_str, const std::string& spb_str, ActionShortcut* action, const bool rowsums ) {
   if( sp_str.length()==0 && spa_str.length()==0 ) {
     return;
   }
 
-  std::string matinp = lab  + "_mat: CONTACT_MATRIX";
+  // If only the sums of the rows are needed the contact matrix is never stored
+  std::string matinp = rowsums ? lab + ": CONTACT_MATRIX ROW_SUMS" : lab  + "_mat: CONTACT_MATRIX";
   if( sp_str.length()>0 ) {
     matinp += " GROUP=" + sp_str;
     action->readInputLine( lab + "_grp: GROUP ATOMS=" + sp_str );
@@ -306,6 +308,11 @@ void CoordinationNumbers::expandMatrix( const bool& components, const std::strin
   if( maskstr.length()>0 ) {
     matinp += " MASK=" + maskstr;
   }
+  std::string schedule;
+  action->parse("TASK_SCHEDULE",schedule);
+  if( schedule.length()>0 ) {
+    matinp += " TASK_SCHEDULE=" + schedule;
+  }
   action->readInputLine( matinp );
 }
 
@@ -337,39 +344,41 @@ CoordinationNumbers::CoordinationNumbers(const ActionOptions& ao):
   parse("SPECIES",sp_str);
   parse("SPECIESA",specA);
   parse("SPECIESB",specB);
-  if( sp_str.length()>0 || specA.length()>0 ) {
-    matlab = getShortcutLabel() + "_mat";
-    bool comp=false;
-    if( getName()=="COORDINATION_MOMENTS" ) {
-      comp=true;
-      matlab = getShortcutLabel() + "_mat";
-    }
-    expandMatrix( comp, getShortcutLabel(), sp_str, specA, specB, this );
-  } else {
+  if( sp_str.length()==0 && specA.length()==0 ) {
     error("missing atoms input use SPECIES or SPECIESA/SPECIESB");
   }
-  ActionWithValue* mb=plumed.getActionSet().selectWithLabel<ActionWithValue*>( matlab );
-  if( !mb ) {
-    error("could not find action with name " + matlab );
-  }
-  Value*  arg=mb->copyOutput(0);
-  if( arg->getRank()!=2 || arg->hasDerivatives() ) {
-    error("the input to this action should be a matrix or scalar");
-  }
-  // Create vector of ones to multiply input matrix by
-  std::string nones;
-  Tools::convert( arg->getShape()[1], nones );
-  readInputLine( getShortcutLabel() + "_ones: ONES SIZE=" + nones );
-  if( getName()=="COORDINATION_MOMENTS" ) {
-    // Calculate the lengths of the vectors
-    std::string r_power;
-    parse("R_POWER",r_power);
-    readInputLine( getShortcutLabel() + "_pow: CUSTOM ARG=" + matlab + ".x," + matlab + ".y," + matlab + ".z," + matlab + ".w VAR=x,y,z,w "
-                   + "PERIODIC=NO FUNC=w*(sqrt(x*x+y*y+z*z)^" + r_power +")");
-    matlab = getShortcutLabel() + "_pow";
+  // The coordination numbers are the sums of the rows of the contact matrix so they are calculated in the
+  // same loop as the elements of the matrix.  When a MASK is used only some of the rows are needed and
+  // the matrix is multiplied by a vector of ones as for the moments
+  if( getName()=="COORDINATIONNUMBER" && getKeyword("MASK").length()==0 ) {
+    expandMatrix( false, getShortcutLabel(), sp_str, specA, specB, this, true );
+  } else {
+    matlab = getShortcutLabel() + "_mat";
+    const bool comp = getName()=="COORDINATION_MOMENTS";
+    expandMatrix( comp, getShortcutLabel(), sp_str, specA, specB, this );
+    ActionWithValue* mb=plumed.getActionSet().selectWithLabel<ActionWithValue*>( matlab );
+    if( !mb ) {
+      error("could not find action with name " + matlab );
+    }
+    Value*  arg=mb->copyOutput(0);
+    if( arg->getRank()!=2 || arg->hasDerivatives() ) {
+      error("the input to this action should be a matrix or scalar");
+    }
+    // Create vector of ones to multiply input matrix by
+    std::string nones;
+    Tools::convert( arg->getShape()[1], nones );
+    readInputLine( getShortcutLabel() + "_ones: ONES SIZE=" + nones );
+    if( comp ) {
+      // Calculate the lengths of the vectors
+      std::string r_power;
+      parse("R_POWER",r_power);
+      readInputLine( getShortcutLabel() + "_pow: CUSTOM ARG=" + matlab + ".x," + matlab + ".y," + matlab + ".z," + matlab + ".w VAR=x,y,z,w "
+                     + "PERIODIC=NO FUNC=w*(sqrt(x*x+y*y+z*z)^" + r_power +")");
+      matlab = getShortcutLabel() + "_pow";
+    }
+    // Calcualte coordination numbers as matrix vector times vector of ones
+    readInputLine( getShortcutLabel() + ": MATRIX_VECTOR_PRODUCT  ARG=" + matlab + "," + getShortcutLabel() + "_ones");
   }
-  // Calcualte coordination numbers as matrix vector times vector of ones
-  readInputLine( getShortcutLabel() + ": MATRIX_VECTOR_PRODUCT  ARG=" + matlab + "," + getShortcutLabel() + "_ones");
   std::vector<std::string> moments;
   parseVector("MOMENTS",moments);
   Tools::interpretRanges( moments );
@@ -32,7 +32,7 @@ public:
   static void shortcutKeywords( Keywords& keys );
   static void registerKeywords( Keywords& keys );
   static void expandMatrix( const bool& components, const std::string& lab, const std::string& sp_str,
-                            const std::string& spa_str, const std::string& spb_str, ActionShortcut* action );
+                            const std::string& spa_str, const std::string& spb_str, ActionShortcut* action, const bool rowsums=false );
   explicit CoordinationNumbers(const ActionOptions&);
 };
 
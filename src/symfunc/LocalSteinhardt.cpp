@@ -500,6 +500,7 @@ void LocalSteinhardt::registerKeywords( Keywords& keys ) {
            "The following provides information on the \\ref switchingfunction that are available. "
            "When this keyword is present you no longer need the NN, MM, D_0 and R_0 keywords.");
   keys.add("optional","MASK","the label/s for vectors that are used to determine which local steinhardt parameters to compute");
+  keys.add("optional","TASK_SCHEDULE","how the rows of the contact matrix and the matrix of dot products are distributed over the OpenMP threads (STATIC or WORKSTEAL)");
   keys.addDeprecatedFlag("LOWMEM","");
   keys.setValueDescription("vector","the values of the local steinhardt parameters for the input atoms");
   multicolvar::MultiColvarShortcuts::shortcutKeywords( keys );
@@ -549,6 +550,11 @@ LocalSteinhardt::LocalSteinhardt(const ActionOptions& ao):
   bool usegpu;
   parseFlag("USEGPU",usegpu);
   const std::string doUSEGPU = usegpu?" USEGPU":"";
+  std::string schedule;
+  parse("TASK_SCHEDULE",schedule);
+  if( schedule.length()>0 ) {
+    schedule = " TASK_SCHEDULE=" + schedule;
+  }
 
 #define createLabel(name) const std::string name##Lab = getShortcutLabel()+"_"#name;
   bool lowmem;
@@ -620,10 +626,10 @@ LocalSteinhardt::LocalSteinhardt(const ActionOptions& ao):
       maskstr=" MASK=" + maskstr;
     }
     readInputLine( cmapLab + ": CONTACT_MATRIX GROUP=" + sp_str + " "
-                   "SWITCH={" + sw_str + "}" + maskstr + doUSEGPU);
+                   "SWITCH={" + sw_str + "}" + maskstr + schedule + doUSEGPU);
     // And the matrix of dot products
     readInputLine( dpmatLab + ": MATRIX_PRODUCT ARG=" + vecsLab + ","
-                   + vecsTLab + " MASK=" + cmapLab + doUSEGPU);
+                   + vecsTLab + " MASK=" + cmapLab + schedule + doUSEGPU);
   } else if( spa_str.length()>0 ) {
     // Create a group with these atoms
     readInputLine( grpLab + ": GROUP ATOMS=" + spa_str );
@@ -709,9 +715,9 @@ LocalSteinhardt::LocalSteinhardt(const ActionOptions& ao):
       maskstr=" MASK=" + maskstr;
     }
     readInputLine( cmapLab + ": CONTACT_MATRIX GROUPA=" + spa_str
-                   + " GROUPB=" + spb_str + " SWITCH={" + sw_str + "}" + maskstr + doUSEGPU);
+                   + " GROUPB=" + spb_str + " SWITCH={" + sw_str + "}" + maskstr + schedule + doUSEGPU);
     readInputLine( dpmatLab + ": MATRIX_PRODUCT ARG=" + vecsALab + "," + vecsBLab
-                   + " MASK=" + cmapLab + doUSEGPU);
+                   + " MASK=" + cmapLab + schedule + doUSEGPU);
   }
 
   // Now create the product matrix
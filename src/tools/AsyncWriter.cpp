@@ -0,0 +1,122 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "AsyncWriter.h"
+#include "Tools.h"
+
+#include <cstdlib>
+
+#ifdef __PLUMED_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace PLMD {
+
+AsyncWriter::AsyncWriter():
+  thread([this] {run();}) {
+}
+
+AsyncWriter::~AsyncWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop=true;
+  }
+  cv.notify_all();
+  thread.join();
+}
+
+AsyncWriter& AsyncWriter::get() {
+  // never destroyed: files that are closed while static objects are destroyed
+  // (e.g. in a plumed object that is a global variable) can still use it
+  static AsyncWriter* writer=new AsyncWriter;
+  return *writer;
+}
+
+bool AsyncWriter::enabled() {
+  static const bool async=[] {
+    const char* env=std::getenv("PLUMED_ASYNC_OUTPUT");
+    return env && std::string(env)=="yes";
+  }();
+  return async;
+}
+
+int AsyncWriter::gzipLevel() {
+  static const int level=[] {
+    int l=9;
+    if(std::getenv("PLUMED_GZIP_LEVEL")) {
+      Tools::convert(std::getenv("PLUMED_GZIP_LEVEL"),l);
+    }
+    return (l>=0 && l<=9) ? l : 9;
+  }();
+  return level;
+}
+
+void AsyncWriter::submit(FILE* fp,void* gzfp,const std::string& path,std::vector<char>& data) {
+  std::unique_lock<std::mutex> lock(mtx);
+  // the queue is bounded, the caller waits if the writer is too far behind
+  cv.wait(lock,[this] {return queuedBytes<maxQueuedBytes;});
+  queuedBytes+=data.size();
+  queue.push_back(Task{fp,gzfp,path,std::move(data)});
+  data.clear();
+  submitted++;
+  lock.unlock();
+  cv.notify_all();
+}
+
+std::string AsyncWriter::fence() {
+  std::unique_lock<std::mutex> lock(mtx);
+  const unsigned long long target=submitted;
+  cv.wait(lock,[this,target] {return completed>=target;});
+  std::string msg;
+  std::swap(msg,error);
+  return msg;
+}
+
+void AsyncWriter::run() {
+  std::unique_lock<std::mutex> lock(mtx);
+  while(true) {
+    cv.wait(lock,[this] {return stop || !queue.empty();});
+    if(queue.empty()) {
+      // stop was requested and everything has been written
+      return;
+    }
+    Task task=std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+    std::size_t r=0;
+    if(task.gzfp) {
+#ifdef __PLUMED_HAS_ZLIB
+      r=gzwrite(gzFile(task.gzfp),task.data.data(),task.data.size());
+#endif
+    } else {
+      r=std::fwrite(task.data.data(),1,task.data.size(),task.fp);
+    }
+    lock.lock();
+    if(r!=task.data.size() && error.empty()) {
+      error="error writing on file " + task.path;
+    }
+    queuedBytes-=task.data.size();
+    completed++;
+    cv.notify_all();
+  }
+}
+
+}
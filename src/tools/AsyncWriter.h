@@ -0,0 +1,94 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_AsyncWriter_h
+#define __PLUMED_tools_AsyncWriter_h
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+A thread that writes buffers on files in the background.
+
+When the environment variable PLUMED_ASYNC_OUTPUT is set to yes, OFile collects what
+is written on a file in a buffer and, when the buffer is large enough, hands it to
+this class. A single thread, shared by all the files, then writes the buffers in
+the order in which they were submitted, so the MD thread never waits for the file system
+unless the queue is full. fence() waits until all the buffers submitted so far are written,
+and it is used by OFile before flushing, rewinding or closing a file.
+
+Errors found while writing are reported by the next call to fence().
+*/
+class AsyncWriter {
+/// A buffer to be written on a file
+  struct Task {
+    FILE* fp;
+    void* gzfp;
+    std::string path;
+    std::vector<char> data;
+  };
+/// Maximum number of bytes waiting in the queue
+  static constexpr std::size_t maxQueuedBytes=64*1024*1024;
+  std::mutex mtx;
+/// Signals that the queue has changed
+  std::condition_variable cv;
+  std::deque<Task> queue;
+  std::size_t queuedBytes=0;
+/// Number of tasks submitted and completed
+  unsigned long long submitted=0;
+  unsigned long long completed=0;
+/// The first error found since the last fence
+  std::string error;
+  bool stop=false;
+  std::thread thread;
+  void run();
+  AsyncWriter();
+public:
+  ~AsyncWriter();
+  AsyncWriter(const AsyncWriter&) = delete;
+  AsyncWriter& operator=(const AsyncWriter&) = delete;
+/// The writer shared by all the files, started the first time it is used.
+/// It is never destroyed, so it can be used until the program exits
+  static AsyncWriter& get();
+/// True if asynchronous output was requested with PLUMED_ASYNC_OUTPUT
+  static bool enabled();
+/// The compression level of gzipped files, set with PLUMED_GZIP_LEVEL (default 9)
+  static int gzipLevel();
+/// Queue a buffer to be written on a file (fp, or gzfp if it is not NULL).
+/// The buffer is moved and left empty.
+  void submit(FILE* fp,void* gzfp,const std::string& path,std::vector<char>& data);
+/// Wait until all the buffers submitted so far are written.
+/// Returns an error message if some write failed, or an empty string.
+  std::string fence();
+};
+
+}
+
+#endif
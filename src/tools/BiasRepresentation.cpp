@@ -166,7 +166,6 @@ void BiasRepresentation::pushKernel( IFile *ifile ) {
   } else {
     dummyd=1.0;
   }
-  biasf.push_back(dummyd);
   // the domain does not pertain to the kernel but to the values here defined
   std::string mins,maxs,minv,maxv,mini,maxi;
   mins="min_";
@@ -181,6 +180,20 @@ void BiasRepresentation::pushKernel( IFile *ifile ) {
       plumed_massert(maxi==maxv,"the input periodicity in hills and in value definition does not match"  );
     }
   }
+  pushKernel( std::move(kk), dummyd );
+}
+
+void BiasRepresentation::pushKernel( const std::vector<double>& center, const std::vector<double>& sigma, const bool multivariate, const double height, const double bf ) {
+  if(histosigma.size()==0) {
+    pushKernel( Tools::make_unique<KernelFunctions>(center,sigma,"stretched-gaussian",(multivariate ? "MULTIVARIATE" : "DIAGONAL"),height), bf );
+  } else {
+    // when doing histogram assume gaussian with a given diagonal sigma
+    pushKernel( Tools::make_unique<KernelFunctions>(center,histosigma,"stretched-gaussian","DIAGONAL",1.0), bf );
+  }
+}
+
+void BiasRepresentation::pushKernel( std::unique_ptr<KernelFunctions> kk, const double bf ) {
+  biasf.push_back(bf);
   // if grid is defined then it should be added on the grid
   //cerr<<"now with "<<hills.size()<<endl;
   if(hasgrid) {
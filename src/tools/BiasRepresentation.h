@@ -61,6 +61,10 @@ public:
   void 		addGrid(const std::vector<std::string> & gmin, const std::vector<std::string> & gmax, const std::vector<unsigned> & nbin );
   /// push a kernel on the representation (includes widths and height)
   void 		pushKernel( IFile * ff);
+  /// push a kernel with the given center, widths and height on the representation
+  void 		pushKernel( const std::vector<double>& center, const std::vector<double>& sigma, const bool multivariate, const double height, const double bf );
+  /// push a kernel on the representation together with the bias factor that was used when it was added
+  void 		pushKernel( std::unique_ptr<KernelFunctions> kk, const double bf );
   /// set the flag that rescales the free energy to the bias
   void 		setRescaledToBias(bool rescaled);
   /// check if the representation is rescaled to the bias
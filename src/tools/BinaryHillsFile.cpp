@@ -0,0 +1,224 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "BinaryHillsFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if __has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#define PLUMED_BINARY_HILLS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace PLMD {
+
+namespace {
+/// The first bytes of a binary hills file
+constexpr char magic[8]= {'P','L','M','D','H','I','L','L'};
+/// The version of the format
+constexpr std::uint32_t version=1;
+/// The number of bytes that are used for the name and the domain of each variable
+constexpr std::size_t nameLength=64;
+constexpr std::size_t domainLength=32;
+/// The number of bytes before the variables
+constexpr std::size_t fixedHeaderSize=sizeof(magic)+2*sizeof(std::uint32_t)+2*sizeof(std::uint64_t);
+
+/// Get a string that is padded with zeros to n characters
+std::string readString( const char* ptr, std::size_t n ) {
+  return std::string( ptr, std::find( ptr, ptr+n, '\0' ) );
+}
+
+std::size_t getFileSize( const std::string& fname ) {
+  FILE* fp=std::fopen( fname.c_str(), "rb" );
+  plumed_massert( fp, "cannot open file " + fname );
+  std::fseek( fp, 0, SEEK_END );
+  long size=std::ftell( fp );
+  std::fclose( fp );
+  return size>0 ? size : 0;
+}
+}
+
+BinaryHillsFile::BinaryHillsFile():
+  headerSize(0),
+  hillSize(0),
+  nhills(0),
+  data(nullptr),
+  mappedSize(0) {
+}
+
+BinaryHillsFile::~BinaryHillsFile() {
+  unmap();
+}
+
+bool BinaryHillsFile::isBinary( const std::string& fname ) {
+  FILE* fp=std::fopen( fname.c_str(), "rb" );
+  if( !fp ) {
+    return false;
+  }
+  // the file is only reported as binary once the whole header has been written
+  char buf[fixedHeaderSize];
+  bool found=( std::fread( buf, 1, fixedHeaderSize, fp )==fixedHeaderSize && std::memcmp( buf, magic, sizeof(magic) )==0 );
+  if( found ) {
+    std::uint64_t hsize;
+    std::memcpy( &hsize, buf+sizeof(magic)+2*sizeof(std::uint32_t), sizeof(hsize) );
+    std::fseek( fp, 0, SEEK_END );
+    long size=std::ftell( fp );
+    found=( size>=0 && std::uint64_t(size)>=hsize );
+  }
+  std::fclose( fp );
+  return found;
+}
+
+void BinaryHillsFile::writeHeader( FILE* fp, const std::vector<Variable>& vars ) {
+  const std::uint32_t ncv=vars.size();
+  const std::uint64_t hsize=fixedHeaderSize + ncv*(nameLength+2*domainLength);
+  const std::uint64_t size=sizeof(double)*( 4 + ncv + ncv*(ncv+1)/2 );
+  std::vector<char> header( hsize, 0 );
+  char* ptr=header.data();
+  std::memcpy( ptr, magic, sizeof(magic) );
+  ptr+=sizeof(magic);
+  std::memcpy( ptr, &version, sizeof(version) );
+  ptr+=sizeof(version);
+  std::memcpy( ptr, &ncv, sizeof(ncv) );
+  ptr+=sizeof(ncv);
+  std::memcpy( ptr, &hsize, sizeof(hsize) );
+  ptr+=sizeof(hsize);
+  std::memcpy( ptr, &size, sizeof(size) );
+  ptr+=sizeof(size);
+  for(const auto & v : vars) {
+    plumed_massert( v.name.length()<nameLength, "name of variable " + v.name + " is too long for a binary hills file" );
+    plumed_massert( v.min.length()<domainLength && v.max.length()<domainLength, "domain of variable " + v.name + " is too long for a binary hills file" );
+    std::memcpy( ptr, v.name.c_str(), v.name.length() );
+    ptr+=nameLength;
+    std::memcpy( ptr, v.min.c_str(), v.min.length() );
+    ptr+=domainLength;
+    std::memcpy( ptr, v.max.c_str(), v.max.length() );
+    ptr+=domainLength;
+  }
+  plumed_massert( std::fwrite( header.data(), 1, hsize, fp )==hsize, "cannot write header of binary hills file" );
+}
+
+void BinaryHillsFile::writeHill( FILE* fp, double time, View<const double> center, bool multivariate, View<const double> sigma, double height, double biasf ) {
+  const std::size_t ncv=center.size();
+  // the hills all have the same size so that any of them can be found without reading the others
+  std::vector<double> hill( 4 + ncv + ncv*(ncv+1)/2, 0.0 );
+  hill[0]=time;
+  hill[1]=multivariate ? 1.0 : 0.0;
+  hill[2]=height;
+  hill[3]=biasf;
+  std::copy( center.begin(), center.end(), hill.begin()+4 );
+  plumed_assert( sigma.size()==( multivariate ? ncv*(ncv+1)/2 : ncv ) );
+  std::copy( sigma.begin(), sigma.end(), hill.begin()+4+ncv );
+  plumed_massert( std::fwrite( hill.data(), sizeof(double), hill.size(), fp )==hill.size(), "cannot write hill in binary hills file" );
+}
+
+void BinaryHillsFile::open( const std::string& fname ) {
+  unmap();
+  buffer.clear();
+  nhills=0;
+  path=fname;
+  FILE* fp=std::fopen( path.c_str(), "rb" );
+  plumed_massert( fp, "cannot open file " + path );
+  char buf[fixedHeaderSize];
+  bool ok=( std::fread( buf, 1, fixedHeaderSize, fp )==fixedHeaderSize && std::memcmp( buf, magic, sizeof(magic) )==0 );
+  if( !ok ) {
+    std::fclose( fp );
+    plumed_merror("file " + path + " is not a binary hills file");
+  }
+  std::uint32_t fversion, ncv;
+  std::uint64_t hsize, size;
+  const char* ptr=buf+sizeof(magic);
+  std::memcpy( &fversion, ptr, sizeof(fversion) );
+  ptr+=sizeof(fversion);
+  std::memcpy( &ncv, ptr, sizeof(ncv) );
+  ptr+=sizeof(ncv);
+  std::memcpy( &hsize, ptr, sizeof(hsize) );
+  ptr+=sizeof(hsize);
+  std::memcpy( &size, ptr, sizeof(size) );
+  if( fversion!=version ) {
+    std::fclose( fp );
+    plumed_merror("binary hills file " + path + " was written with an unknown version of the format");
+  }
+  headerSize=hsize;
+  hillSize=size;
+  std::vector<char> names( headerSize-fixedHeaderSize );
+  ok=( std::fread( names.data(), 1, names.size(), fp )==names.size() );
+  std::fclose( fp );
+  plumed_massert( ok, "cannot read the header of binary hills file " + path );
+  variables.resize( ncv );
+  for(unsigned i=0; i<ncv; ++i) {
+    const char* var=names.data() + i*(nameLength+2*domainLength);
+    variables[i].name=readString( var, nameLength );
+    variables[i].min=readString( var+nameLength, domainLength );
+    variables[i].max=readString( var+nameLength+domainLength, domainLength );
+  }
+  update();
+}
+
+std::size_t BinaryHillsFile::update() {
+  plumed_massert( headerSize>0, "binary hills file has not been opened" );
+  const std::size_t size=getFileSize( path );
+  // only the hills that have been completely written are used
+  const std::size_t n=size>headerSize ? (size-headerSize)/hillSize : 0;
+  if( n==nhills && data ) {
+    return nhills;
+  }
+  const std::size_t needed=headerSize + n*hillSize;
+#ifdef PLUMED_BINARY_HILLS_MMAP
+  unmap();
+  int fd=::open( path.c_str(), O_RDONLY );
+  plumed_massert( fd>=0, "cannot open file " + path );
+  void* ptr=::mmap( nullptr, needed, PROT_READ, MAP_SHARED, fd, 0 );
+  ::close( fd );
+  plumed_massert( ptr!=MAP_FAILED, "cannot map binary hills file " + path );
+  data=static_cast<const char*>( ptr );
+  mappedSize=needed;
+#else
+  // read only the part of the file that has not been read yet
+  const std::size_t start=buffer.size();
+  buffer.resize( needed );
+  FILE* fp=std::fopen( path.c_str(), "rb" );
+  plumed_massert( fp, "cannot open file " + path );
+  std::fseek( fp, start, SEEK_SET );
+  bool ok=( std::fread( buffer.data()+start, 1, needed-start, fp )==needed-start );
+  std::fclose( fp );
+  plumed_massert( ok, "cannot read binary hills file " + path );
+  data=buffer.data();
+#endif
+  nhills=n;
+  return nhills;
+}
+
+void BinaryHillsFile::unmap() {
+#ifdef PLUMED_BINARY_HILLS_MMAP
+  if( data ) {
+    ::munmap( const_cast<char*>( data ), mappedSize );
+  }
+#endif
+  data=nullptr;
+  mappedSize=0;
+}
+
+}
@@ -0,0 +1,145 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_BinaryHillsFile_h
+#define __PLUMED_tools_BinaryHillsFile_h
+
+#include "Exception.h"
+#include "View.h"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+A file of Gaussian hills in binary format.
+
+The file starts with a short header that contains the names and the periodicities
+of the variables.  The hills follow and all of them take the same number of bytes,
+so the number of hills and the position of each of them is known from the size of
+the file.  Each hill contains, as double precision numbers, the time, a flag
+that is one for multivariate hills, the height and the bias factor as they would be written in
+a text HILLS file, the center, and the widths.  The widths of multivariate hills are
+the upper triangle of the inverse of the covariance matrix (that is the metric that
+is used internally by METAD) so they can be used without any conversion.
+
+The file is written by appending hills at its end, so a hill that is only
+partially written (e.g. because the run was killed) is ignored by the readers.
+When reading, the file is mapped in memory (where mmap is available) and the hills are
+used directly from there, nothing is parsed.  update() can be called while another
+process is appending hills to the file to map the new hills.
+
+The file uses the byte order of the machine on which it was written.
+*/
+class BinaryHillsFile {
+public:
+/// A variable in the file.  The domain is empty for variables that are not periodic
+  struct Variable {
+    std::string name;
+    std::string min;
+    std::string max;
+  };
+private:
+/// The path of the file that is read
+  std::string path;
+/// The variables
+  std::vector<Variable> variables;
+/// The size of the header and of a hill in bytes
+  std::size_t headerSize;
+  std::size_t hillSize;
+/// The number of complete hills that are available
+  std::size_t nhills;
+/// The memory that holds the file
+  const char* data;
+  std::size_t mappedSize;
+/// The file is copied here when it cannot be mapped
+  std::vector<char> buffer;
+/// Give back the memory that holds the file
+  void unmap();
+/// Get the start of the data of hill i
+  const double* getHill( std::size_t i ) const ;
+public:
+  BinaryHillsFile();
+  ~BinaryHillsFile();
+  BinaryHillsFile(const BinaryHillsFile&) = delete;
+  BinaryHillsFile& operator=(const BinaryHillsFile&) = delete;
+/// Check if a file is a binary hills file with a complete header
+  static bool isBinary( const std::string& fname );
+/// Write the header of a new file
+  static void writeHeader( FILE* fp, const std::vector<Variable>& vars );
+/// Write a hill at the end of the file
+  static void writeHill( FILE* fp, double time, View<const double> center, bool multivariate, View<const double> sigma, double height, double biasf );
+/// Open a file and map the hills that are in it
+  void open( const std::string& fname );
+/// Map the hills that have been added to the file since it was opened or since the last update.
+/// The number of hills in the file is returned
+  std::size_t update();
+/// Get the variables
+  const std::vector<Variable>& getVariables() const {
+    return variables;
+  }
+/// Get the number of variables
+  unsigned getNumberOfVariables() const {
+    return variables.size();
+  }
+/// Get the number of hills in the file
+  std::size_t getNumberOfHills() const {
+    return nhills;
+  }
+/// Get the time at which hill i was added
+  double getTime( std::size_t i ) const {
+    return getHill(i)[0];
+  }
+/// Check if hill i is multivariate
+  bool isMultivariate( std::size_t i ) const {
+    return getHill(i)[1]>0.5;
+  }
+/// Get the height of hill i
+  double getHeight( std::size_t i ) const {
+    return getHill(i)[2];
+  }
+/// Get the bias factor of hill i
+  double getBiasFactor( std::size_t i ) const {
+    return getHill(i)[3];
+  }
+/// Get the center of hill i
+  View<const double> getCenter( std::size_t i ) const {
+    return View<const double>( getHill(i)+4, variables.size() );
+  }
+/// Get the widths of hill i
+  View<const double> getSigma( std::size_t i ) const {
+    const unsigned ncv=variables.size();
+    return View<const double>( getHill(i)+4+ncv, isMultivariate(i) ? ncv*(ncv+1)/2 : ncv );
+  }
+};
+
+inline
+const double* BinaryHillsFile::getHill( std::size_t i ) const {
+  plumed_dbg_assert( i<nhills );
+  return reinterpret_cast<const double*>( data + headerSize + i*hillSize );
+}
+
+}
+
+#endif
@@ -0,0 +1,257 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "BinaryTable.h"
+#include "Exception.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __PLUMED_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace PLMD {
+
+namespace {
+/// The first bytes of a binary table
+constexpr char magic[8]= {'P','L','M','D','T','A','B','L'};
+/// The version of the format
+constexpr std::uint32_t version=1;
+/// Flag for compressed tables
+constexpr std::uint32_t compressedFlag=1;
+/// The number of bytes before the content of the table
+constexpr std::size_t headerSize=sizeof(magic)+2*sizeof(std::uint32_t)+sizeof(std::uint64_t);
+
+template<typename T>
+void put( std::string& buffer, const T& t ) {
+  buffer.append( reinterpret_cast<const char*>(&t), sizeof(T) );
+}
+
+void putString( std::string& buffer, const std::string& s ) {
+  put( buffer, static_cast<std::uint64_t>( s.size() ) );
+  buffer.append( s );
+}
+
+/// Reads the content of a table and checks that it is not truncated
+class Reader {
+  const std::string& buffer;
+  const std::string& fname;
+  std::size_t pos;
+public:
+  Reader( const std::string& b, const std::string& f ): buffer(b), fname(f), pos(0) {}
+  template<typename T>
+  T get() {
+    plumed_massert( pos+sizeof(T)<=buffer.size(), "file " + fname + " is truncated" );
+    T t;
+    std::memcpy( &t, buffer.data()+pos, sizeof(T) );
+    pos+=sizeof(T);
+    return t;
+  }
+  std::string getString() {
+    const std::uint64_t n=get<std::uint64_t>();
+    plumed_massert( pos+n<=buffer.size(), "file " + fname + " is truncated" );
+    std::string s( buffer.data()+pos, n );
+    pos+=n;
+    return s;
+  }
+  void getDoubles( std::vector<double>& v, std::uint64_t n ) {
+    plumed_massert( pos+n*sizeof(double)<=buffer.size(), "file " + fname + " is truncated" );
+    v.resize( n );
+    if( n>0 ) {
+      std::memcpy( v.data(), buffer.data()+pos, n*sizeof(double) );
+    }
+    pos+=n*sizeof(double);
+  }
+};
+}
+
+bool BinaryTable::isBinary( const std::string& fname ) {
+  FILE* fp=std::fopen( fname.c_str(), "rb" );
+  if( !fp ) {
+    return false;
+  }
+  char buffer[sizeof(magic)];
+  const bool binary=std::fread( buffer, 1, sizeof(magic), fp )==sizeof(magic) && std::memcmp( buffer, magic, sizeof(magic) )==0;
+  std::fclose( fp );
+  return binary;
+}
+
+bool BinaryTable::canCompress() {
+#ifdef __PLUMED_HAS_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+void BinaryTable::clear() {
+  stringFields.clear();
+  numberFields.clear();
+  columns.clear();
+  data.clear();
+}
+
+void BinaryTable::addConstantField( const std::string& name, const std::string& value ) {
+  stringFields.emplace_back( name, value );
+}
+
+void BinaryTable::addConstantField( const std::string& name, double value ) {
+  numberFields.emplace_back( name, value );
+}
+
+bool BinaryTable::getConstantField( const std::string& name, std::string& value ) const {
+  for(const auto & f : stringFields) {
+    if( f.first==name ) {
+      value=f.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BinaryTable::getConstantField( const std::string& name, double& value ) const {
+  for(const auto & f : numberFields) {
+    if( f.first==name ) {
+      value=f.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+void BinaryTable::setColumns( const std::vector<std::string>& names ) {
+  columns=names;
+  data.clear();
+}
+
+void BinaryTable::addRow( View<const double> row ) {
+  plumed_dbg_assert( row.size()==columns.size() );
+  data.insert( data.end(), row.begin(), row.end() );
+}
+
+void BinaryTable::write( const std::string& fname, bool compress ) const {
+  std::string content;
+  content.reserve( 1024 + data.size()*sizeof(double) );
+  put( content, static_cast<std::uint64_t>( stringFields.size() ) );
+  for(const auto & f : stringFields) {
+    putString( content, f.first );
+    putString( content, f.second );
+  }
+  put( content, static_cast<std::uint64_t>( numberFields.size() ) );
+  for(const auto & f : numberFields) {
+    putString( content, f.first );
+    put( content, f.second );
+  }
+  put( content, static_cast<std::uint64_t>( columns.size() ) );
+  for(const auto & c : columns) {
+    putString( content, c );
+  }
+  put( content, static_cast<std::uint64_t>( data.size() ) );
+  content.append( reinterpret_cast<const char*>( data.data() ), data.size()*sizeof(double) );
+
+  std::string header( magic, sizeof(magic) );
+  put( header, version );
+  put( header, compress ? compressedFlag : std::uint32_t(0) );
+  put( header, static_cast<std::uint64_t>( content.size() ) );
+  if( compress ) {
+#ifdef __PLUMED_HAS_ZLIB
+    uLongf size=compressBound( content.size() );
+    std::string compressed( size, '\0' );
+    const int err=compress2( reinterpret_cast<Bytef*>( &compressed[0] ), &size, reinterpret_cast<const Bytef*>( content.data() ), content.size(), Z_BEST_SPEED );
+    plumed_massert( err==Z_OK, "error while compressing file " + fname );
+    compressed.resize( size );
+    content.swap( compressed );
+#else
+    plumed_merror( "file " + fname + ": trying to compress a binary table without zlib being linked" );
+#endif
+  }
+
+  // the table is written on a temporary file that replaces the old one only when it is complete
+  const std::string tmpname=fname + ".tmp";
+  FILE* fp=std::fopen( tmpname.c_str(), "wb" );
+  plumed_massert( fp, "cannot open file " + tmpname );
+  const bool written=std::fwrite( header.data(), 1, header.size(), fp )==header.size()
+                     && std::fwrite( content.data(), 1, content.size(), fp )==content.size();
+  const bool closed=std::fclose( fp )==0;
+  if( !written || !closed ) {
+    std::remove( tmpname.c_str() );
+    plumed_merror( "error while writing file " + tmpname );
+  }
+  plumed_massert( std::rename( tmpname.c_str(), fname.c_str() )==0, "cannot rename file " + tmpname + " to " + fname );
+}
+
+void BinaryTable::read( const std::string& fname ) {
+  FILE* fp=std::fopen( fname.c_str(), "rb" );
+  plumed_massert( fp, "cannot open file " + fname );
+  std::string file;
+  char chunk[65536];
+  std::size_t n;
+  while( (n=std::fread( chunk, 1, sizeof(chunk), fp ))>0 ) {
+    file.append( chunk, n );
+  }
+  std::fclose( fp );
+  plumed_massert( file.size()>=headerSize && std::memcmp( file.data(), magic, sizeof(magic) )==0, "file " + fname + " is not a binary table" );
+
+  Reader header( file, fname );
+  for(unsigned i=0; i<sizeof(magic); ++i) {
+    header.get<char>();
+  }
+  const std::uint32_t fileVersion=header.get<std::uint32_t>();
+  plumed_massert( fileVersion==version, "file " + fname + " was written with a different version of the binary format" );
+  const std::uint32_t flags=header.get<std::uint32_t>();
+  const std::uint64_t contentSize=header.get<std::uint64_t>();
+  std::string content;
+  if( flags & compressedFlag ) {
+#ifdef __PLUMED_HAS_ZLIB
+    content.resize( contentSize );
+    uLongf size=contentSize;
+    const int err=uncompress( reinterpret_cast<Bytef*>( &content[0] ), &size, reinterpret_cast<const Bytef*>( file.data()+headerSize ), file.size()-headerSize );
+    plumed_massert( err==Z_OK && size==contentSize, "error while uncompressing file " + fname );
+#else
+    plumed_merror( "file " + fname + ": trying to read a compressed binary table without zlib being linked" );
+#endif
+  } else {
+    content=file.substr( headerSize );
+    plumed_massert( content.size()==contentSize, "file " + fname + " is truncated" );
+  }
+
+  clear();
+  Reader reader( content, fname );
+  const std::uint64_t nstrings=reader.get<std::uint64_t>();
+  for(std::uint64_t i=0; i<nstrings; ++i) {
+    std::string name=reader.getString();
+    stringFields.emplace_back( name, reader.getString() );
+  }
+  const std::uint64_t nnumbers=reader.get<std::uint64_t>();
+  for(std::uint64_t i=0; i<nnumbers; ++i) {
+    std::string name=reader.getString();
+    numberFields.emplace_back( name, reader.get<double>() );
+  }
+  const std::uint64_t ncolumns=reader.get<std::uint64_t>();
+  for(std::uint64_t i=0; i<ncolumns; ++i) {
+    columns.push_back( reader.getString() );
+  }
+  reader.getDoubles( data, reader.get<std::uint64_t>() );
+  plumed_massert( columns.empty() ? data.empty() : data.size()%columns.size()==0, "file " + fname + " is corrupted" );
+}
+
+}
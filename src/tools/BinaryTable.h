@@ -0,0 +1,95 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_BinaryTable_h
+#define __PLUMED_tools_BinaryTable_h
+
+#include "View.h"
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+A table of numbers with named columns and a set of constant fields, stored in a binary file.
+
+The file contains a short header, the constant fields, the names of the columns and then
+the rows of the table as double precision numbers, so that numbers are written and read back
+exactly and without any parsing.  Constant fields can be strings or numbers.
+If the table is compressed (only possible when PLUMED is linked with zlib) everything
+after the header is compressed.
+
+write() writes the table on a temporary file that is then renamed to the final name,
+so that the file is either the old one or the new one, even if the run is killed while writing.
+write() and read() do not use anything but the table itself, so they can be called from
+a thread that is not the one running the simulation.
+
+The file uses the byte order of the machine on which it was written.
+*/
+class BinaryTable {
+/// The constant fields
+  std::vector<std::pair<std::string,std::string>> stringFields;
+  std::vector<std::pair<std::string,double>> numberFields;
+/// The names of the columns
+  std::vector<std::string> columns;
+/// The rows, one after the other
+  std::vector<double> data;
+public:
+/// Check if a file is a binary table
+  static bool isBinary( const std::string& fname );
+/// Check if tables can be compressed
+  static bool canCompress();
+/// Remove everything from the table
+  void clear();
+/// Add a constant field
+  void addConstantField( const std::string& name, const std::string& value );
+  void addConstantField( const std::string& name, double value );
+/// Get a constant field, false is returned if there is no such field
+  bool getConstantField( const std::string& name, std::string& value ) const ;
+  bool getConstantField( const std::string& name, double& value ) const ;
+/// Set the names of the columns, this removes all the rows
+  void setColumns( const std::vector<std::string>& names );
+/// Get the names of the columns
+  const std::vector<std::string>& getColumns() const {
+    return columns;
+  }
+/// Add a row at the end of the table
+  void addRow( View<const double> row );
+/// Get the number of rows
+  std::size_t getNumberOfRows() const {
+    return columns.empty() ? 0 : data.size()/columns.size();
+  }
+/// Get row i
+  View<const double> getRow( std::size_t i ) const {
+    return View<const double>( data.data()+i*columns.size(), columns.size() );
+  }
+/// Write the table on a file, an exception is thrown if it cannot be written
+  void write( const std::string& fname, bool compress ) const ;
+/// Read the table from a file
+  void read( const std::string& fname );
+};
+
+}
+
+#endif
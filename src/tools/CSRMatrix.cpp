@@ -0,0 +1,150 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "CSRMatrix.h"
+#include "Exception.h"
+#include "OpenMP.h"
+#include <algorithm>
+#include <limits>
+
+namespace PLMD {
+
+void CSRMatrix::clear( std::size_t nr, std::size_t nc ) {
+  nrows=nr;
+  ncols=nc;
+  rowStart.assign( nrows+1, 0 );
+  columns.clear();
+  values.clear();
+}
+
+std::size_t CSRMatrix::getMaxRowLength() const {
+  std::size_t maxlen=0;
+  for(std::size_t i=0; i<nrows; ++i) {
+    maxlen=std::max( maxlen, getRowLength(i) );
+  }
+  return maxlen;
+}
+
+void CSRMatrix::partitionRows( unsigned nparts, std::vector<std::size_t>& starts ) const {
+  plumed_assert( nparts>0 );
+  starts.resize( nparts+1 );
+  starts[0]=0;
+  // each row costs its nonzero elements plus one, so that empty rows are also divided
+  const double total=static_cast<double>( getNumberOfNonZeros() + nrows );
+  std::size_t irow=0;
+  for(unsigned p=1; p<nparts; ++p) {
+    const double target=total*p/nparts;
+    while( irow<nrows && static_cast<double>( rowStart[irow] + irow )<target ) {
+      irow++;
+    }
+    starts[p]=irow;
+  }
+  starts[nparts]=nrows;
+}
+
+void CSRMatrix::transpose( CSRMatrix& t, std::vector<std::size_t>* origin ) const {
+  t.clear( ncols, nrows );
+  const std::size_t nnz=getNumberOfNonZeros();
+  // count the elements in each column
+  for(std::size_t k=0; k<nnz; ++k) {
+    t.rowStart[ columns[k]+1 ]++;
+  }
+  for(std::size_t j=0; j<ncols; ++j) {
+    t.rowStart[j+1]+=t.rowStart[j];
+  }
+  t.columns.resize( nnz );
+  t.values.resize( nnz );
+  if( origin ) {
+    origin->resize( nnz );
+  }
+  // the rows of this matrix are visited in order, so the columns of the transpose are sorted
+  std::vector<std::size_t> next( t.rowStart.begin(), t.rowStart.end()-1 );
+  for(std::size_t i=0; i<nrows; ++i) {
+    for(std::size_t k=rowStart[i]; k<rowStart[i+1]; ++k) {
+      const std::size_t dest=next[ columns[k] ]++;
+      t.columns[dest]=i;
+      t.values[dest]=values[k];
+      if( origin ) {
+        (*origin)[dest]=k;
+      }
+    }
+  }
+}
+
+void CSRMatrix::multiplyPattern( const CSRMatrix& b, CSRMatrix& c, unsigned nt ) const {
+  plumed_assert( ncols==b.nrows );
+  if( nt==0 ) {
+    nt=OpenMP::getNumThreads();
+  }
+  if( nt*10>nrows ) {
+    nt=1;
+  }
+  c.clear( nrows, b.ncols );
+  std::vector<std::size_t> starts;
+  partitionRows( nt, starts );
+  constexpr unsigned unset=std::numeric_limits<unsigned>::max();
+  // the rows of c are first counted and then filled, each thread uses a marker that is
+  // as long as a row of c to find the columns that have already been found in the row
+  #pragma omp parallel num_threads(nt)
+  {
+    const unsigned t=OpenMP::getThreadNum();
+    std::vector<unsigned> marker( b.ncols, unset );
+    for(std::size_t i=starts[t]; i<starts[t+1]; ++i) {
+      std::size_t len=0;
+      for(std::size_t ka=rowStart[i]; ka<rowStart[i+1]; ++ka) {
+        const unsigned k=columns[ka];
+        for(std::size_t kb=b.rowStart[k]; kb<b.rowStart[k+1]; ++kb) {
+          if( marker[ b.columns[kb] ]!=i ) {
+            marker[ b.columns[kb] ]=i;
+            len++;
+          }
+        }
+      }
+      c.rowStart[i+1]=len;
+    }
+    #pragma omp barrier
+    #pragma omp single
+    {
+      for(std::size_t i=0; i<nrows; ++i) {
+        c.rowStart[i+1]+=c.rowStart[i];
+      }
+      c.columns.resize( c.rowStart[nrows] );
+      c.values.assign( c.rowStart[nrows], 0.0 );
+    }
+    std::fill( marker.begin(), marker.end(), unset );
+    for(std::size_t i=starts[t]; i<starts[t+1]; ++i) {
+      std::size_t pos=c.rowStart[i];
+      for(std::size_t ka=rowStart[i]; ka<rowStart[i+1]; ++ka) {
+        const unsigned k=columns[ka];
+        for(std::size_t kb=b.rowStart[k]; kb<b.rowStart[k+1]; ++kb) {
+          const unsigned j=b.columns[kb];
+          if( marker[j]!=i ) {
+            marker[j]=i;
+            c.columns[pos++]=j;
+          }
+        }
+      }
+      std::sort( c.columns.begin()+c.rowStart[i], c.columns.begin()+c.rowStart[i+1] );
+    }
+  }
+}
+
+}
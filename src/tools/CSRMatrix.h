@@ -0,0 +1,85 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_CSRMatrix_h
+#define __PLUMED_tools_CSRMatrix_h
+
+#include <cstddef>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+A sparse matrix in compressed sparse row (CSR) format.
+
+The nonzero elements of row i are in positions rowStart[i] to rowStart[i+1]-1 of
+columns and values.  The same object can be used to store a matrix in compressed
+sparse column (CSC) format, as the CSC representation of a matrix is the CSR
+representation of its transpose.
+
+The kernels never build a dense copy of the matrices, so the memory and the time that
+are needed only depend on the number of nonzero elements.  The rows are divided between
+the OpenMP threads in blocks that contain approximately the same number of nonzero elements.
+
+\verbatim
+CSRMatrix a, at, aat;
+a.transpose( at );
+a.multiplyPattern( at, aat );  // the nonzero elements of a a^T
+\endverbatim
+*/
+class CSRMatrix {
+public:
+/// The number of rows and columns
+  std::size_t nrows=0;
+  std::size_t ncols=0;
+/// The start of each row in columns and values (the last element is the number of nonzero elements)
+  std::vector<std::size_t> rowStart{0};
+/// The column index of each nonzero element
+  std::vector<unsigned> columns;
+/// The value of each nonzero element
+  std::vector<double> values;
+/// Set the shape of the matrix and remove all the elements
+  void clear( std::size_t nr, std::size_t nc );
+/// Get the number of nonzero elements
+  std::size_t getNumberOfNonZeros() const {
+    return rowStart[nrows];
+  }
+/// Get the number of nonzero elements in row i
+  std::size_t getRowLength( std::size_t i ) const {
+    return rowStart[i+1]-rowStart[i];
+  }
+/// Get the largest number of nonzero elements in a row
+  std::size_t getMaxRowLength() const ;
+/// Divide the rows in nparts contiguous blocks with approximately the same number of nonzero elements.
+/// The rows of block p are from starts[p] to starts[p+1]-1
+  void partitionRows( unsigned nparts, std::vector<std::size_t>& starts ) const ;
+/// Calculate the transpose of this matrix.
+/// If origin is given, origin[k] is the position in this matrix of the k-th element of the transpose
+  void transpose( CSRMatrix& t, std::vector<std::size_t>* origin=nullptr ) const ;
+/// Get the positions of the nonzero elements of A B, without calculating their values.
+/// The columns in each row of C are in increasing order and all the values of C are zero
+  void multiplyPattern( const CSRMatrix& b, CSRMatrix& c, unsigned nt=0 ) const ;
+};
+
+}
+
+#endif
@@ -346,6 +346,17 @@ bool Communicator::initialized() {
   return false;
 }
 
+bool Communicator::threadMultiple() {
+#if defined(__PLUMED_HAS_MPI)
+  if(initialized()) {
+    int provided=MPI_THREAD_SINGLE;
+    MPI_Query_thread(&provided);
+    return provided==MPI_THREAD_MULTIPLE;
+  }
+#endif
+  return true;
+}
+
 void Communicator::Request::wait(Status&s) {
 #ifdef __PLUMED_HAS_MPI
   plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
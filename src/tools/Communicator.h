@@ -211,6 +211,9 @@ public:
   void Barrier()const;
 /// Tests if MPI library is initialized
   static bool initialized();
+/// Tests if MPI functions can be called at the same time from different threads.
+/// This is always true if MPI library is not initialized
+  static bool threadMultiple();
 /// Wrapper for MPI_Allreduce with MPI_SUM (data struct)
   void Sum(Data);
 /// Wrapper for MPI_Allreduce with MPI_SUM (pointer)
@@ -39,6 +39,10 @@
 
 namespace PLMD {
 
+const char FileBase::binaryMagic[]="PLMDCOLS";
+
+const unsigned FileBase::binaryVersion=1;
+
 FileBase& FileBase::link(FILE*newfp) {
   plumed_massert(!fp,"cannot link an already open file");
   fp=newfp;
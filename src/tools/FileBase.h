@@ -77,6 +77,10 @@ protected:
   std::string mode;
 /// Set to true if you want flush to be heavy (close/reopen)
   bool heavyFlush;
+/// The header of binary fielded files starts with these 8 characters
+  static const char binaryMagic[];
+/// Version of the format of binary fielded files
+  static const unsigned binaryVersion;
 public:
 /// Append suffix.
 /// It appends the desired suffix to the string. Notice that
@@ -106,7 +110,8 @@ public:
   virtual FileBase& flush();
 /// Closes the file
 /// Should be used only for explicitely opened files.
-  void        close();
+/// It is virtual so that OFile can write what it keeps in memory before the file is closed.
+  virtual void close();
 /// Virtual destructor (allows inheritance)
   virtual ~FileBase();
 /// Check for error/eof.
@@ -25,8 +25,11 @@
 #include "core/PlumedMain.h"
 #include "core/Value.h"
 #include "Tools.h"
+#include <algorithm>
 #include <cstdarg>
+#include <cstdio>
 #include <cstring>
+#include <cstdint>
 #include <cmath>
 
 #include <iostream>
@@ -39,6 +42,17 @@ namespace PLMD {
 
 size_t IFile::llread(char*ptr,size_t s) {
   plumed_assert(fp);
+  // the characters that were read when the file was opened come first
+  const size_t npushed=std::min(s,pushedBack.size());
+  if(npushed>0) {
+    std::memcpy(ptr,pushedBack.data(),npushed);
+    pushedBack.erase(0,npushed);
+    if(npushed==s) {
+      return s;
+    }
+    ptr+=npushed;
+    s-=npushed;
+  }
   size_t r;
   if(gzfp) {
 #ifdef __PLUMED_HAS_ZLIB
@@ -62,11 +76,15 @@ size_t IFile::llread(char*ptr,size_t s) {
       err=true;
     }
   }
-  return r;
+  return npushed+r;
 }
 
 IFile& IFile::advanceField() {
   plumed_assert(!inMiddleOfField);
+  if(binary_) {
+    advanceBinaryField();
+    return *this;
+  }
   std::string line;
   bool done=false;
   while(!done) {
@@ -133,12 +151,150 @@ IFile& IFile::open(const std::string&mypath) {
     plumed_merror("file " + getPath() + ": trying to use a gz file without zlib being linked");
 #endif
   }
+  // binary files written by OFile are recognized from the first characters,
+  // which are then given back so that also files that cannot be rewound (e.g. pipes) can be read
+  binary_=false;
+  pushedBack.clear();
+  char magic[8];
+  const std::size_t nmagic=llread(magic,8);
+  if(nmagic==8 && std::memcmp(magic,binaryMagic,8)==0) {
+    binary_=true;
+    binaryRecordSize=0;
+    binaryRecordsStart=-1;
+  }
+  pushedBack.assign(magic,std::min<std::size_t>(nmagic,8));
+  eof=false;
+  err=false;
   if(plumed) {
     plumed->insertFile(*this);
   }
   return *this;
 }
 
+long IFile::tell() {
+  if(gzfp) {
+#ifdef __PLUMED_HAS_ZLIB
+    return gztell(gzFile(gzfp))-pushedBack.size();
+#endif
+  }
+  return std::ftell(fp)-pushedBack.size();
+}
+
+void IFile::seek(long pos) {
+  pushedBack.clear();
+  if(gzfp) {
+#ifdef __PLUMED_HAS_ZLIB
+    // this is slow when going backward, as the file has to be decompressed from the beginning
+    gzseek(gzFile(gzfp),pos,SEEK_SET);
+#endif
+  } else {
+    std::fseek(fp,pos,SEEK_SET);
+  }
+}
+
+void IFile::binaryRead(void*ptr,std::size_t n) {
+  if(llread(static_cast<char*>(ptr),n)!=n) {
+    plumed_merror("file " + getPath() + ": binary file is truncated or corrupted");
+  }
+}
+
+void IFile::readBinaryHeader() {
+  // the format is described in OFile::printBinaryFields()
+  char magic[8];
+  magic[0]=binaryMagic[0];
+  binaryRead(magic+1,7);
+  if(std::memcmp(magic,binaryMagic,8)!=0) {
+    plumed_merror("file " + getPath() + ": binary file is corrupted");
+  }
+  auto readUnsigned=[this]() {
+    std::uint32_t u;
+    binaryRead(&u,sizeof(u));
+    return u;
+  };
+  auto readString=[this,&readUnsigned]() {
+    std::string str(readUnsigned(),' ');
+    if(str.length()>0) {
+      binaryRead(&str[0],str.length());
+    }
+    return str;
+  };
+  const unsigned version=readUnsigned();
+  if(version!=binaryVersion) {
+    plumed_merror("file " + getPath() + ": unknown version of the binary format");
+  }
+  const unsigned nfields=readUnsigned();
+  const unsigned nconst=readUnsigned();
+  fields.clear();
+  binaryColumns.clear();
+  for(unsigned i=0; i<nfields; i++) {
+    Field field;
+    binaryRead(&field.type,1);
+    if(field.type!='d' && field.type!='i') {
+      plumed_merror("file " + getPath() + ": unknown type of field in binary file");
+    }
+    field.name=readString();
+    binaryColumns.push_back(fields.size());
+    fields.push_back(field);
+  }
+  for(unsigned i=0; i<nconst; i++) {
+    Field field;
+    field.name=readString();
+    field.value=readString();
+    field.constant=true;
+    fields.push_back(field);
+  }
+  binaryRecordSize=1+8*nfields;
+  // this is negative for files that cannot be rewound, which can still be read sequentially
+  binaryRecordsStart=tell();
+}
+
+void IFile::advanceBinaryField() {
+  while(true) {
+    char tag;
+    if(llread(&tag,1)!=1) {
+      eof=true;
+      return;
+    }
+    if(tag==binaryMagic[0]) {
+      readBinaryHeader();
+    } else if(tag=='R' && binaryRecordSize>0) {
+      binaryRecord.resize(binaryRecordSize-1);
+      binaryRead(binaryRecord.data(),binaryRecord.size());
+      const char* p=binaryRecord.data();
+      for(const auto i : binaryColumns) {
+        Field& f(fields[i]);
+        if(f.type=='i') {
+          std::memcpy(&f.integer,p,8);
+          f.number=f.integer;
+        } else {
+          std::memcpy(&f.number,p,8);
+        }
+        f.read=false;
+        p+=8;
+      }
+      inMiddleOfField=true;
+      return;
+    } else {
+      plumed_merror("file " + getPath() + ": binary file is corrupted");
+    }
+  }
+}
+
+IFile& IFile::seekFrame(std::size_t frame) {
+  plumed_massert(binary_,"file " + getPath() + ": only binary files can be accessed by frame");
+  if(binaryRecordSize==0) {
+    // the first header has not been read yet
+    advanceBinaryField();
+    plumed_massert(binaryRecordSize>0,"file " + getPath() + ": binary file without header");
+  }
+  plumed_massert(binaryRecordsStart>=0,"file " + getPath() + ": cannot access by frame a file that cannot be rewound");
+  inMiddleOfField=false;
+  eof=false;
+  err=false;
+  seek(binaryRecordsStart+frame*binaryRecordSize);
+  return *this;
+}
+
 IFile& IFile::scanFieldList(std::vector<std::string>&s) {
   if(!inMiddleOfField) {
     advanceField();
@@ -174,12 +330,36 @@ IFile& IFile::scanField(const std::string&name,std::string&str) {
     return *this;
   }
   unsigned i=findField(name);
-  str=fields[i].value;
+  if(fields[i].type=='i') {
+    str=std::to_string(fields[i].integer);
+  } else if(fields[i].type=='d') {
+    // enough digits to get back the same double
+    char buffer[32];
+    std::snprintf(buffer,sizeof(buffer),"%.17g",fields[i].number);
+    str=buffer;
+  } else {
+    str=fields[i].value;
+  }
   fields[i].read=true;
   return *this;
 }
 
 IFile& IFile::scanField(const std::string&name,double &x) {
+  if(binary_) {
+    if(!inMiddleOfField) {
+      advanceField();
+    }
+    if(!bool(*this)) {
+      return *this;
+    }
+    // numbers in binary files do not need any conversion
+    unsigned i=findField(name);
+    if(fields[i].type!=0) {
+      x=fields[i].number;
+      fields[i].read=true;
+      return *this;
+    }
+  }
   std::string str;
   scanField(name,str);
   if(*this) {
@@ -270,7 +450,10 @@ IFile& IFile::scanField() {
 IFile::IFile():
   inMiddleOfField(false),
   ignoreFields(false),
-  noEOL(false) {
+  noEOL(false),
+  binary_(false),
+  binaryRecordSize(0),
+  binaryRecordsStart(-1) {
 }
 
 IFile::~IFile() {
@@ -284,6 +467,7 @@ IFile& IFile::getline(std::string &str) {
   str="";
   fpos_t pos;
   fgetpos(fp,&pos);
+  const std::string pushed=pushedBack;
   while(llread(&tmp,1)==1 && tmp && tmp!='\n' && tmp!='\r' && !eof && !err) {
     str+=tmp;
   }
@@ -300,6 +484,7 @@ IFile& IFile::getline(std::string &str) {
     str="";
     if(!err) {
       fsetpos(fp,&pos);
+      pushedBack=pushed;
     }
 // there was a fsetpos here that apparently is not necessary
 //  fsetpos(fp,&pos);
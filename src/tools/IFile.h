@@ -46,6 +46,11 @@ class IFile:
   struct Field:
     public FieldBase {
     bool read=false;
+/// Type of the field in binary files ('d' for double, 'i' for integers), 0 for text
+    char type=0;
+/// Value of the field in binary files
+    double number=0.0;
+    long long int integer=0;
   };
 /// Low-level read.
 /// Note: in parallel, all processes read
@@ -60,6 +65,26 @@ class IFile:
   bool noEOL;
 /// Advance to next field (= read one line)
   IFile& advanceField();
+/// True if the file was written by OFile in binary format
+  bool binary_;
+/// For binary files, the index in fields of each column of the records
+  std::vector<unsigned> binaryColumns;
+/// For binary files, the size of each record (0 before the first header) and the position of the first record after the last header
+  std::size_t binaryRecordSize;
+  long binaryRecordsStart;
+/// Internal buffer for binary records
+  std::vector<char> binaryRecord;
+/// Characters that were read to recognize binary files and that have to be read again
+  std::string pushedBack;
+/// Read a binary header or record
+  void advanceBinaryField();
+/// Read a binary header
+  void readBinaryHeader();
+/// Read exactly n bytes, or report an error
+  void binaryRead(void*,std::size_t);
+/// Position in the uncompressed file
+  long tell();
+  void seek(long);
 /// Find field index by name
   unsigned findField(const std::string&name)const;
 public:
@@ -106,6 +131,14 @@ public:
   IFile& scanField(Value* val);
 /// Allow some of the fields in the input to be ignored
   void allowIgnoredFields();
+/// Check if the file is a binary file written by OFile
+  bool isBinaryFormat() const {
+    return binary_;
+  }
+/// Move to a given record of a binary file, counting from the last header that has been read.
+/// The following call to scanField() will read this record. The records after a header all have
+/// the same length, so this does not need to read the records before it.
+  IFile& seekFrame(std::size_t);
 /// Allow files without EOL at the end.
 /// This in practice should be only used when opening
 /// plumed input files
@@ -0,0 +1,153 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "KernelTree.h"
+#include "Exception.h"
+#include <numeric>
+
+namespace PLMD {
+
+constexpr std::size_t KernelTree::npos;
+
+KernelTree::KernelTree( unsigned dim, std::size_t fold ):
+  dimension(dim),
+  foldSize(fold) {
+  plumed_massert( dimension>0, "kernel tree needs at least one dimension" );
+}
+
+void KernelTree::add( View<const double> center, View<const double> halfwidth ) {
+  plumed_dbg_assert( center.size()==dimension && halfwidth.size()==dimension );
+  centers.insert( centers.end(), center.begin(), center.end() );
+  widths.insert( widths.end(), halfwidth.begin(), halfwidth.end() );
+  slot.push_back( npos );
+  pending.push_back( size()-1 );
+  if( getNumberOfPending()>foldSize ) {
+    build();
+  }
+}
+
+void KernelTree::set( std::size_t i, View<const double> center, View<const double> halfwidth ) {
+  plumed_dbg_assert( i<size() && center.size()==dimension && halfwidth.size()==dimension );
+  std::copy( center.begin(), center.end(), centers.begin()+i*dimension );
+  std::copy( halfwidth.begin(), halfwidth.end(), widths.begin()+i*dimension );
+  // the bounds of the nodes that contain the kernel are not valid anymore, so it becomes pending
+  if( slot[i]!=npos ) {
+    order[slot[i]]=npos;
+    slot[i]=npos;
+    pending.push_back( i );
+    if( getNumberOfPending()>foldSize ) {
+      build();
+    }
+  }
+}
+
+void KernelTree::remove( std::size_t i ) {
+  plumed_dbg_assert( i<size() );
+  if( slot[i]!=npos ) {
+    order[slot[i]]=npos;
+  } else {
+    pending.erase( std::find( pending.begin(), pending.end(), i ) );
+  }
+  centers.erase( centers.begin()+i*dimension, centers.begin()+(i+1)*dimension );
+  widths.erase( widths.begin()+i*dimension, widths.begin()+(i+1)*dimension );
+  slot.erase( slot.begin()+i );
+  // the bounds of the nodes are still valid, only the indices change
+  for(auto & k : order) {
+    if( k!=npos && k>i ) {
+      k--;
+    }
+  }
+  for(auto & k : pending) {
+    if( k>i ) {
+      k--;
+    }
+  }
+}
+
+void KernelTree::clear() {
+  centers.clear();
+  widths.clear();
+  order.clear();
+  slot.clear();
+  pending.clear();
+  nodes.clear();
+  lower.clear();
+  upper.clear();
+  maxwidth.clear();
+}
+
+void KernelTree::build() {
+  order.resize( size() );
+  std::iota( order.begin(), order.end(), 0 );
+  pending.clear();
+  nodes.clear();
+  lower.clear();
+  upper.clear();
+  maxwidth.clear();
+  if( size()>0 ) {
+    buildNode( 0, size() );
+  }
+  for(std::size_t k=0; k<order.size(); ++k) {
+    slot[order[k]]=k;
+  }
+}
+
+std::size_t KernelTree::buildNode( std::size_t begin, std::size_t end ) {
+  const std::size_t n=nodes.size();
+  nodes.push_back( {begin,end,0,0} );
+  lower.resize( lower.size()+dimension, 0.0 );
+  upper.resize( upper.size()+dimension, 0.0 );
+  maxwidth.resize( maxwidth.size()+dimension, 0.0 );
+  for(unsigned j=0; j<dimension; ++j) {
+    double lo=centers[order[begin]*dimension+j], hi=lo, w=0.0;
+    for(std::size_t k=begin; k<end; ++k) {
+      const std::size_t i=order[k];
+      lo=std::min( lo, centers[i*dimension+j] );
+      hi=std::max( hi, centers[i*dimension+j] );
+      w=std::max( w, widths[i*dimension+j] );
+    }
+    lower[n*dimension+j]=lo;
+    upper[n*dimension+j]=hi;
+    maxwidth[n*dimension+j]=w;
+  }
+  if( end-begin<=leafSize ) {
+    return n;
+  }
+  // the kernels are divided at the median of the dimension in which their centers are most spread
+  unsigned split=0;
+  for(unsigned j=1; j<dimension; ++j) {
+    if( upper[n*dimension+j]-lower[n*dimension+j]>upper[n*dimension+split]-lower[n*dimension+split] ) {
+      split=j;
+    }
+  }
+  const std::size_t middle=begin+(end-begin)/2;
+  std::nth_element( order.begin()+begin, order.begin()+middle, order.begin()+end,
+  [this,split]( std::size_t a, std::size_t b ) {
+    return centers[a*dimension+split]<centers[b*dimension+split];
+  } );
+  const std::size_t left=buildNode( begin, middle );
+  const std::size_t right=buildNode( middle, end );
+  nodes[n].left=left;
+  nodes[n].right=right;
+  return n;
+}
+
+}
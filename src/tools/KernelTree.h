@@ -0,0 +1,165 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_KernelTree_h
+#define __PLUMED_tools_KernelTree_h
+
+#include "View.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+A kd-tree over the supports of a set of kernels.
+
+Each kernel is described by its center and by the half widths of the box that
+contains its support.  getKernelsAt() finds the kernels whose box contains a point
+by descending only in the nodes of the tree whose kernels can be close enough to the point,
+so the cost of a search grows with the logarithm of the number of kernels rather than linearly.
+
+Kernels are added to a flat list of pending kernels that are always returned by the searches.
+When this list contains more than the fold size kernels, the tree is rebuilt with all the kernels.
+The cost of building the tree is thus divided between many additions.  Kernels that are
+changed are taken out of the tree and moved to the pending list, so that kernels can be
+merged or removed without rebuilding the tree every time.
+
+The widths can be multiplied by a factor when searching, so the same tree can be used
+to find the kernels that are within different distances from a point.
+
+The searches take a function with the same arguments as ActionWithArguments::difference(), so
+that periodic variables are dealt with correctly:
+
+\verbatim
+tree.getKernelsAt( x, [this](unsigned i, double a, double b) {
+  return difference(i,a,b);
+}, found );
+\endverbatim
+*/
+class KernelTree {
+private:
+/// The maximum number of kernels in a leaf
+  static constexpr std::size_t leafSize=8;
+/// A node of the tree contains the kernels order[begin] ... order[end-1]
+  struct Node {
+    std::size_t begin;
+    std::size_t end;
+    std::size_t left;
+    std::size_t right;
+  };
+/// The number of dimensions
+  unsigned dimension;
+/// The number of pending kernels after which the tree is rebuilt
+  std::size_t foldSize;
+/// The centers and the half widths of the kernels
+  std::vector<double> centers;
+  std::vector<double> widths;
+/// The kernels in the order of the tree.  Kernels that have been taken out of the tree are replaced by npos
+  std::vector<std::size_t> order;
+/// The position of each kernel in order, or npos if the kernel is pending
+  std::vector<std::size_t> slot;
+/// The kernels that are not in the tree
+  std::vector<std::size_t> pending;
+/// The nodes.  The first node is the root and leaves have left==0
+  std::vector<Node> nodes;
+/// The range of the centers and the largest half width in each node
+  std::vector<double> lower;
+  std::vector<double> upper;
+  std::vector<double> maxwidth;
+/// Build the node that contains the kernels order[begin] ... order[end-1] and its children
+  std::size_t buildNode( std::size_t begin, std::size_t end );
+public:
+/// The index of kernels that are not in the tree
+  static constexpr std::size_t npos=static_cast<std::size_t>(-1);
+  KernelTree( unsigned dimension, std::size_t foldSize );
+/// Add a kernel.  Its index is the number of kernels that were added before it
+  void add( View<const double> center, View<const double> halfwidth );
+/// Change the center and the half widths of kernel i
+  void set( std::size_t i, View<const double> center, View<const double> halfwidth );
+/// Remove kernel i.  The indices of the following kernels decrease by one
+  void remove( std::size_t i );
+/// Remove all the kernels
+  void clear();
+/// Build the tree with all the kernels
+  void build();
+/// Get the number of kernels
+  std::size_t size() const {
+    return centers.size()/dimension;
+  }
+/// Get the number of kernels that are not in the tree yet
+  std::size_t getNumberOfPending() const {
+    return pending.size();
+  }
+/// Get the indices of the kernels whose support, with the half widths multiplied by scale, can contain x.
+/// The indices are in increasing order
+  template<typename Difference>
+  void getKernelsAt( View<const double> x, Difference diff, std::vector<std::size_t>& found, double scale=1.0 ) const ;
+};
+
+template<typename Difference>
+void KernelTree::getKernelsAt( View<const double> x, Difference diff, std::vector<std::size_t>& found, double scale ) const {
+  found.clear();
+  // the distance between x and the box with the centers of the kernels in a dimension
+  auto gap=[&]( unsigned j, double lo, double hi ) {
+    if( x[j]>=lo && x[j]<=hi ) {
+      return 0.0;
+    }
+    return std::min( std::fabs( diff( j, x[j], lo ) ), std::fabs( diff( j, x[j], hi ) ) );
+  };
+  if( !nodes.empty() ) {
+    std::vector<std::size_t> stack(1,0);
+    while( !stack.empty() ) {
+      const std::size_t n=stack.back();
+      stack.pop_back();
+      bool inside=true;
+      for(unsigned j=0; j<dimension && inside; ++j) {
+        inside=( gap( j, lower[n*dimension+j], upper[n*dimension+j] )<=scale*maxwidth[n*dimension+j] );
+      }
+      if( !inside ) {
+        continue;
+      }
+      if( nodes[n].left>0 ) {
+        stack.push_back( nodes[n].right );
+        stack.push_back( nodes[n].left );
+        continue;
+      }
+      for(std::size_t k=nodes[n].begin; k<nodes[n].end; ++k) {
+        const std::size_t i=order[k];
+        bool contains=( i!=npos );
+        for(unsigned j=0; j<dimension && contains; ++j) {
+          contains=( std::fabs( diff( j, x[j], centers[i*dimension+j] ) )<=scale*widths[i*dimension+j] );
+        }
+        if( contains ) {
+          found.push_back( i );
+        }
+      }
+    }
+  }
+  found.insert( found.end(), pending.begin(), pending.end() );
+  std::sort( found.begin(), found.end() );
+}
+
+}
+
+#endif
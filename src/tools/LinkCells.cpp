@@ -26,6 +26,7 @@
 #include "Tools.h"
 #include "View.h"
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <numeric>
 #include <vector>
@@ -119,6 +120,31 @@ void LinkCells::createCells(const PLMD::Tensor& box) {
   nstride[0]=1;
   nstride[1]=ncells[0];
   nstride[2]=ncells[0]*ncells[1];
+
+  // Sort the cells along a Morton curve, by interleaving the bits of the three cell coordinates
+  if( cellOrderLimits!=ncells ) {
+    const unsigned ncellstot=getNumberOfCells();
+    auto morton = [this]( const unsigned cellIndex ) {
+      const auto coord=findMyCell( cellIndex );
+      std::uint64_t key=0;
+      for(unsigned bit=0; bit<21; ++bit) {
+        for(unsigned k=0; k<3; ++k) {
+          key |= static_cast<std::uint64_t>( (coord[k]>>bit) & 1u ) << (3*bit+k);
+        }
+      }
+      return key;
+    };
+    std::vector<std::uint64_t> keys( ncellstot );
+    for(unsigned i=0; i<ncellstot; ++i) {
+      keys[i]=morton(i);
+    }
+    cellOrder.resize( ncellstot );
+    std::iota( cellOrder.begin(), cellOrder.end(), 0 );
+    std::sort( cellOrder.begin(), cellOrder.end(), [&keys]( unsigned a, unsigned b ) {
+      return keys[a]<keys[b];
+    } );
+    cellOrderLimits=ncells;
+  }
 }
 
 void LinkCells::buildCellLists( View<const Vector> pos,
@@ -163,9 +189,9 @@ void LinkCells::resetCollection(LinkCells::CellCollection &collection,
   comm.Sum( allcells );
   comm.Sum( collection.lcell_tots );
 
-  // Now prepare the link cell lists
+  // Now prepare the link cell lists, the cells are stored along the Morton curve
   unsigned tot=0;
-  for(unsigned i=0; i<collection.lcell_tots.size(); ++i) {
+  for(const unsigned i : cellOrder) {
     collection.lcell_starts[i]=tot;
     tot+=collection.lcell_tots[i];
     collection.lcell_tots[i]=0;
@@ -173,9 +199,11 @@ void LinkCells::resetCollection(LinkCells::CellCollection &collection,
   plumed_assert( tot==nat ) <<"Total number of atoms found in link cells is "<<tot<<" number of atoms is "<<nat;
 
   // And setup the link cells properly
+  collection.lcell_positions.resize( nat );
   for(unsigned j=0; j<nat; ++j) {
     unsigned myind = collection.lcell_starts[ allcells[j] ] + collection.lcell_tots[ allcells[j] ];
     collection.lcell_lists[ myind ] = indices[j];
+    collection.lcell_positions[ myind ] = pos[j];
     collection.lcell_tots[allcells[j]]++;
   }
 }
@@ -344,7 +372,10 @@ void LinkCells::createNeighborList( unsigned nat,
   nlist.resize( nlist_sz );
   std::vector<unsigned> indices( 1+natoms_per_list );
   std::vector<unsigned> cells_required( getNumberOfCells() );
-  for(unsigned i=0; i<pos.size(); ++i) {
+  // the central atoms are visited in cell order, so that consecutive atoms look at the same cells
+  std::vector<unsigned> order;
+  getSpatialOrder( pos, order );
+  for(const unsigned i : order) {
     unsigned ncells_required=0;
     addRequiredCells( findMyCell( pos[i] ), ncells_required, cells_required );
     unsigned natoms=1;
@@ -362,6 +393,27 @@ void LinkCells::createNeighborList( unsigned nat,
   }
 }
 
+void LinkCells::getSpatialOrder( View<const Vector> pos, std::vector<unsigned>& order ) {
+  const unsigned ncellstot=getNumberOfCells();
+  // the position of each cell along the Morton curve
+  std::vector<unsigned> rank( ncellstot );
+  for(unsigned i=0; i<ncellstot; ++i) {
+    rank[ cellOrder[i] ]=i;
+  }
+  // a counting sort of the atoms on the rank of their cell, the atoms in the same cell keep their order
+  std::vector<unsigned> atomrank( pos.size() );
+  std::vector<unsigned> start( ncellstot+1, 0 );
+  for(unsigned i=0; i<pos.size(); ++i) {
+    atomrank[i]=rank[ findCell( pos[i] ) ];
+    start[ atomrank[i]+1 ]++;
+  }
+  std::partial_sum( start.begin(), start.end(), start.begin() );
+  order.resize( pos.size() );
+  for(unsigned i=0; i<pos.size(); ++i) {
+    order[ start[ atomrank[i] ]++ ]=i;
+  }
+}
+
 unsigned LinkCells::CellCollection::getMaximimumCombination(const unsigned numCells) const {
   //this is not efficient (there is a copy), but in principle it should be called not much times:
   //nth_element order by partition until the array is partially sorted
@@ -45,6 +45,8 @@ public:
     std::vector<unsigned> lcell_tots;
 /// The atoms ordered by link cells
     std::vector<unsigned> lcell_lists;
+/// The positions of the atoms in lcell_lists, so that the atoms in the same cell are contiguous in memory
+    std::vector<Vector> lcell_positions;
     ///return the sum of the number of atoms in the n cells with most atoms
     unsigned getMaximimumCombination(unsigned numCells=27) const;
     ///returns a const view of the on indexes the given cell
@@ -58,6 +60,10 @@ public:
       // and should be ignored by the size passed being 0
       //return {&lcell_lists[lcell_starts[cellno]],lcell_tots[cellno]};
     }
+    ///returns a const view on the positions of the atoms in the given cell, in the same order of getCellIndexes()
+    inline View<const Vector> getCellPositions(const unsigned cellno) const {
+      return {lcell_positions.data()+lcell_starts[cellno],lcell_tots[cellno]};
+    }
   };
 private:
 /// Symbolic link to plumed communicator
@@ -78,6 +84,11 @@ private:
   std::array<unsigned,3> nstride{1,0,0};
 /// Work vector with the list of cells each atom is inside
   std::vector<unsigned> allcells;
+/// The cells sorted along a Morton (Z-order) curve.
+/// The atoms are stored in the collections in this order, so that cells that are close in space are also close in memory
+  std::vector<unsigned> cellOrder;
+/// The number of cells per dimension for which cellOrder was computed
+  std::array<unsigned,3> cellOrderLimits{0,0,0};
 ///The collection of indexes per cell created by buildCellLists
   CellCollection innerCollection;
   void createCells(const PLMD::Tensor&);
@@ -140,6 +151,14 @@ public:
     return getCollection(make_const_view(pos),
                          make_const_view(indices));
   }
+/// Get the order in which the positions should be visited so that the atoms in the same cell,
+/// and then the cells that are close in space, are visited one after the other.
+/// order[k] is the index in pos of the k-th atom to visit, needs setupCells to be launched in advance
+  void getSpatialOrder( View<const Vector> pos, std::vector<unsigned>& order );
+/// Get the cells in the order in which they are stored in the collections
+  const std::vector<unsigned>& getCellOrder() const {
+    return cellOrder;
+  }
 /// Take three indices and return the index of the corresponding cell
   unsigned convertIndicesToIndex( std::array<unsigned,3> cellCoord) const;
 /// Find the cell index in which this position is contained
@@ -49,10 +49,11 @@ NeighborList::NeighborList(const std::vector<AtomNumber>& list0,
                            Communicator& cm,
                            const double distance,
                            const unsigned stride,
-                           const bool doCells)
+                           const bool doCells,
+                           const double skin)
   : serial_(serial),
     do_pbc_(do_pbc),
-    useCellList_(doCells),
+    useCellList_(doCells || skin>0.0),
     style_(do_pair ? NNStyle::Pair : NNStyle::TwoList),
     pbc_(&pbc),
     comm(cm),
@@ -61,7 +62,8 @@ NeighborList::NeighborList(const std::vector<AtomNumber>& list0,
     distance_(distance),
     nlist0_(list0.size()),
     nlist1_(list1.size()),
-    stride_(stride) {
+    stride_(stride),
+    skin_(skin) {
   // store the rest of the atoms into fullatomlist_
   fullatomlist_.insert(fullatomlist_.end(),list1.begin(),list1.end());
   if(style_ != NNStyle::Pair) {
@@ -84,10 +86,11 @@ NeighborList::NeighborList(const std::vector<AtomNumber>& list0,
                            Communicator& cm,
                            const double distance,
                            const unsigned stride,
-                           const bool doCells)
+                           const bool doCells,
+                           const double skin)
   : serial_(serial),
     do_pbc_(do_pbc),
-    useCellList_(doCells),
+    useCellList_(doCells || skin>0.0),
     style_(NNStyle::SingleList),
     pbc_(&pbc),
     comm(cm),
@@ -96,13 +99,16 @@ NeighborList::NeighborList(const std::vector<AtomNumber>& list0,
     distance_(distance),
     nlist0_(list0.size()),
     nallpairs_(nlist0_*(nlist0_-1)/2),
-    stride_(stride) {
+    stride_(stride),
+    skin_(skin) {
   initialize();
 }
 
 NeighborList::~NeighborList()=default;
 
 void NeighborList::initialize() {
+  plumed_assert(skin_==0.0 || stride_==1) << "a neighbor list with a skin should be updated at every step";
+  plumed_assert(skin_<distance_) << "the skin of the neighbor list should be smaller than its cutoff";
   constexpr const char* envKey="PLUMED_IGNORE_NL_MEMORY_ERROR";
   //this checks the upper limit of the memory
   if(!std::getenv(envKey)) {
@@ -166,151 +172,208 @@ NeighborList::pairIDs NeighborList::getIndexPair(const unsigned ipair) const {
 }
 
 void NeighborList::update(const std::vector<Vector>& positions) {
-  neighbors_.clear();
   // check if positions array has the correct length
   plumed_assert(positions.size()==fullatomlist_.size());
-
-#ifdef _OPENMP
-  //nt is unused if openmp is not declared
   const unsigned nt=(serial_)? 1 : OpenMP::getNumThreads();
-#endif //_OPENMP
+  ++nupdates_;
+  if(skin_>0.0) {
+    // the list built with the cutoff is still valid if no atom moved more than half of the skin
+    if(reference_positions_.size()==positions.size() && !skinIsExceeded(positions,nt)) {
+      return;
+    }
+    reference_positions_=positions;
+  }
+  ++nrebuilds_;
+  neighbors_.clear();
   if(useCellList_) {
-    std::vector<unsigned> indexesForCells(fullatomlist_.size());
-    std::iota(indexesForCells.begin(),indexesForCells.end(),0);
-    LinkCells cells(comm);
-    cells.setCutoff(distance_);
-    cells.setupCells(make_const_view(positions),*pbc_);
-
-    switch (style_) {
-    case NNStyle::TwoList: {
-      auto listA = cells.getCollection(View{positions.data(),nlist0_},
-                                       View<const unsigned> {indexesForCells.data(),nlist0_});
-      auto listB = cells.getCollection(View{positions.data()+nlist0_,nlist1_},
-                                       View<const unsigned> {indexesForCells.data()+nlist0_,nlist1_});
-      plumed_assert((listA.lcell_lists.size()+listB.lcell_lists.size()) == positions.size())
-          << listA.lcell_lists.size()<<"+"<<listB.lcell_lists.size() <<"==" <<positions.size();
-      //#pragma omp parallel num_threads(nt)
-      std::vector<unsigned> cells_required(27);
-      for(unsigned c =0; c < cells.getNumberOfCells(); ++c) {
-        auto atomsInC= listA.getCellIndexes(c);
-        if(atomsInC.size()>0) {
-          auto cell = cells.findMyCell(c);
-          unsigned ncells_required=0;
-          cells.addRequiredCells(cell,ncells_required, cells_required,do_pbc_);
-          for (auto A : atomsInC) {
-            for (unsigned cb=0; cb <ncells_required ; ++cb) {
-              for (auto B : listB.getCellIndexes(cells_required[cb])) {
-                neighbors_.push_back({A,B});
-              }
-            }
-          }
-        }
-      }
+    buildWithCells(positions,nt);
+  } else {
+    buildWithAllPairs(positions,nt);
+  }
+  listBuilded=true;
+  if (stride_ >1) {
+    setRequestList();
+  } else {
+    reduced=true;
+  }
+}
+
+bool NeighborList::skinIsExceeded(const std::vector<Vector>& positions, const unsigned nt) const {
+  const double maxdisp2=0.25*skin_*skin_;
+  bool exceeded=false;
+  #pragma omp parallel for num_threads(nt) reduction(||:exceeded)
+  for(unsigned i=0; i<positions.size(); ++i) {
+    Vector displacement;
+    if(do_pbc_) {
+      displacement=pbc_->distance(reference_positions_[i],positions[i]);
+    } else {
+      displacement=delta(reference_positions_[i],positions[i]);
     }
-    break;//*/
-    case NNStyle::SingleList: {
-      auto listA = cells.getCollection(positions,indexesForCells);
-      //#pragma omp parallel num_threads(nt)
-      std::vector<unsigned> cells_required(27);
-      for(unsigned c =0; c < cells.getNumberOfCells(); ++c) {
-        auto atomsInC= listA.getCellIndexes(c);
-        if(atomsInC.size()>0) {
-          auto cell = cells.findMyCell(c);
-          unsigned ncells_required=0;
-          cells.addRequiredCells(cell,ncells_required, cells_required,do_pbc_);
-          for (auto A : atomsInC) {
-            for (unsigned cb=0; cb <ncells_required ; ++cb) {
-              for (auto B : listA.getCellIndexes(cells_required[cb])) {
-                if (B>A) {
-                  neighbors_.push_back({A,B});
-                }
-              }
+    exceeded = exceeded || modulo2(displacement)>maxdisp2;
+  }
+  return exceeded;
+}
+
+void NeighborList::buildWithCells(const std::vector<Vector>& positions, const unsigned nt) {
+  std::vector<unsigned> indexesForCells(fullatomlist_.size());
+  std::iota(indexesForCells.begin(),indexesForCells.end(),0);
+  LinkCells cells(comm);
+  cells.setCutoff(distance_);
+  cells.setupCells(make_const_view(positions),*pbc_);
+
+  LinkCells::CellCollection listA, listB;
+  switch (style_) {
+  case NNStyle::TwoList:
+    listA = cells.getCollection(View{positions.data(),nlist0_},
+                                View<const unsigned> {indexesForCells.data(),nlist0_});
+    listB = cells.getCollection(View{positions.data()+nlist0_,nlist1_},
+                                View<const unsigned> {indexesForCells.data()+nlist0_,nlist1_});
+    plumed_assert((listA.lcell_lists.size()+listB.lcell_lists.size()) == positions.size())
+        << listA.lcell_lists.size()<<"+"<<listB.lcell_lists.size() <<"==" <<positions.size();
+    break;
+  case NNStyle::SingleList:
+    listA = cells.getCollection(positions,indexesForCells);
+    break;
+  case NNStyle::Pair:
+    plumed_error() << "Cell list should not be active with a Pair NL";
+  }
+  const bool singleList = (style_==NNStyle::SingleList);
+  const LinkCells::CellCollection& neighborsOfA = singleList ? listA : listB;
+  const double d2=distance_*distance_;
+
+  // the cells are divided in contiguous blocks between the ranks and the threads,
+  // so that the pairs can be merged in the same order that a serial loop would give
+  const unsigned stride=(serial_)? 1 : comm.Get_size();
+  const unsigned rank  =(serial_)? 0 : comm.Get_rank();
+  const unsigned ncells=cells.getNumberOfCells();
+  const unsigned cellsPerRank = (ncells+stride-1)/stride;
+  const unsigned start = std::min(rank*cellsPerRank,ncells);
+  const unsigned end = std::min(start+cellsPerRank,ncells);
+  std::vector<std::vector<unsigned>> thread_flat_nl(nt);
+
+  // the cells are visited in the order in which they are stored (a Morton curve) and
+  // the positions are read from the copies in the collections, which are sorted by cell
+  const auto & cellOrder=cells.getCellOrder();
+
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<unsigned>& private_flat_nl=thread_flat_nl[OpenMP::getThreadNum()];
+    std::vector<unsigned> cells_required(27);
+    #pragma omp for schedule(static) nowait
+    for(unsigned ic=start; ic<end; ++ic) {
+      const unsigned c=cellOrder[ic];
+      auto atomsInC= listA.getCellIndexes(c);
+      if(atomsInC.size()==0) {
+        continue;
+      }
+      auto positionsInC= listA.getCellPositions(c);
+      auto cell = cells.findMyCell(c);
+      unsigned ncells_required=0;
+      cells.addRequiredCells(cell,ncells_required, cells_required,do_pbc_);
+      for (unsigned a=0; a<atomsInC.size(); ++a) {
+        const unsigned A=atomsInC[a];
+        for (unsigned cb=0; cb <ncells_required ; ++cb) {
+          auto atomsInB=neighborsOfA.getCellIndexes(cells_required[cb]);
+          auto positionsInB=neighborsOfA.getCellPositions(cells_required[cb]);
+          for (unsigned b=0; b<atomsInB.size(); ++b) {
+            const unsigned B=atomsInB[b];
+            if (singleList && B<=A) {
+              continue;
+            }
+            Vector distance;
+            if(do_pbc_) {
+              distance=pbc_->distance(positionsInC[a],positionsInB[b]);
+            } else {
+              distance=delta(positionsInC[a],positionsInB[b]);
+            }
+            if(modulo2(distance)<=d2) {
+              private_flat_nl.push_back(A);
+              private_flat_nl.push_back(B);
             }
           }
         }
       }
     }
-    break;
-    case NNStyle::Pair:
-      plumed_error() << "Cell list should not be active with a Pair NL";
-    }
-  } else {
-    const double d2=distance_*distance_;
-    // check if positions array has the correct length
-    plumed_assert(positions.size()==fullatomlist_.size());
-
-    const unsigned stride=(serial_)? 1 : comm.Get_size();
-    const unsigned rank  =(serial_)? 0 : comm.Get_rank();
-    const unsigned elementsPerRank = std::ceil(double(nallpairs_)/stride);
-    const unsigned int start= rank*elementsPerRank;
-    const unsigned int end = ((start + elementsPerRank)< nallpairs_)?(start + elementsPerRank): nallpairs_;
-    std::vector<unsigned> local_flat_nl;
-
-    #pragma omp parallel num_threads(nt)
-    {
-      std::vector<unsigned> private_flat_nl;
-      #pragma omp for nowait
-      for(unsigned int i=start; i<end; ++i) {
-        auto [index0, index1 ] = getIndexPair(i);
-        Vector distance;
-        if(do_pbc_) {
-          distance=pbc_->distance(positions[index0],positions[index1]);
-        } else {
-          distance=delta(positions[index0],positions[index1]);
-        }
-        double value=modulo2(distance);
-        if(value<=d2) {
-          private_flat_nl.push_back(index0);
-          private_flat_nl.push_back(index1);
-        }
-      }
-      #pragma omp critical
-      local_flat_nl.insert(local_flat_nl.end(),
-                           private_flat_nl.begin(),
-                           private_flat_nl.end());
-    }
+  }
+  std::vector<unsigned> local_flat_nl;
+  for(const auto & t : thread_flat_nl) {
+    local_flat_nl.insert(local_flat_nl.end(),t.begin(),t.end());
+  }
+  gatherNeighbors(local_flat_nl);
+}
 
-    // find total dimension of neighborlist
-    std::vector <int> local_nl_size(stride, 0);
-    local_nl_size[rank] = local_flat_nl.size();
-    if(!serial_) {
-      comm.Sum(&local_nl_size[0], stride);
-    }
-    int tot_size = std::accumulate(local_nl_size.begin(), local_nl_size.end(), 0);
-    if(tot_size!=0) {
-      // merge
-      std::vector<unsigned> merge_nl(tot_size, 0);
-      // calculate vector of displacement
-      std::vector<int> disp(stride);
-      disp[0] = 0;
-      int rank_size = 0;
-      for(unsigned i=0; i<stride-1; ++i) {
-        rank_size += local_nl_size[i];
-        disp[i+1] = rank_size;
-      }
-      // Allgather neighbor list
-      if(comm.initialized()&&!serial_) {
-        comm.Allgatherv((!local_flat_nl.empty()?&local_flat_nl[0]:NULL),
-                        local_nl_size[rank],
-                        &merge_nl[0],
-                        &local_nl_size[0],
-                        &disp[0]);
+void NeighborList::buildWithAllPairs(const std::vector<Vector>& positions, const unsigned nt) {
+  const double d2=distance_*distance_;
+  const unsigned stride=(serial_)? 1 : comm.Get_size();
+  const unsigned rank  =(serial_)? 0 : comm.Get_rank();
+  const unsigned elementsPerRank = std::ceil(double(nallpairs_)/stride);
+  const unsigned int start= rank*elementsPerRank;
+  const unsigned int end = ((start + elementsPerRank)< nallpairs_)?(start + elementsPerRank): nallpairs_;
+  std::vector<unsigned> local_flat_nl;
+
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<unsigned> private_flat_nl;
+    #pragma omp for nowait
+    for(unsigned int i=start; i<end; ++i) {
+      auto [index0, index1 ] = getIndexPair(i);
+      Vector distance;
+      if(do_pbc_) {
+        distance=pbc_->distance(positions[index0],positions[index1]);
       } else {
-        merge_nl = local_flat_nl;
+        distance=delta(positions[index0],positions[index1]);
       }
-      // resize neighbor stuff
-      neighbors_.resize(tot_size/2);
-      for(int i=0; i<tot_size/2; i++) {
-        unsigned j=2*i;
-        neighbors_[i] = std::make_pair(merge_nl[j],merge_nl[j+1]);
+      double value=modulo2(distance);
+      if(value<=d2) {
+        private_flat_nl.push_back(index0);
+        private_flat_nl.push_back(index1);
       }
     }
+    #pragma omp critical
+    local_flat_nl.insert(local_flat_nl.end(),
+                         private_flat_nl.begin(),
+                         private_flat_nl.end());
   }
-  listBuilded=true;
-  if (stride_ >1) {
-    setRequestList();
-  } else {
-    reduced=true;
+  gatherNeighbors(local_flat_nl);
+}
+
+void NeighborList::gatherNeighbors(const std::vector<unsigned>& local_flat_nl) {
+  const unsigned stride=(serial_)? 1 : comm.Get_size();
+  const unsigned rank  =(serial_)? 0 : comm.Get_rank();
+  // find total dimension of neighborlist
+  std::vector <int> local_nl_size(stride, 0);
+  local_nl_size[rank] = local_flat_nl.size();
+  if(!serial_) {
+    comm.Sum(&local_nl_size[0], stride);
+  }
+  int tot_size = std::accumulate(local_nl_size.begin(), local_nl_size.end(), 0);
+  if(tot_size!=0) {
+    // merge
+    std::vector<unsigned> merge_nl(tot_size, 0);
+    // calculate vector of displacement
+    std::vector<int> disp(stride);
+    disp[0] = 0;
+    int rank_size = 0;
+    for(unsigned i=0; i<stride-1; ++i) {
+      rank_size += local_nl_size[i];
+      disp[i+1] = rank_size;
+    }
+    // Allgather neighbor list
+    if(comm.initialized()&&!serial_) {
+      comm.Allgatherv((!local_flat_nl.empty()?&local_flat_nl[0]:NULL),
+                      local_nl_size[rank],
+                      &merge_nl[0],
+                      &local_nl_size[0],
+                      &disp[0]);
+    } else {
+      merge_nl = local_flat_nl;
+    }
+    // resize neighbor stuff
+    neighbors_.resize(tot_size/2);
+    for(int i=0; i<tot_size/2; i++) {
+      unsigned j=2*i;
+      neighbors_[i] = std::make_pair(merge_nl[j],merge_nl[j+1]);
+    }
   }
 }
 
@@ -358,6 +421,18 @@ unsigned NeighborList::getStride() const {
   return stride_;
 }
 
+double NeighborList::getSkin() const {
+  return skin_;
+}
+
+unsigned long NeighborList::getNumberOfUpdates() const {
+  return nupdates_;
+}
+
+unsigned long NeighborList::getNumberOfRebuilds() const {
+  return nrebuilds_;
+}
+
 unsigned NeighborList::getLastUpdate() const {
   return lastupdate_;
 }
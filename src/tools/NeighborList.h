@@ -61,8 +61,23 @@ private:
   size_t nallpairs_;
   unsigned stride_=0;
   unsigned lastupdate_=0;
+/// The skin of the Verlet list: when it is larger than zero the list is rebuilt only when an atom moved more than half of it
+  double skin_=0.0;
+/// The positions of the atoms when the list was last built
+  std::vector<PLMD::Vector> reference_positions_{};
+/// The number of times update() was called and the number of times the list was rebuilt
+  unsigned long nupdates_=0;
+  unsigned long nrebuilds_=0;
 /// Initialize the neighbor list with all possible pairs
   void initialize();
+/// Build the list with the link cells
+  void buildWithCells(const std::vector<PLMD::Vector>& positions, unsigned nt);
+/// Build the list checking the distance between all the possible pairs
+  void buildWithAllPairs(const std::vector<PLMD::Vector>& positions, unsigned nt);
+/// Merge the pairs that have been found by the various ranks in the list of neighbors
+  void gatherNeighbors(const std::vector<unsigned>& local_flat_nl);
+/// Check if an atom moved more than half of the skin since the list was last built
+  bool skinIsExceeded(const std::vector<PLMD::Vector>& positions, unsigned nt) const;
 /// Return the pair of indexes in the positions array
 /// of the two atoms forming the i-th pair among all possible pairs
   pairIDs getIndexPair(unsigned i) const;
@@ -78,7 +93,8 @@ public:
                Communicator &cm,
                double distance=1.0e+30,
                unsigned stride=0,
-               bool doCells=false);
+               bool doCells=false,
+               double skin=0.0);
   NeighborList(const std::vector<PLMD::AtomNumber>& list0,
                bool serial,
                bool do_pbc,
@@ -86,7 +102,8 @@ public:
                Communicator &cm,
                double distance=1.0e+30,
                unsigned stride=0,
-               bool doCells=false);
+               bool doCells=false,
+               double skin=0.0);
   ~NeighborList();
 /// Return the list of all atoms. These are needed to rebuild the neighbor list.
 /// Please use the `prepare()` method instead of directly calling this outside the constructor of your action
@@ -100,7 +117,16 @@ public:
   std::vector<PLMD::AtomNumber>& getReducedAtomList();
 /// Update the neighbor list and prepare the new
 /// list of atoms that will be requested to the main code
+///
+/// If a skin has been set the list is rebuilt only when one of the atoms
+/// moved more than half of the skin since the last time it was built
   void update(const std::vector<PLMD::Vector>& positions);
+/// Get the skin of the Verlet list (zero if the list is rebuilt at every update)
+  double getSkin() const;
+/// Get the number of times update() has been called
+  unsigned long getNumberOfUpdates() const;
+/// Get the number of times the list has been rebuilt by update()
+  unsigned long getNumberOfRebuilds() const;
 /// Get the update stride of the neighbor list
   unsigned getStride() const;
 /// Get the last step in which the neighbor list was updated
@@ -26,6 +26,7 @@
 #include "core/Value.h"
 #include "Communicator.h"
 #include "Tools.h"
+#include "AsyncWriter.h"
 #include <cstdarg>
 #include <cstring>
 
@@ -33,6 +34,7 @@
 #include <cstdlib>
 #include <cerrno>
 #include <utility>
+#include <cstdint>
 
 #ifdef __PLUMED_HAS_ZLIB
 #include <zlib.h>
@@ -40,11 +42,48 @@
 
 namespace PLMD {
 
+namespace {
+/// Size of the blocks passed to the AsyncWriter
+constexpr std::size_t asyncBlockSize=64*1024;
+
+/// The mode used to open gzipped files, with the chosen compression level
+std::string gzMode(const std::string& mode) {
+  return mode + std::to_string(AsyncWriter::gzipLevel());
+}
+}
+
+void OFile::asyncFence(bool check) {
+  if(!async_ || linked || (comm && comm->Get_rank()>0)) {
+    return;
+  }
+  if(asyncBuffer_.size()>0) {
+    AsyncWriter::get().submit(fp,gzfp,path,asyncBuffer_);
+  }
+  std::string error=AsyncWriter::get().fence();
+  if(check && error.length()>0) {
+    plumed_merror(error);
+  }
+}
+
 size_t OFile::llwrite(const char*ptr,size_t s) {
   size_t r;
   if(linked) {
     return linked->llwrite(ptr,s);
   }
+  if(async_) {
+    // the data are collected and written by the AsyncWriter thread in large blocks,
+    // there is no need to synchronize the processes as the result is known
+    if(! (comm && comm->Get_rank()>0)) {
+      if(!fp) {
+        plumed_merror("writing on uninitialized File");
+      }
+      asyncBuffer_.insert(asyncBuffer_.end(),ptr,ptr+s);
+      if(asyncBuffer_.size()>=asyncBlockSize) {
+        AsyncWriter::get().submit(fp,gzfp,path,asyncBuffer_);
+      }
+    }
+    return s;
+  }
   if(! (comm && comm->Get_rank()>0)) {
     if(!fp) {
       plumed_merror("writing on uninitialized File");
@@ -78,7 +117,9 @@ OFile::OFile():
   fieldChanged(false),
   backstring("bck"),
   enforceRestart_(false),
-  enforceBackup_(false) {
+  enforceBackup_(false),
+  async_(AsyncWriter::enabled()),
+  binary_(false) {
   fmtField();
   buflen=1;
   actual_buffer_length=0;
@@ -91,6 +132,20 @@ OFile::OFile():
   buffer_string.resize(1000,0);
 }
 
+OFile::~OFile() {
+  if(fp) {
+    // no exception here
+    asyncFence(false);
+  }
+}
+
+void OFile::close() {
+  if(fp) {
+    asyncFence();
+  }
+  FileBase::close();
+}
+
 OFile& OFile::link(OFile&l) {
   fp=NULL;
   gzfp=NULL;
@@ -173,6 +228,27 @@ OFile& OFile::fmtField() {
   return *this;
 }
 
+bool OFile::hasBinaryExtension(const std::string& fname) {
+  std::string name=fname;
+  if(Tools::extension(name)=="gz") {
+    name=name.substr(0,name.length()-3);
+  }
+  return Tools::extension(name)=="bin";
+}
+
+OFile& OFile::setBinaryFormat() {
+  binary_=true;
+  return *this;
+}
+
+void OFile::printBinaryField(const std::string&name,long long int v) {
+  Field field;
+  field.name=name;
+  field.type='i';
+  field.integer=v;
+  fields.push_back(field);
+}
+
 OFile& OFile::printField(const std::string&name,double v) {
 // When one tries to print -nan we print nan instead.
 // The distinction between +nan and -nan is not well defined
@@ -180,42 +256,73 @@ OFile& OFile::printField(const std::string&name,double v) {
   if(std::isnan(v)) {
     v=std::numeric_limits<double>::quiet_NaN();
   }
+  if(binary_) {
+    Field field;
+    field.name=name;
+    field.number=v;
+    fields.push_back(field);
+    return *this;
+  }
   std::snprintf(buffer_string.data(),buffer_string.size(),fieldFmt.c_str(),v);
   printField(name,buffer_string.data());
   return *this;
 }
 
 OFile& OFile::printField(const std::string&name,int v) {
+  if(binary_) {
+    printBinaryField(name,v);
+    return *this;
+  }
   std::snprintf(buffer_string.data(),buffer_string.size()," %d",v);
   printField(name,buffer_string.data());
   return *this;
 }
 
 OFile& OFile::printField(const std::string&name,long int v) {
+  if(binary_) {
+    printBinaryField(name,v);
+    return *this;
+  }
   std::snprintf(buffer_string.data(),buffer_string.size()," %ld",v);
   printField(name,buffer_string.data());
   return *this;
 }
 
 OFile& OFile::printField(const std::string&name,long long int v) {
+  if(binary_) {
+    printBinaryField(name,v);
+    return *this;
+  }
   std::snprintf(buffer_string.data(),buffer_string.size()," %lld",v);
   printField(name,buffer_string.data());
   return *this;
 }
 
 OFile& OFile::printField(const std::string&name,unsigned v) {
+  if(binary_) {
+    printBinaryField(name,v);
+    return *this;
+  }
   std::snprintf(buffer_string.data(),buffer_string.size()," %u",v);
   printField(name,buffer_string.data());
   return *this;
 }
 
 OFile& OFile::printField(const std::string&name,long unsigned v) {
+  if(binary_) {
+    printBinaryField(name,v);
+    return *this;
+  }
   std::snprintf(buffer_string.data(),buffer_string.size()," %lu",v);
   printField(name,buffer_string.data());
   return *this;
 }
 
 OFile& OFile::printField(const std::string&name,long long unsigned v) {
+  if(binary_) {
+    printBinaryField(name,v);
+    return *this;
+  }
   std::snprintf(buffer_string.data(),buffer_string.size()," %llu",v);
   printField(name,buffer_string.data());
   return *this;
@@ -228,6 +335,7 @@ OFile& OFile::printField(const std::string&name,const std::string & v) {
       break;
     }
   if(i>=const_fields.size()) {
+    plumed_massert(!binary_,"file " + getPath() + ": field " + name + " is a string and cannot be written in a binary file");
     Field field;
     field.name=name;
     field.value=v;
@@ -266,12 +374,16 @@ OFile& OFile::printField() {
     reprint=true;
   } else
     for(unsigned i=0; i<fields.size(); i++) {
-      if( previous_fields[i].name!=fields[i].name ||
+      if( previous_fields[i].name!=fields[i].name || previous_fields[i].type!=fields[i].type ||
           (fields[i].constant && fields[i].value!=previous_fields[i].value) ) {
         reprint=true;
         break;
       }
     }
+  if(binary_) {
+    printBinaryFields(reprint);
+    return *this;
+  }
   if(reprint) {
     printf("#! FIELDS");
     for(unsigned i=0; i<fields.size(); i++) {
@@ -293,6 +405,56 @@ OFile& OFile::printField() {
   return *this;
 }
 
+// A binary file is made of headers, each followed by the records written with it.
+// A header is: the binaryMagic string, the version, the number of fields and of constant
+// fields (all unsigned 32 bit integers), then for each field its type ('d' or 'i') and
+// its name, and for each constant field its name and its value. Strings are written as
+// their length (unsigned 32 bit integer) followed by their characters.
+// A record is the character 'R' followed by the values of the fields, each 8 bytes long.
+// Numbers use the byte order of the machine on which the file was written.
+void OFile::printBinaryFields(bool reprint) {
+  std::vector<char>& b(binaryRecord);
+  b.clear();
+  auto add=[&b](const void* p,std::size_t n) {
+    const char* c=static_cast<const char*>(p);
+    b.insert(b.end(),c,c+n);
+  };
+  auto addUnsigned=[&add](std::size_t n) {
+    const std::uint32_t u=n;
+    add(&u,sizeof(u));
+  };
+  auto addString=[&add,&addUnsigned](const std::string& str) {
+    addUnsigned(str.length());
+    add(str.data(),str.length());
+  };
+  if(reprint) {
+    add(binaryMagic,8);
+    addUnsigned(binaryVersion);
+    addUnsigned(fields.size());
+    addUnsigned(const_fields.size());
+    for(const auto & f : fields) {
+      add(&f.type,1);
+      addString(f.name);
+    }
+    for(const auto & f : const_fields) {
+      addString(f.name);
+      addString(f.value);
+    }
+  }
+  b.push_back('R');
+  for(const auto & f : fields) {
+    if(f.type=='i') {
+      add(&f.integer,sizeof(f.integer));
+    } else {
+      add(&f.number,sizeof(f.number));
+    }
+  }
+  llwrite(b.data(),b.size());
+  previous_fields=fields;
+  fields.clear();
+  fieldChanged=false;
+}
+
 void OFile::setBackupString( const std::string& str ) {
   backstring=str;
 }
@@ -360,6 +522,9 @@ void OFile::backupFile( const std::string& bstring, const std::string& fname ) {
 
 OFile& OFile::open(const std::string&setpath) {
   plumed_assert(!cloned);
+  if(fp) {
+    asyncFence();
+  }
   eof=false;
   err=false;
   fp=NULL;
@@ -371,7 +536,7 @@ OFile& OFile::open(const std::string&setpath) {
     mode="a";
     if(Tools::extension(path)=="gz") {
 #ifdef __PLUMED_HAS_ZLIB
-      gzfp=(void*)gzopen(const_cast<char*>(path.c_str()),"a9");
+      gzfp=(void*)gzopen(const_cast<char*>(path.c_str()),gzMode("a").c_str());
 #else
       plumed_merror("file " + getPath() + ": trying to use a gz file without zlib being linked");
 #endif
@@ -385,7 +550,7 @@ OFile& OFile::open(const std::string&setpath) {
     mode="w";
     if(Tools::extension(path)=="gz") {
 #ifdef __PLUMED_HAS_ZLIB
-      gzfp=(void*)gzopen(const_cast<char*>(path.c_str()),"w9");
+      gzfp=(void*)gzopen(const_cast<char*>(path.c_str()),gzMode("w").c_str());
 #else
       plumed_merror("file " + getPath() + ": trying to use a gz file without zlib being linked");
 #endif
@@ -403,6 +568,7 @@ OFile& OFile::rewind() {
 // moreover, we can take a backup of the file
   plumed_assert(fp);
   clearFields();
+  asyncFence();
 
   if(!comm || comm->Get_rank()==0) {
     std::string fname=this->path;
@@ -422,7 +588,7 @@ OFile& OFile::rewind() {
 #ifdef __PLUMED_HAS_ZLIB
     gzclose((gzFile)gzfp);
     // no exception here
-    gzfp=(void*)gzopen(const_cast<char*>(this->path.c_str()),"w9");
+    gzfp=(void*)gzopen(const_cast<char*>(this->path.c_str()),gzMode("w").c_str());
 #endif
   } else {
     std::fclose(fp);
@@ -433,6 +599,9 @@ OFile& OFile::rewind() {
 }
 
 FileBase& OFile::flush() {
+  // with asynchronous output the flush is also a fence,
+  // all the data written before are in the file when it returns
+  asyncFence();
   if(heavyFlush) {
     if(gzfp) {
 #ifdef __PLUMED_HAS_ZLIB
@@ -164,6 +164,12 @@ class OFile:
 /// Class identifying a single field for fielded output
   class Field:
     public FieldBase {
+  public:
+/// Type of the field in binary files ('d' for double, 'i' for integers)
+    char type='d';
+/// Value of the field in binary files
+    double number=0.0;
+    long long int integer=0;
   };
 /// Low-level write
   std::size_t llwrite(const char*,std::size_t);
@@ -193,9 +199,26 @@ class OFile:
   bool enforceRestart_;
 /// True if backup behavior (i.e. non restart) should be forced
   bool enforceBackup_;
+/// True if the data are written by the AsyncWriter thread
+  bool async_;
+/// Data that have not been passed to the AsyncWriter yet
+  std::vector<char> asyncBuffer_;
+/// Pass the buffered data to the AsyncWriter and wait until everything is written.
+/// Must be called before using the file pointers directly
+  void asyncFence(bool check=true);
+/// True if the fields are written in binary format
+  bool binary_;
+/// Internal buffer for binary records
+  std::vector<char> binaryRecord;
+/// Write a line of fields in binary format
+  void printBinaryFields(bool reprint);
+/// Store an integer field in binary format
+  void printBinaryField(const std::string&,long long int);
 public:
 /// Constructor
   OFile();
+/// Destructor, waits for the data that are still being written
+  ~OFile();
 /// Allows overloading of link
   using FileBase::link;
 /// Allows overloading of open
@@ -221,6 +244,17 @@ public:
 /// Typically "PLUMED: ". Notice that lines with a prefix cannot
 /// be parsed using fields in a IFile.
   OFile& setLinePrefix(const std::string&);
+/// Write the fields in binary format.
+/// The fields are then written without any formatting, so that
+/// they can be read back by IFile without any parsing, see IFile::seekFrame().
+/// All the fields that are not constant must be numbers.
+  OFile& setBinaryFormat();
+/// Check if the fields are written in binary format
+  bool isBinaryFormat() const {
+    return binary_;
+  }
+/// Check if a file should be written in binary format, that is if its name ends with .bin or .bin.gz
+  static bool hasBinaryExtension(const std::string&);
 /// Set the format for writing double precision fields
   OFile& fmtField(const std::string&);
 /// Reset the format for writing double precision fields to its default
@@ -262,8 +296,11 @@ public:
   friend OFile& operator<<(OFile&,const T &);
 /// Rewind a file
   OFile&rewind();
-/// Flush a file
+/// Flush a file.
+/// With asynchronous output, it waits until all the data have been written
   FileBase&flush() override;
+/// Closes the file, after all the data have been written
+  void close() override;
 /// Enforce restart, also if the attached plumed object is not restarting.
 /// Useful for tests
   OFile&enforceRestart();
@@ -0,0 +1,129 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "ScratchArena.h"
+#include "Log.h"
+#include <cstdint>
+
+namespace PLMD {
+
+ScratchArena::ScratchArena( Log* log ):
+  mylog(log),
+  current(0),
+  offset(0),
+  used(0),
+  highwater(0),
+  maxretained(defaultMaxRetained),
+  nresets(0),
+  nrequests(0),
+  nheap(0),
+  peak(0) {
+}
+
+ScratchArena::~ScratchArena() {
+  if( mylog && mylog->isOpen() && nrequests>0 ) {
+    std::size_t mypeak = highwater>peak ? highwater : peak;
+    mylog->printf("Scratch arena: %lu buffers over %lu steps, peak memory per step %lu bytes, %lu heap allocations\n",
+                  nrequests, nresets, static_cast<unsigned long>(mypeak), nheap );
+  }
+}
+
+void ScratchArena::addBlock( std::size_t size ) {
+  // Blocks at least double in size so that only few of them are needed to find the memory used in one step
+  if( blocks.size()>0 && size<2*blocks.back().size ) {
+    size=2*blocks.back().size;
+  }
+  if( size<4096 ) {
+    size=4096;
+  }
+  Block b;
+  b.memory.reset( new char[size+alignment] );
+  std::size_t misalign=reinterpret_cast<std::uintptr_t>(b.memory.get())%alignment;
+  b.start = b.memory.get() + ( misalign>0 ? alignment-misalign : 0 );
+  b.size = size;
+  blocks.push_back( std::move(b) );
+  nheap++;
+}
+
+void* ScratchArena::allocate( std::size_t bytes ) {
+  // Round up so that the next buffer is also aligned
+  bytes = ( (bytes+alignment-1)/alignment )*alignment;
+  std::lock_guard<std::mutex> lock(mtx);
+  while( current<blocks.size() && offset+bytes>blocks[current].size ) {
+    current++;
+    offset=0;
+  }
+  if( current==blocks.size() ) {
+    addBlock( bytes );
+  }
+  void* ptr = blocks[current].start + offset;
+  offset += bytes;
+  used += bytes;
+  if( used>highwater ) {
+    highwater=used;
+  }
+  nrequests++;
+  return ptr;
+}
+
+ScratchArena::Mark ScratchArena::mark() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return Mark{current,offset,used};
+}
+
+void ScratchArena::rewind( const Mark& m ) {
+  std::lock_guard<std::mutex> lock(mtx);
+  current=m.block;
+  offset=m.offset;
+  used=m.used;
+  // When the arena is empty the blocks can be merged, so calculations that
+  // are repeated many times without a reset do not keep adding blocks
+  if( used==0 ) {
+    merge();
+  }
+}
+
+void ScratchArena::merge() {
+  if( highwater>peak ) {
+    peak=highwater;
+  }
+  // A single block that is large enough for everything that was used since the last merge,
+  // unless that is more than what we are allowed to keep
+  std::size_t size = highwater<maxretained ? highwater : maxretained;
+  if( blocks.size()>1 || (blocks.size()==1 && blocks[0].size>maxretained && blocks[0].size>4096) ) {
+    blocks.clear();
+    if( size>0 ) {
+      addBlock( size );
+    }
+  }
+  current=0;
+  offset=0;
+  highwater=0;
+}
+
+void ScratchArena::reset() {
+  std::lock_guard<std::mutex> lock(mtx);
+  used=0;
+  merge();
+  nresets++;
+}
+
+}
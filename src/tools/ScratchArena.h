@@ -0,0 +1,173 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_ScratchArena_h
+#define __PLUMED_tools_ScratchArena_h
+
+#include "View.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace PLMD {
+
+class Log;
+
+/**
+\ingroup TOOLBOX
+A step-scoped arena for scratch buffers.
+
+Actions that need temporary workspaces during a step can take them from this
+arena instead of allocating (and freeing) a std::vector every time.  The memory
+is handed out by moving a pointer forward in a large block and it is all given
+back at once when reset() is called at the start of every step.  If the block
+is too small new blocks are allocated and, at the following reset, they are merged
+in a single block that is large enough for the whole step.  After the first few
+steps no memory is allocated at all.
+
+Buffers are aligned to cache lines, so buffers that are taken by different OpenMP
+threads never share a cache line.  Taking a buffer is thread safe.
+
+\verbatim
+View<double> buffer( arena.get<double>( n ) );
+\endverbatim
+
+Buffers should be taken inside a Scope, which gives them back when it goes out of
+scope.  This is what keeps the arena small when calculate() is called many times
+in a step (e.g. with NUMERICAL_DERIVATIVES) or when no step is set at all:
+
+\verbatim
+ScratchArena::Scope scope( arena );
+View<double> buffer( arena.get<double>( n ) );
+\endverbatim
+
+Scopes should be opened outside OpenMP parallel regions, since all the buffers
+that were taken after the scope was opened, also by other threads, are given back
+when it is closed.  Buffers that are not taken inside a scope are only given back
+by reset(), which PlumedMain calls at the start of each step.  When the arena is
+empty the blocks are merged, but the merged block never keeps more than
+getMaxRetained() bytes.
+
+If the arena is constructed with a Log the statistics on the allocations are
+written on it when the arena is destroyed.
+*/
+class ScratchArena {
+private:
+/// Alignment of every buffer
+  static constexpr std::size_t alignment=64;
+/// A block of memory
+  struct Block {
+    std::unique_ptr<char[]> memory;
+    char* start;
+    std::size_t size;
+  };
+/// The log on which the statistics are written
+  Log* mylog;
+/// Protects the blocks when buffers are taken from different threads
+  std::mutex mtx;
+/// The blocks that are used during this step
+  std::vector<Block> blocks;
+/// The block we are taking memory from and the first unused byte in it
+  std::size_t current;
+  std::size_t offset;
+/// The memory that is in use and the largest amount that has been in use since the blocks were last merged
+  std::size_t used;
+  std::size_t highwater;
+/// The largest block that is kept when the blocks are merged
+  std::size_t maxretained;
+/// Statistics
+  unsigned long nresets;
+  unsigned long nrequests;
+  unsigned long nheap;
+  std::size_t peak;
+/// Add a new block of memory that has at least size bytes
+  void addBlock( std::size_t size );
+/// Get an aligned piece of memory of the required size
+  void* allocate( std::size_t bytes );
+/// Replace the blocks with a single one, must be called when no buffer is in use
+  void merge();
+public:
+/// The position of the arena, all the buffers taken after it can be given back with rewind()
+  struct Mark {
+    std::size_t block;
+    std::size_t offset;
+    std::size_t used;
+  };
+/// Gives back all the buffers that were taken while it exists
+  class Scope {
+    ScratchArena& arena;
+    Mark start;
+  public:
+    explicit Scope( ScratchArena& a ):
+      arena(a),
+      start(a.mark()) {}
+    ~Scope() {
+      arena.rewind( start );
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+/// By default the arena does not keep more than this number of bytes from one step to the next
+  static constexpr std::size_t defaultMaxRetained=64*1024*1024;
+  explicit ScratchArena( Log* log=nullptr );
+  ~ScratchArena();
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+/// Get a buffer of n objects of type T that are set to T()
+  template<typename T>
+  View<T> get( std::size_t n );
+/// Get the current position of the arena
+  Mark mark();
+/// Give back all the buffers that were taken after the mark
+  void rewind( const Mark& m );
+/// Give back all the buffers so the memory can be used again
+  void reset();
+/// Set the largest amount of memory that is kept when the blocks are merged
+  void setMaxRetained( std::size_t bytes ) {
+    maxretained=bytes;
+  }
+  std::size_t getMaxRetained() const {
+    return maxretained;
+  }
+/// Get the largest amount of memory that has been used in a step
+  std::size_t getPeakMemory() const {
+    return peak;
+  }
+/// Get the number of times memory has been requested from the heap
+  unsigned long getNumberOfHeapAllocations() const {
+    return nheap;
+  }
+};
+
+template<typename T>
+View<T> ScratchArena::get( std::size_t n ) {
+  static_assert( std::is_trivially_destructible<T>::value, "objects in the scratch arena are never destroyed" );
+  static_assert( alignof(T)<=alignment, "the alignment of objects in the scratch arena is too large" );
+  T* ptr=static_cast<T*>( allocate( n*sizeof(T) ) );
+  std::uninitialized_value_construct_n( ptr, n );
+  return View<T>( ptr, n );
+}
+
+}
+
+#endif
@@ -0,0 +1,252 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "SharedMemoryRing.h"
+#include "Exception.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#if __has_include(<sys/mman.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#define PLUMED_SHARED_MEMORY_RING
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace PLMD {
+
+namespace {
+/// Everything in the file is aligned to cache lines, so different producers never write on the same line
+constexpr std::size_t alignment=64;
+
+std::size_t alignedSize( std::size_t n ) {
+  return ( (n+alignment-1)/alignment )*alignment;
+}
+
+/// The counter of the records published by a producer and the process that publishes them
+struct alignas(alignment) Head {
+  std::atomic<std::uint64_t> n;
+  std::atomic<std::int64_t> pid;
+};
+
+/// The states of the file, stored in the lowest bit of Header::state.
+/// The other bits contain the number of processes that are using the file
+constexpr std::uint64_t ready=1;
+constexpr std::uint64_t oneProcess=2;
+}
+
+struct alignas(alignment) SharedMemoryRing::Header {
+  std::atomic<std::uint64_t> state;
+  std::uint64_t nproducers;
+  std::uint64_t recordSize;
+  std::uint64_t capacity;
+};
+
+static_assert( std::atomic<std::uint64_t>::is_always_lock_free, "atomics in shared memory must be lock free" );
+static_assert( std::atomic<std::int64_t>::is_always_lock_free, "atomics in shared memory must be lock free" );
+
+#ifdef PLUMED_SHARED_MEMORY_RING
+namespace {
+/// Check if the process that registered itself with this pid is still running
+bool isRunning( std::int64_t pid ) {
+  return pid>0 && ( ::kill( pid_t(pid), 0 )==0 || errno==EPERM );
+}
+}
+#endif
+
+SharedMemoryRing::SharedMemoryRing():
+  memory(nullptr),
+  size(0),
+  id(0),
+  nproducers(0),
+  recordSize(0),
+  capacity(0) {
+}
+
+SharedMemoryRing::~SharedMemoryRing() {
+  // no exception here
+  try {
+    close();
+  } catch(...) {
+  }
+}
+
+bool SharedMemoryRing::available() {
+#ifdef PLUMED_SHARED_MEMORY_RING
+  return true;
+#else
+  return false;
+#endif
+}
+
+SharedMemoryRing::Header* SharedMemoryRing::getHeader() const {
+  return reinterpret_cast<Header*>( memory );
+}
+
+std::uint64_t SharedMemoryRing::getHead( unsigned p ) const {
+  plumed_dbg_assert( p<nproducers );
+  const Head* heads=reinterpret_cast<const Head*>( memory + sizeof(Header) );
+  return heads[p].n.load( std::memory_order_acquire );
+}
+
+double* SharedMemoryRing::getRing( unsigned p ) const {
+  const std::size_t start=sizeof(Header) + nproducers*sizeof(Head);
+  return reinterpret_cast<double*>( memory + start + p*alignedSize( getNumberOfSlots()*recordSize*sizeof(double) ) );
+}
+
+void SharedMemoryRing::open( const std::string& fname, unsigned np, unsigned myid, std::size_t rsize, std::size_t cap ) {
+  plumed_massert( !memory, "shared memory file " + path + " is already open" );
+  plumed_massert( myid<np, "producer id should be smaller than the number of producers" );
+  plumed_massert( rsize>0 && cap>0, "records and ring buffers in shared memory cannot be empty" );
+#ifdef PLUMED_SHARED_MEMORY_RING
+  path=fname;
+  id=myid;
+  nproducers=np;
+  recordSize=rsize;
+  capacity=cap;
+  size=sizeof(Header) + nproducers*sizeof(Head) + nproducers*alignedSize( getNumberOfSlots()*recordSize*sizeof(double) );
+  int fd=::open( path.c_str(), O_RDWR | O_CREAT, 0600 );
+  plumed_massert( fd>=0, "cannot open shared memory file " + path + ": " + std::strerror(errno) );
+  // the file is filled with zeros when it is extended, so a new file has no process and no record
+  // all the processes extend the file to the same size, so it does not matter which one does it first
+  off_t current=::lseek( fd, 0, SEEK_END );
+  if( current<off_t(size) && ::ftruncate( fd, size )!=0 ) {
+    ::close( fd );
+    plumed_merror("cannot resize shared memory file " + path + ": " + std::strerror(errno) );
+  }
+  void* ptr=::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  ::close( fd );
+  plumed_massert( ptr!=MAP_FAILED, "cannot map shared memory file " + path + ": " + std::strerror(errno) );
+  memory=static_cast<char*>( ptr );
+  Header* header=getHeader();
+  Head* heads=reinterpret_cast<Head*>( memory + sizeof(Header) );
+  const std::int64_t mypid=::getpid();
+  // the first process that arrives initializes the file, the others wait until it is ready.
+  // A file that is left by processes that have all been killed is initialized again, since its records are stale
+  bool initialize=false;
+  std::uint64_t state=header->state.load( std::memory_order_acquire );
+  while( true ) {
+    if( state/oneProcess==0 ) {
+      if( header->state.compare_exchange_weak( state, oneProcess, std::memory_order_acq_rel ) ) {
+        initialize=true;
+        break;
+      }
+    } else if( state&ready ) {
+      if( header->nproducers!=nproducers || header->recordSize!=recordSize || header->capacity!=capacity ) {
+        ::munmap( memory, size );
+        memory=nullptr;
+        plumed_merror("shared memory file " + fname + " is used by processes with different settings");
+      }
+      bool stale=true;
+      for(unsigned i=0; i<nproducers; ++i) {
+        if( isRunning( heads[i].pid.load( std::memory_order_acquire ) ) ) {
+          stale=false;
+        }
+      }
+      if( stale ) {
+        if( header->state.compare_exchange_weak( state, oneProcess, std::memory_order_acq_rel ) ) {
+          initialize=true;
+          break;
+        }
+        continue;
+      }
+      // a process that was killed is not counted anymore when it is replaced by the one that restarts it
+      const std::int64_t previous=heads[id].pid.load( std::memory_order_acquire );
+      const bool replace=previous>0 && !isRunning( previous );
+      heads[id].pid.store( mypid, std::memory_order_release );
+      if( header->state.compare_exchange_weak( state, replace ? state : state+oneProcess, std::memory_order_acq_rel ) ) {
+        break;
+      }
+    } else {
+      std::this_thread::yield();
+      state=header->state.load( std::memory_order_acquire );
+    }
+  }
+  if( initialize ) {
+    header->nproducers=nproducers;
+    header->recordSize=recordSize;
+    header->capacity=capacity;
+    for(unsigned i=0; i<nproducers; ++i) {
+      heads[i].n.store( 0, std::memory_order_relaxed );
+      heads[i].pid.store( 0, std::memory_order_relaxed );
+    }
+    heads[id].pid.store( mypid, std::memory_order_relaxed );
+    header->state.fetch_or( ready, std::memory_order_release );
+  }
+#else
+  plumed_merror("shared memory is not available on this platform");
+#endif
+}
+
+void SharedMemoryRing::close() {
+#ifdef PLUMED_SHARED_MEMORY_RING
+  if( !memory ) {
+    return;
+  }
+  // the last process that leaves deletes the file
+  const std::uint64_t state=getHeader()->state.fetch_sub( oneProcess, std::memory_order_acq_rel );
+  // the pid is only removed afterwards, so the file never looks stale while this process is counted
+  Head* heads=reinterpret_cast<Head*>( memory + sizeof(Header) );
+  std::int64_t mypid=::getpid();
+  heads[id].pid.compare_exchange_strong( mypid, 0, std::memory_order_acq_rel );
+  ::munmap( memory, size );
+  memory=nullptr;
+  if( state/oneProcess==1 ) {
+    ::unlink( path.c_str() );
+  }
+#endif
+}
+
+void SharedMemoryRing::publish( View<const double> record ) {
+  plumed_dbg_assert( memory && record.size()==recordSize );
+  Head* heads=reinterpret_cast<Head*>( memory + sizeof(Header) );
+  // only this process changes this counter
+  const std::uint64_t n=heads[id].n.load( std::memory_order_relaxed );
+  std::copy( record.begin(), record.end(), getRing(id) + (n%getNumberOfSlots())*recordSize );
+  heads[id].n.store( n+1, std::memory_order_release );
+}
+
+bool SharedMemoryRing::read( unsigned p, std::size_t& cursor, std::vector<double>& record ) const {
+  plumed_dbg_assert( memory );
+  const std::uint64_t head=getHead( p );
+  if( cursor>=head ) {
+    return false;
+  }
+  if( head-cursor>capacity ) {
+    plumed_merror("records in shared memory file " + path + " have been overwritten before being read, the buffer is too small");
+  }
+  record.resize( recordSize );
+  const double* ptr=getRing(p) + (cursor%getNumberOfSlots())*recordSize;
+  std::copy( ptr, ptr+recordSize, record.begin() );
+  // the record might have been overwritten while it was copied
+  std::atomic_thread_fence( std::memory_order_acquire );
+  if( getHead( p )-cursor>capacity ) {
+    plumed_merror("records in shared memory file " + path + " have been overwritten before being read, the buffer is too small");
+  }
+  cursor++;
+  return true;
+}
+
+}
@@ -0,0 +1,122 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_SharedMemoryRing_h
+#define __PLUMED_tools_SharedMemoryRing_h
+
+#include "View.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+Ring buffers of records in memory that is shared between processes on the same node.
+
+The memory is obtained by mapping a file, that should be on a memory file system (e.g. /dev/shm),
+so the processes only need to agree on the name of the file.  Each of the processes that
+use the file (the producers) owns a ring buffer in which it publishes records of a fixed number of doubles.
+All the processes can read the records of all the others.
+
+Nothing is locked.  A record is copied in the ring buffer of its producer and then the counter
+of the records that have been published by this producer is increased.  Each reader keeps
+its own cursors, so readers never slow down producers.  If a producer publishes so
+many records that one that was not read yet is overwritten, the reader that has not read
+it throws an exception: the buffer must be large enough to keep all the records that
+are published between two reads.
+
+The first process that opens the file initializes it, and the file is deleted when
+the last process that uses it closes it.  Every producer stores its pid in the file.
+If the processes that were using the file have all been killed, the file is initialized
+again by the next process that opens it, so its stale records are never read.  If only
+the producer with a given id was killed, the process that opens the file with the same id
+replaces it and continues publishing after its records.
+
+\verbatim
+SharedMemoryRing ring;
+ring.open( "/dev/shm/rings", nproducers, myid, recordsize, capacity );
+ring.publish( record );
+std::size_t cursor=0;
+std::vector<double> record;
+while( ring.read( other, cursor, record ) ) {
+  ...
+}
+\endverbatim
+*/
+class SharedMemoryRing {
+private:
+  struct Header;
+/// The path of the file
+  std::string path;
+/// The mapped memory and its size
+  char* memory;
+  std::size_t size;
+/// The producer that publishes records with this object
+  unsigned id;
+/// The number of producers
+  unsigned nproducers;
+/// The number of doubles in a record and the number of records in each ring buffer
+  std::size_t recordSize;
+  std::size_t capacity;
+/// Get the header of the file
+  Header* getHeader() const ;
+/// Get the counter of the records that have been published by producer p
+  std::uint64_t getHead( unsigned p ) const ;
+/// Get the ring buffer of producer p
+  double* getRing( unsigned p ) const ;
+/// Get the number of records that fit in a ring buffer.  There is one more than the capacity
+/// so that the oldest record can still be read while the following one is being written
+  std::size_t getNumberOfSlots() const {
+    return capacity+1;
+  }
+public:
+  SharedMemoryRing();
+  ~SharedMemoryRing();
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+/// Check if shared memory is available on this platform
+  static bool available();
+/// Open the file and map it.  All the processes that use the file must pass the same
+/// nproducers, recordSize and capacity and a different id
+  void open( const std::string& fname, unsigned nproducers, unsigned id, std::size_t recordSize, std::size_t capacity );
+/// Unmap the file and delete it if no other process is using it
+  void close();
+/// Check if the file is open
+  bool isOpen() const {
+    return memory!=nullptr;
+  }
+/// Publish a record in the ring buffer of this producer
+  void publish( View<const double> record );
+/// Get the number of records that have been published by producer p
+  std::size_t getNumberOfPublished( unsigned p ) const {
+    return getHead( p );
+  }
+/// Read the record of producer p that is at position cursor.  If the record has not been published
+/// yet false is returned, otherwise the record is copied and the cursor is moved forward
+  bool read( unsigned p, std::size_t& cursor, std::vector<double>& record ) const ;
+};
+
+}
+
+#endif
@@ -42,6 +42,16 @@ std::string description(switchType type, const Data& data);
 
 Switch::~Switch()=default;
 
+void Switch::calculateSqrBlock(View<const double> distance2, View<double> result, View<double> dfunc) const {
+  for(std::size_t i=0; i<distance2.size(); ++i) {
+    result[i]=calculateSqr(distance2[i],dfunc[i]);
+  }
+}
+
+/// Apply the calculateSqr() of a switching function to a block of squared distances
+template <typename SF>
+void calculateSqrBlock(const Data& data, View<const double> distance2, View<double> result, View<double> dfunc);
+
 template <typename SF>
 class SwitchInterface :public Switch {
   switchType type;
@@ -60,6 +70,9 @@ public:
     dfunc=d;
     return f;
   }
+  void calculateSqrBlock(View<const double> distance2, View<double> result, View<double> dfunc) const override {
+    switchContainers::calculateSqrBlock<SF>(data,distance2,result,dfunc);
+  }
   void setupStretch() override {
     if(data.dmax<std::numeric_limits<double>::max()) {
       data.stretch=1.0;
@@ -117,8 +130,50 @@ decltype(T::function(
            std::declval<const Data& >(),
            std::declval<double >()
          ))> > = true;
+
+template<class, class = void>
+constexpr bool has_simd_kernel = false;
+
+//this verifies that T has a branchless simdKernel that can be used in vectorized loops
+template<class T>
+constexpr bool has_simd_kernel <T, std::void_t<
+decltype(T::simdKernel(
+           std::declval<const Data& >(),
+           std::declval<double >()
+         ))> > = true;
 } //namespace switchContainersUtils
 
+/// Apply the calculateSqr() of a switching function to a block of squared distances.
+/// The functions that have a branchless simdKernel() are evaluated in two vectorized loops:
+/// the first computes the function for all the distances, the second applies the cutoffs
+template <typename SF>
+void calculateSqrBlock(const Data& data, View<const double> distance2, View<double> result, View<double> dfunc) {
+  const std::size_t n=distance2.size();
+  const double* d2=distance2.data();
+  double* res=result.data();
+  double* df=dfunc.data();
+  if constexpr (switchContainersUtils::has_simd_kernel<SF>) {
+    // a local copy, so the compiler knows that the parameters are not changed by the stores
+    const Data local=data;
+    #pragma omp simd
+    for(std::size_t i=0; i<n; ++i) {
+      const auto fd = SF::simdKernel(local,d2[i]);
+      res[i]=fd.first;
+      df[i]=fd.second;
+    }
+    #pragma omp simd
+    for(std::size_t i=0; i<n; ++i) {
+      SF::simdCutoff(local,d2[i],res[i],df[i]);
+    }
+  } else {
+    for(std::size_t i=0; i<n; ++i) {
+      const auto fd = SF::calculateSqr(data,d2[i]);
+      res[i]=fd.first;
+      df[i]=fd.second;
+    }
+  }
+}
+
 using ValueDerivative=std::pair<double,double>;
 
 inline ValueDerivative applystretch(const Data&data,double distance,ValueDerivative in) {
@@ -181,6 +236,34 @@ struct baseSwitch {
   static ValueDerivative calculateSqr(const Data&data, double distance2) {
     return switching::calculate(data,std::sqrt(distance2));
   }
+
+  /// The function of calculateSqr() without the cutoffs, for vectorized loops.
+  /// The distances are kept larger than zero, so that the result is finite also
+  /// for the distances that are then discarded by branchlessCutoff().
+  /// The switching functions that vectorize well use these two in simdKernel() and simdCutoff()
+  static inline ValueDerivative branchlessKernel(const Data&data, const double distance2) {
+    constexpr double tiny=std::numeric_limits<double>::min();
+    const double distance = std::sqrt(distance2);
+    const double rdist = (distance-data.d0)*data.invr0;
+    const double sdistance = distance > tiny ? distance : tiny;
+    const double srdist = rdist > tiny ? rdist : tiny;
+    if constexpr (switchContainersUtils::has_function_data<switching>) {
+      return applystretch(data,sdistance,switching::function(data,srdist));
+    } else {
+      return applystretch(data,sdistance,switching::function(srdist));
+    }
+  }
+
+  /// Apply the cutoffs of calculate() to the output of branchlessKernel().
+  /// The selection is done with products, which GCC vectorizes also with -ftrapping-math
+  static inline void branchlessCutoff(const Data&data, const double distance2, double& result, double& dfunc) {
+    const double distance = std::sqrt(distance2);
+    const double rdist = (distance-data.d0)*data.invr0;
+    const double inside = distance > data.dmax ? 0.0 : 1.0;
+    const double beyond_d0 = rdist > 0.0 ? 1.0 : 0.0;
+    result = inside*((1.0-beyond_d0)*(data.stretch+data.shift) + beyond_d0*result);
+    dfunc = inside*beyond_d0*dfunc;
+  }
 };
 template<int N,
          std::enable_if_t< (N >0), bool> = true,
@@ -213,6 +296,22 @@ template<int N,
     }
     return {result,dfunc};
   }
+
+  /// The same operations as calculateSqr(), without the cutoff
+  static inline ValueDerivative simdKernel(const Data& data,double distance2) {
+    const double rdist = distance2*data.invr0_2;
+    auto [result,dfunc] = doRational<N/2>(rdist);
+    dfunc*=2*data.invr0_2;
+    result=result*data.stretch+data.shift;
+    dfunc*=data.stretch;
+    return {result,dfunc};
+  }
+
+  static inline void simdCutoff(const Data& data,double distance2, double& result, double& dfunc) {
+    const double inside = distance2 <= data.dmax_2 ? 1.0 : 0.0;
+    result*=inside;
+    dfunc*=inside;
+  }
 };
 
 //these enums are useful for clarifying the settings in the factory
@@ -384,6 +483,12 @@ struct exponentialSwitch: public baseSwitch<exponentialSwitch> {
     double result = std::exp(-rdist);
     return {result,-result};
   }
+  static inline ValueDerivative simdKernel(const Data& data,const double distance2) {
+    return branchlessKernel(data,distance2);
+  }
+  static inline void simdCutoff(const Data& data,const double distance2, double& result, double& dfunc) {
+    branchlessCutoff(data,distance2,result,dfunc);
+  }
 };
 
 struct gaussianSwitch: public baseSwitch<gaussianSwitch> {
@@ -398,6 +503,12 @@ struct gaussianSwitch: public baseSwitch<gaussianSwitch> {
     double result = std::exp(-0.5*rdist*rdist);
     return {result,-rdist*result};
   }
+  static inline ValueDerivative simdKernel(const Data& data,const double distance2) {
+    return branchlessKernel(data,distance2);
+  }
+  static inline void simdCutoff(const Data& data,const double distance2, double& result, double& dfunc) {
+    branchlessCutoff(data,distance2,result,dfunc);
+  }
 };
 
 struct fastgaussianSwitch: public baseSwitch<fastgaussianSwitch> {
@@ -447,11 +558,18 @@ struct smapSwitch: public baseSwitch<smapSwitch> {
   }
 
   static inline ValueDerivative function(const Data& data,const double rdist) {
-    const double sx=data.c*Tools::fastpow( rdist, data.a );
+    // sx is kept finite, so that the far distances give a zero derivative rather than a NaN
+    const double sx=std::min(data.c*Tools::fastpow( rdist, data.a ),std::numeric_limits<double>::max());
     double result=std::pow( 1.0 + sx, data.d );
     double dfunc=-data.b*sx/rdist*result/(1.0+sx);
     return {result,dfunc};
   }
+  static inline ValueDerivative simdKernel(const Data& data,const double distance2) {
+    return branchlessKernel(data,distance2);
+  }
+  static inline void simdCutoff(const Data& data,const double distance2, double& result, double& dfunc) {
+    branchlessCutoff(data,distance2,result,dfunc);
+  }
 };
 
 struct cubicSwitch: public baseSwitch<cubicSwitch> {
@@ -854,6 +972,52 @@ ValueDerivative calculateSqr(const switchType type,
   return {0.0,0.0};
 }
 
+//call to calculateSqr on a block of distances with no inheritance
+void calculateSqrBlock(const switchType type,
+                       const Data& data,
+                       View<const double> distance2,
+                       View<double> result,
+                       View<double> dfunc) {
+#define SWITCHCALL(x) case switchType::x: calculateSqrBlock<x##Switch>(data,distance2,result,dfunc); return;
+#define RATCALL(x) case switchType::rationalfix##x: calculateSqrBlock<fixedRational<x>>(data,distance2,result,dfunc); return;
+  switch (type) {
+    RATCALL(12)
+    RATCALL(10)
+    RATCALL(8)
+    RATCALL(6)
+    RATCALL(4)
+    RATCALL(2)
+  case switchType::rational:
+    calculateSqrBlock<rational<rationalPow::standard,rationalForm::standard>>(data,distance2,result,dfunc);
+    return;
+  case switchType::rationalFast:
+    calculateSqrBlock<rational<rationalPow::fast,rationalForm::standard>>(data,distance2,result,dfunc);
+    return;
+  case switchType::rationalSimple:
+    calculateSqrBlock<rational<rationalPow::standard,rationalForm::simplified>>(data,distance2,result,dfunc);
+    return;
+  case switchType::rationalSimpleFast:
+    calculateSqrBlock<rational<rationalPow::fast,rationalForm::simplified>>(data,distance2,result,dfunc);
+    return;
+    SWITCHCALL(exponential)
+    SWITCHCALL(gaussian)
+    SWITCHCALL(fastgaussian)
+    SWITCHCALL(smap)
+    SWITCHCALL(cubic)
+    SWITCHCALL(tanh)
+    SWITCHCALL(cosinus)
+    SWITCHCALL(nativeq)
+  default:
+    break;
+  }
+#undef SWITCHCALL
+#undef RATCALL
+  for(std::size_t i=0; i<distance2.size(); ++i) {
+    result[i]=0.0;
+    dfunc[i]=0.0;
+  }
+}
+
 //call to setupStretch with no inheritance
 void setupStretch(switchType type, Data& data) {
   if(data.dmax!=std::numeric_limits<double>::max()) {
@@ -1168,6 +1332,10 @@ double SwitchingFunction::calculateSqr(double distance2,double&dfunc)const {
   return function->calculateSqr( distance2, dfunc);
 }
 
+void SwitchingFunction::calculateSqr(View<const double> distance2, View<double> result, View<double> dfunc)const {
+  function->calculateSqrBlock( distance2, result, dfunc );
+}
+
 double SwitchingFunction::calculate(double distance,double&dfunc)const {
   plumed_massert(function,"you are trying to use an unset SwitchingFunction");
   return function->calculate( distance, dfunc);
@@ -1316,6 +1484,10 @@ double SwitchingFunctionAccelerable::calculateSqr(double distance2,double&dfunc)
   return result;
 }
 
+void SwitchingFunctionAccelerable::calculateSqr(View<const double> distance2, View<double> result, View<double> dfunc)const {
+  switchContainers::calculateSqrBlock(type,switchData,distance2,result,dfunc);
+}
+
 double SwitchingFunctionAccelerable::calculate(double distance,double&dfunc)const {
   //massert do not go with openacc
   // plumed_massert(init,"you are trying to use an unset SwitchingFunction");
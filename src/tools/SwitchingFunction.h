@@ -26,6 +26,7 @@
 #include <vector>
 #include <memory>
 #include "lepton/Lepton.h"
+#include "View.h"
 
 namespace PLMD {
 
@@ -96,6 +97,8 @@ struct Data {
 struct Switch {
   virtual double calculate(double distance, double& dfunc) const = 0;
   virtual double calculateSqr(double distance2, double& dfunc) const = 0;
+  /// calculateSqr() on a block of squared distances, by default it is called on each element
+  virtual void calculateSqrBlock(View<const double> distance2, View<double> result, View<double> dfunc) const;
   virtual const Data& getData() const = 0;
   virtual switchType getType() const = 0;
   virtual std::string description() const = 0;
@@ -144,6 +147,12 @@ public:
 /// The advantage is that in some case the expensive square root can be avoided
 /// (namely for rational functions, if nn and mm are even and d0 is zero)
   double calculateSqr(double distance2,double&dfunc)const;
+/// Compute the switching function for a block of squared distances.
+/// This gives the same results as calling calculateSqr() on each element, but
+/// the type of switching function is resolved once for the whole block and, for the
+/// rational functions with fixed even powers and the exponential and gaussian ones,
+/// the loop over the distances is written so that the compiler can vectorize it
+  void calculateSqr(View<const double> distance2, View<double> result, View<double> dfunc)const;
 /// Returns d0
   double get_d0() const;
 /// Returns r0
@@ -192,6 +201,8 @@ public:
 /// (namely for rational functions, if nn and mm are even and d0 is zero)
 #pragma acc routine seq
   double calculateSqr(double distance2,double&dfunc)const;
+/// Compute the switching function for a block of squared distances (see SwitchingFunction::calculateSqr())
+  void calculateSqr(View<const double> distance2, View<double> result, View<double> dfunc)const;
 /// Returns d0
   double get_d0() const;
 /// Returns r0
@@ -28,6 +28,17 @@
 #include "xdrfile/xdrfile_trr.h"
 #include "xdrfile/xdrfile_xtc.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#if __has_include(<sys/stat.h>) && __has_include(<unistd.h>)
+#define PLUMED_TRAJECTORY_INDEX_STAT
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // when using molfile plugin
 #ifdef __PLUMED_HAS_MOLFILE_PLUGINS
 #ifndef __PLUMED_HAS_EXTERNAL_MOLFILE_PLUGINS
@@ -131,6 +142,27 @@ public:
     return "rewind not (yet) implemented for this kind of trajectory file";
   }
 
+  virtual long long int nOfFrames() {
+    return -1;
+  }
+
+  virtual std::optional<std::string> seekFrame(std::size_t /*frame*/) {
+    return "random access is not (yet) implemented for this kind of trajectory file";
+  }
+
+  /// By default a frame is skipped by reading it in a scratch buffer
+  virtual std::optional<std::string> skipFrame() {
+    long long int step=0;
+    double timeStep=-1.0;
+    auto error=readHeader(step,timeStep);
+    if(error) {
+      return error;
+    }
+    std::vector<double> masses(natoms),charges(natoms),coordinates(3*natoms),cell(9);
+    return readAtoms(1,false,false,0,natoms,step,
+                     masses.data(),charges.data(),coordinates.data(),cell.data());
+  }
+
 };
 namespace {
 
@@ -567,10 +599,195 @@ struct xd_deleter {
 };
 
 enum class xdType {trr,xtc};
+
+/// Skip a frame of a xtc or trr file reading only its header
+template <xdType is>
+int xdSkip(xdrfile::XDRFILE* xd,int& step,float& time) {
+  int nat;
+  if constexpr(is == xdType::xtc) {
+    return xdrfile::skip_xtc(xd,&nat,&step,&time);
+  } else {
+    return xdrfile::skip_trr(xd,&nat,&step,&time);
+  }
+}
+
+/// The position of the frames in a xtc or trr file.
+/// The index is saved in a sidecar file (the name of the trajectory followed by .idx)
+/// so that it is built only once. When the trajectory grows the index is extended.
+/// The size and the modification time of the trajectory are stored in the index:
+/// if they have not changed the index is used as it is, otherwise the frames that
+/// were indexed are checked before the index is extended.
+struct xdIndex {
+  struct Frame {
+    std::int64_t offset;
+    std::int64_t step;
+    double time;
+  };
+  std::vector<Frame> frames;
+/// The number of bytes of the trajectory that have been indexed
+  std::int64_t end=0;
+/// The size and the modification time of the trajectory when it was indexed
+  std::int64_t trajectorySize=-1;
+  std::int64_t trajectoryTime=-1;
+  static constexpr char magic[9]="PLMDTIDX";
+  static constexpr std::uint32_t version=2;
+
+  /// Get the size and the modification time (in nanoseconds) of a file, -1 if they are not available
+  static std::pair<std::int64_t,std::int64_t> stamp(const std::string& file) {
+#ifdef PLUMED_TRAJECTORY_INDEX_STAT
+    struct stat st;
+    if(::stat(file.c_str(),&st)==0) {
+#ifdef __APPLE__
+      const auto& mtime=st.st_mtimespec;
+#else
+      const auto& mtime=st.st_mtim;
+#endif
+      return {static_cast<std::int64_t>(st.st_size),
+              static_cast<std::int64_t>(mtime.tv_sec)*1000000000+static_cast<std::int64_t>(mtime.tv_nsec)};
+    }
+#else
+    (void) file;
+#endif
+    return {-1,-1};
+  }
+
+  void load(const std::string& path) {
+    frames.clear();
+    end=0;
+    trajectorySize=trajectoryTime=-1;
+    safeFile fp(std::fopen(path.c_str(),"rb"));
+    if(!fp) {
+      return;
+    }
+    char m[8];
+    std::uint32_t v;
+    std::uint64_t n;
+    if(std::fread(m,1,8,fp.get())!=8 || std::memcmp(m,magic,8)!=0
+        || std::fread(&v,sizeof(v),1,fp.get())!=1 || v!=version
+        || std::fread(&trajectorySize,sizeof(trajectorySize),1,fp.get())!=1
+        || std::fread(&trajectoryTime,sizeof(trajectoryTime),1,fp.get())!=1
+        || std::fread(&end,sizeof(end),1,fp.get())!=1
+        || std::fread(&n,sizeof(n),1,fp.get())!=1) {
+      end=0;
+      trajectorySize=trajectoryTime=-1;
+      return;
+    }
+    frames.resize(n);
+    if(n>0 && std::fread(frames.data(),sizeof(Frame),n,fp.get())!=n) {
+      frames.clear();
+      end=0;
+    }
+  }
+
+  /// the index is written on a temporary file that is then renamed,
+  /// failures are ignored since the index can always be built again.
+  /// The name of the temporary file contains the process id, so that
+  /// processes that index the same trajectory do not write on the same file
+  void save(const std::string& path) const {
+#ifdef PLUMED_TRAJECTORY_INDEX_STAT
+    const std::string tmp=path+".tmp."+std::to_string(::getpid());
+#else
+    const std::string tmp=path+".tmp";
+#endif
+    {
+      safeFile fp(std::fopen(tmp.c_str(),"wb"));
+      if(!fp) {
+        return;
+      }
+      const std::uint64_t n=frames.size();
+      bool ok=std::fwrite(magic,1,8,fp.get())==8
+              && std::fwrite(&version,sizeof(version),1,fp.get())==1
+              && std::fwrite(&trajectorySize,sizeof(trajectorySize),1,fp.get())==1
+              && std::fwrite(&trajectoryTime,sizeof(trajectoryTime),1,fp.get())==1
+              && std::fwrite(&end,sizeof(end),1,fp.get())==1
+              && std::fwrite(&n,sizeof(n),1,fp.get())==1;
+      if(ok && n>0) {
+        ok=std::fwrite(frames.data(),sizeof(Frame),n,fp.get())==n;
+      }
+      if(!ok) {
+        fp.reset();
+        std::remove(tmp.c_str());
+        return;
+      }
+    }
+    std::rename(tmp.c_str(),path.c_str());
+  }
+
+  /// Load the index of a trajectory and extend it to the end of the file
+  template <xdType is>
+  void build(const std::string& trajectoryFile) {
+    const std::string path=trajectoryFile+".idx";
+    load(path);
+    const auto current=stamp(trajectoryFile);
+    // the trajectory has not been modified since it was indexed
+    if(!frames.empty() && current.first>=0 && current.first==trajectorySize && current.second==trajectoryTime) {
+      return;
+    }
+    // a separate handle is used, so that the reading position is not changed
+    std::unique_ptr<xdrfile::XDRFILE, xd_deleter> scan(xdrfile::xdrfile_open(trajectoryFile.c_str(),"r"));
+    if(!scan) {
+      return;
+    }
+    xdrfile::xdrfile_seek(scan.get(),0,SEEK_END);
+    const std::int64_t size=xdrfile::xdrfile_tell(scan.get());
+    int step;
+    float time;
+    // the trajectory has been modified: check that the first and the last indexed
+    // frames are still where the index says before extending the index
+    if(!frames.empty()) {
+      const Frame& first(frames.front());
+      const Frame& last(frames.back());
+      bool valid=end<=size;
+      valid=valid && xdrfile::xdrfile_seek(scan.get(),first.offset,SEEK_SET)==0
+            && xdSkip<is>(scan.get(),step,time)==xdrfile::exdrOK
+            && step==first.step && time==first.time;
+      valid=valid && xdrfile::xdrfile_seek(scan.get(),last.offset,SEEK_SET)==0
+            && xdSkip<is>(scan.get(),step,time)==xdrfile::exdrOK
+            && step==last.step && time==last.time
+            && xdrfile::xdrfile_tell(scan.get())==end;
+      if(!valid) {
+        frames.clear();
+        end=0;
+      }
+    }
+    trajectorySize=current.first;
+    trajectoryTime=current.second;
+    if(end==size && !frames.empty()) {
+      save(path);
+      return;
+    }
+    xdrfile::xdrfile_seek(scan.get(),end,SEEK_SET);
+    while(true) {
+      const std::int64_t offset=xdrfile::xdrfile_tell(scan.get());
+      if(xdSkip<is>(scan.get(),step,time)!=xdrfile::exdrOK) {
+        break;
+      }
+      const std::int64_t next=xdrfile::xdrfile_tell(scan.get());
+      // the last frame might be incomplete if the trajectory is still being written
+      if(next>size) {
+        break;
+      }
+      frames.push_back(Frame{offset,step,time});
+      end=next;
+    }
+    save(path);
+  }
+};
+
 template <xdType is>
 class xdParser final: public fileParser {
   // owning pointer
   std::unique_ptr<PLMD::xdrfile::XDRFILE, xd_deleter> xd{nullptr,{}};
+  std::string trajectoryFile;
+  std::unique_ptr<xdIndex> index;
+  /// the index is built when random access is needed for the first time
+  const xdIndex& getIndex() {
+    if(!index) {
+      index=Tools::make_unique<xdIndex>();
+      index->build<is>(trajectoryFile);
+    }
+    return *index;
+  }
 
   template <typename real>
   std::optional<std::string> readAtoms_t(int stride,
@@ -626,7 +843,7 @@ public:
                                   std::string_view fname,
                                   int command_line_natoms=-1) override {
     using trajfmt=TrajectoryParser::trajfmt;
-    std::string trajectoryFile=std::string(fname);
+    trajectoryFile=std::string(fname);
     auto trajectory_fmt =TrajectoryParser::FMTfromString(fmt);
     xd.reset(xdrfile::xdrfile_open(trajectoryFile.c_str(),"r"));
     if(!xd) {
@@ -657,6 +874,38 @@ public:
   }
   //see the template readAtoms_t for the implementation
   READATOMS;
+
+  /// the header contains the size of the frame, the coordinates are not decompressed
+  std::optional<std::string> skipFrame() override {
+    int localstep;
+    float time;
+    if(xdSkip<is>(xd.get(),localstep,time)!=xdrfile::exdrOK) {
+      return "EOF";
+    }
+    return std::nullopt;
+  }
+
+  long long int nOfFrames() override {
+    return getIndex().frames.size();
+  }
+
+  std::optional<std::string> seekFrame(std::size_t frame) override {
+    const auto & frames=getIndex().frames;
+    if(frame>=frames.size()) {
+      return "EOF";
+    }
+    if(xdrfile::xdrfile_seek(xd.get(),frames[frame].offset,SEEK_SET)!=0) {
+      return "ERROR: Error moving to frame "+std::to_string(frame)+" of trajectory file "+trajectoryFile;
+    }
+    return std::nullopt;
+  }
+
+  std::optional<std::string> rewind() override {
+    if(xdrfile::xdrfile_seek(xd.get(),0,SEEK_SET)!=0) {
+      return "ERROR: Error rewinding trajectory file";
+    }
+    return std::nullopt;
+  }
 };
 
 #ifdef __PLUMED_HAS_MOLFILE_PLUGINS
@@ -1097,4 +1346,16 @@ std::optional<std::string> TrajectoryParser::rewind() {
   return parser->rewind();
 }
 
+std::optional<std::string> TrajectoryParser::skipFrame() {
+  return parser->skipFrame();
+}
+
+long long int TrajectoryParser::nOfFrames() {
+  return parser->nOfFrames();
+}
+
+std::optional<std::string> TrajectoryParser::seekFrame(std::size_t frame) {
+  return parser->seekFrame(frame);
+}
+
 } // namespace PLMD
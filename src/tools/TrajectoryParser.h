@@ -113,6 +113,17 @@ public:
   int nOfAtoms() const;
   /// Return the file pointer to the initial position (use at your own risk)
   std::optional<std::string> rewind();
+  /// Move to the next frame without returning it ("EOF" at the end of the file).
+  /// For xtc and trr files the coordinates are not decoded.
+  std::optional<std::string> skipFrame();
+  /// Return the number of frames, or -1 if it cannot be known without reading the whole file.
+  /// For xtc and trr files the position of the frames is stored in an index file
+  /// (the name of the trajectory followed by .idx) that is built the first time it is needed
+  /// and reused later.
+  long long int nOfFrames();
+  /// Move to a frame (counting from 0), so that it is returned by the next readFrame().
+  /// Only implemented for xtc and trr files, using the index.
+  std::optional<std::string> seekFrame(std::size_t frame);
 };
 } //namespace PLMD
 #endif //__PLUMED_tools_TrajectoryParser_h
@@ -0,0 +1,151 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "TrajectoryPrefetcher.h"
+#include "TrajectoryParser.h"
+#include "Exception.h"
+
+#include <cmath>
+#include <limits>
+
+namespace PLMD {
+
+template<typename real>
+TrajectoryPrefetcher<real>::TrajectoryPrefetcher(TrajectoryParser& trajectoryParser,unsigned nframes,int trajectoryStride,bool nopbc,long long int firstStep,unsigned every):
+  parser(trajectoryParser),
+  stride(trajectoryStride),
+  frameStride(every),
+  dont_read_pbc(nopbc),
+  step(firstStep),
+  ring(nframes) {
+  plumed_massert(nframes>0,"at least one frame should be read ahead");
+  plumed_massert(frameStride>0,"the frame stride should be positive");
+  thread=std::thread([this] {run();});
+}
+
+template<typename real>
+TrajectoryPrefetcher<real>::~TrajectoryPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop=true;
+  }
+  cv.notify_all();
+  thread.join();
+}
+
+template<typename real>
+void TrajectoryPrefetcher<real>::run() {
+  constexpr real nan=std::numeric_limits<real>::quiet_NaN();
+  std::size_t tail=0;
+  bool first=true;
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock,[this] {return stop || ready<ring.size();});
+      if(stop) {
+        return;
+      }
+    }
+    // this buffer is not visible to the consumer until ready is increased,
+    // so it can be filled without holding the lock
+    Frame& frame(ring[tail]);
+    frame.error.reset();
+    frame.exception=nullptr;
+    try {
+      // the frames between two frames that are read are skipped
+      for(unsigned i=1; i<frameStride && !first && !frame.error; i++) {
+        frame.error=parser.skipFrame();
+        step+=stride;
+      }
+      first=false;
+      real timeStep=-1.0;
+      if(!frame.error) {
+        frame.error=parser.readHeader(step,timeStep);
+      }
+      if(!frame.error) {
+        const int natoms=parser.nOfAtoms();
+        // assign does not reallocate as long as the number of atoms does not grow
+        frame.masses.assign(natoms,nan);
+        frame.charges.assign(natoms,nan);
+        frame.coordinates.assign(3*natoms,real(0.0));
+        frame.cell.assign(9,real(0.0));
+        frame.natoms=natoms;
+        frame.timeStep=timeStep;
+        frame.error=parser.readAtoms(stride,dont_read_pbc,false,0,natoms,step,
+                                     frame.masses.data(),frame.charges.data(),
+                                     frame.coordinates.data(),frame.cell.data());
+      }
+      frame.step=step;
+    } catch(...) {
+      frame.exception=std::current_exception();
+    }
+    const bool last=frame.error || frame.exception;
+    step+=stride;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      ready++;
+    }
+    cv.notify_all();
+    if(last) {
+      return;
+    }
+    tail=(tail+1)%ring.size();
+  }
+}
+
+template<typename real>
+const typename TrajectoryPrefetcher<real>::Frame& TrajectoryPrefetcher<real>::acquire() {
+  std::unique_lock<std::mutex> lock(mtx);
+  cv.wait(lock,[this] {return ready>0;});
+  const Frame& frame(ring[head]);
+  if(frame.exception) {
+    std::rethrow_exception(frame.exception);
+  }
+  return frame;
+}
+
+template<typename real>
+void TrajectoryPrefetcher<real>::release() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    plumed_assert(ready>0);
+    ready--;
+    head=(head+1)%ring.size();
+  }
+  cv.notify_all();
+}
+
+template<typename real>
+void TrajectoryPrefetcher<real>::copyMassesAndCharges(const Frame& frame,real* masses,real* charges) {
+  for(int i=0; i<frame.natoms; i++) {
+    if(!std::isnan(frame.masses[i])) {
+      masses[i]=frame.masses[i];
+    }
+    if(!std::isnan(frame.charges[i])) {
+      charges[i]=frame.charges[i];
+    }
+  }
+}
+
+template class TrajectoryPrefetcher<float>;
+template class TrajectoryPrefetcher<double>;
+
+}
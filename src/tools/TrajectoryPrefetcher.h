@@ -0,0 +1,104 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_TrajectoryPrefetcher_h
+#define __PLUMED_tools_TrajectoryPrefetcher_h
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PLMD {
+
+class TrajectoryParser;
+
+/**
+\ingroup TOOLBOX
+Reads the frames of a trajectory ahead of time on a separate thread.
+
+The frames are read with TrajectoryParser::readFrame into a ring of buffers
+that are allocated once, so that reading and decoding the next frames
+overlaps with the analysis of the current one. The consumer takes the
+oldest frame with acquire(), uses it, and gives the buffer back with release().
+
+Errors, including the "EOF" message, are stored in the frame where they were
+found and the reading thread stops there. Exceptions thrown while reading are
+rethrown by acquire().
+
+The parser must not be used by anybody else while the prefetcher is alive.
+*/
+template<typename real>
+class TrajectoryPrefetcher {
+public:
+/// A frame read from the trajectory
+  struct Frame {
+    long long int step=0;
+    real timeStep=-1.0;
+    int natoms=0;
+    std::vector<real> masses;
+    std::vector<real> charges;
+    std::vector<real> coordinates;
+    std::vector<real> cell;
+/// Error found while reading this frame ("EOF" at the end of the trajectory)
+    std::optional<std::string> error;
+    std::exception_ptr exception;
+  };
+private:
+  TrajectoryParser& parser;
+  const int stride;
+/// Only one frame every frameStride frames is read, the others are skipped
+  const unsigned frameStride;
+  const bool dont_read_pbc;
+/// The step of the next frame, as the driver would compute it
+  long long int step;
+  std::vector<Frame> ring;
+/// First frame to be consumed and number of frames ready
+  std::size_t head=0;
+  std::size_t ready=0;
+  bool stop=false;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::thread thread;
+  void run();
+public:
+/// Start reading nframes frames ahead.
+/// firstStep is the step of the first frame, the following frames are separated by trajectoryStride
+/// steps unless the trajectory provides the step itself.
+/// If every is larger than one, only one frame every every frames is read.
+  TrajectoryPrefetcher(TrajectoryParser& trajectoryParser,unsigned nframes,int trajectoryStride,bool nopbc,long long int firstStep,unsigned every=1);
+  ~TrajectoryPrefetcher();
+  TrajectoryPrefetcher(const TrajectoryPrefetcher&) = delete;
+  TrajectoryPrefetcher& operator=(const TrajectoryPrefetcher&) = delete;
+/// Wait for the next frame. The frame remains valid until release() is called.
+  const Frame& acquire();
+/// Give the buffer of the frame returned by acquire() back to the reading thread
+  void release();
+/// Copy masses and charges that were read from the trajectory (i.e. that are not NaN)
+  static void copyMassesAndCharges(const Frame& frame,real* masses,real* charges);
+};
+
+}
+
+#endif
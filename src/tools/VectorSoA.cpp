@@ -0,0 +1,90 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "VectorSoA.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace PLMD {
+
+VectorSoA::VectorSoA( std::size_t size ) {
+  resize( size );
+}
+
+VectorSoA::VectorSoA( const VectorSoA& other ) {
+  *this=other;
+}
+
+VectorSoA& VectorSoA::operator=( const VectorSoA& other ) {
+  if( this!=&other ) {
+    resize( other.n );
+    if( n>0 ) {
+      std::copy( other.xp, other.xp+3*stride, xp );
+    }
+  }
+  return *this;
+}
+
+VectorSoA::VectorSoA( VectorSoA&& other ) noexcept {
+  *this=std::move( other );
+}
+
+VectorSoA& VectorSoA::operator=( VectorSoA&& other ) noexcept {
+  if( this!=&other ) {
+    memory=std::move( other.memory );
+    xp=std::exchange( other.xp, nullptr );
+    yp=std::exchange( other.yp, nullptr );
+    zp=std::exchange( other.zp, nullptr );
+    n=std::exchange( other.n, 0 );
+    stride=std::exchange( other.stride, 0 );
+  }
+  return *this;
+}
+
+void VectorSoA::resize( std::size_t size ) {
+  if( size==n && memory ) {
+    return;
+  }
+  n=size;
+  stride=( (n+padding-1)/padding )*padding;
+  if( n==0 ) {
+    memory.reset();
+    xp=yp=zp=nullptr;
+    return;
+  }
+  // the extra elements are used to align the start of the first array
+  memory.reset( new double[3*stride+padding]() );
+  const auto address=reinterpret_cast<std::uintptr_t>( memory.get() );
+  const std::size_t shift=( (alignment - address%alignment)%alignment )/sizeof(double);
+  xp=memory.get()+shift;
+  yp=xp+stride;
+  zp=yp+stride;
+}
+
+void VectorSoA::assign( View<const Vector> v ) {
+  resize( v.size() );
+  for(std::size_t i=0; i<n; ++i) {
+    set( i, v[i] );
+  }
+}
+
+}
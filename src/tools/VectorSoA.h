@@ -0,0 +1,112 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_VectorSoA_h
+#define __PLUMED_tools_VectorSoA_h
+
+#include "Vector.h"
+#include "View.h"
+#include <cstddef>
+#include <memory>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+A structure-of-arrays copy of a list of Vector.
+
+The x, y and z components are stored in three separate arrays, so that loops
+that only need some of the components or that process many vectors at once
+read contiguous memory and can be vectorized by the compiler:
+
+\verbatim
+VectorSoA pos( n );
+for(unsigned i=0; i<n; ++i) pos.set( i, positions[i] );
+const double* x=pos.x();
+#pragma omp simd
+for(unsigned i=0; i<n; ++i) ...
+\endverbatim
+
+Each array starts on a cache line and is padded to a multiple of the
+alignment, the padding elements are set to zero.
+*/
+class VectorSoA {
+  /// Alignment of each of the three arrays, in bytes
+  static constexpr std::size_t alignment=64;
+  /// Number of doubles in alignment bytes
+  static constexpr std::size_t padding=alignment/sizeof(double);
+  std::unique_ptr<double[]> memory;
+  double* xp=nullptr;
+  double* yp=nullptr;
+  double* zp=nullptr;
+  std::size_t n=0;
+  /// Distance between the starts of the three arrays
+  std::size_t stride=0;
+public:
+  VectorSoA()=default;
+  explicit VectorSoA( std::size_t size );
+  VectorSoA( const VectorSoA& other );
+  VectorSoA& operator=( const VectorSoA& other );
+  /// The moved-from object is left empty
+  VectorSoA( VectorSoA&& other ) noexcept;
+  VectorSoA& operator=( VectorSoA&& other ) noexcept;
+  /// Change the number of vectors, the content is not preserved
+  void resize( std::size_t size );
+  /// The number of vectors
+  std::size_t size() const {
+    return n;
+  }
+  /// Set the i-th vector
+  void set( std::size_t i, const Vector& v ) {
+    xp[i]=v[0];
+    yp[i]=v[1];
+    zp[i]=v[2];
+  }
+  /// Get the i-th vector
+  Vector get( std::size_t i ) const {
+    return Vector( xp[i], yp[i], zp[i] );
+  }
+  /// Copy all the vectors from an array of Vector
+  void assign( View<const Vector> v );
+  /// Pointers to the arrays with the three components
+  const double* x() const {
+    return xp;
+  }
+  const double* y() const {
+    return yp;
+  }
+  const double* z() const {
+    return zp;
+  }
+  double* x() {
+    return xp;
+  }
+  double* y() {
+    return yp;
+  }
+  double* z() {
+    return zp;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "WorkStealingScheduler.h"
+#include "Exception.h"
+#include "Tools.h"
+
+namespace PLMD {
+
+WorkStealingScheduler::WorkStealingScheduler():
+  chunks_per_thread(8),
+  nthreads(0),
+  nsteps(0),
+  sum_imbalance(0),
+  max_imbalance(0),
+  nsteals(0),
+  nchunks(0) {
+}
+
+void WorkStealingScheduler::setChunksPerThread( unsigned n ) {
+  plumed_assert( n>0 );
+  chunks_per_thread=n;
+}
+
+void WorkStealingScheduler::resizeTasks( std::size_t ntasks ) {
+  // Tasks that have never been run are assumed to all have the same cost
+  if( taskcost.size()!=ntasks ) {
+    taskcost.assign( ntasks, 1.0 );
+  }
+}
+
+void WorkStealingScheduler::resetThreadTimes( unsigned nt ) {
+  thread_time.assign( nt, 0.0 );
+}
+
+void WorkStealingScheduler::distribute( unsigned nt ) {
+  plumed_assert( nt>0 );
+  unsigned nitems=itemcost.size();
+  double totcost=0;
+  for(const auto & c : itemcost) {
+    totcost += c;
+  }
+  // Split the items into chunks that all have approximately the same cost
+  chunk_start.resize(0);
+  chunk_start.push_back(0);
+  double target = totcost / (nt*chunks_per_thread), accum=0;
+  for(unsigned i=0; i<nitems; ++i) {
+    accum += itemcost[i];
+    if( accum>=target && i+1<nitems ) {
+      chunk_start.push_back(i+1);
+      accum=0;
+    }
+  }
+  chunk_start.push_back(nitems);
+  unsigned nc = chunk_start.size()-1;
+  // Now give each thread a contiguous range of chunks with the same total cost
+  thread_start.resize(nt+1);
+  thread_start[0]=0;
+  unsigned t=1;
+  double share = totcost / nt;
+  accum=0;
+  for(unsigned c=0; c<nc && t<nt; ++c) {
+    for(unsigned i=chunk_start[c]; i<chunk_start[c+1]; ++i) {
+      accum += itemcost[i];
+    }
+    while( t<nt && accum>=t*share ) {
+      thread_start[t]=c+1;
+      ++t;
+    }
+  }
+  for(; t<=nt; ++t) {
+    thread_start[t]=nc;
+  }
+  if( nthreads!=nt ) {
+    next_chunk.reset( new std::atomic<unsigned>[nt] );
+    nthreads=nt;
+  }
+  for(unsigned i=0; i<nt; ++i) {
+    next_chunk[i].store( thread_start[i], std::memory_order_relaxed );
+  }
+  nchunks += nc;
+  resetThreadTimes( nt );
+}
+
+bool WorkStealingScheduler::nextChunk( unsigned t, unsigned& begin, unsigned& end ) {
+  // Work on the chunks that were assigned to this thread first and then steal from the others
+  for(unsigned k=0; k<nthreads; ++k) {
+    unsigned victim = (t+k)%nthreads;
+    if( next_chunk[victim].load( std::memory_order_relaxed )>=thread_start[victim+1] ) {
+      continue;
+    }
+    unsigned c = next_chunk[victim].fetch_add( 1, std::memory_order_relaxed );
+    if( c<thread_start[victim+1] ) {
+      if( k>0 ) {
+        nsteals.fetch_add( 1, std::memory_order_relaxed );
+      }
+      begin=chunk_start[c];
+      end=chunk_start[c+1];
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingScheduler::finishStep() {
+  if( thread_time.size()<2 ) {
+    return;
+  }
+  double tmax=0, tsum=0;
+  for(const auto & tt : thread_time) {
+    tsum += tt;
+    tmax = tmax>tt ? tmax : tt;
+  }
+  if( !(tsum>0) ) {
+    return;
+  }
+  double imbalance = tmax*thread_time.size() / tsum;
+  sum_imbalance += imbalance;
+  max_imbalance = max_imbalance>imbalance ? max_imbalance : imbalance;
+  nsteps++;
+}
+
+std::string WorkStealingScheduler::report( const std::string& name ) const {
+  std::string str="  load imbalance for " + name + " (max/average thread time): ";
+  if( nsteps==0 ) {
+    return str + "no data\n";
+  }
+  std::string avstr, maxstr, nststr;
+  Tools::convert( sum_imbalance/nsteps, avstr );
+  Tools::convert( max_imbalance, maxstr );
+  Tools::convert( nsteps, nststr );
+  str += "average " + avstr + " worst " + maxstr + " over " + nststr + " calls";
+  if( nchunks>0 ) {
+    std::string nchstr, nstealstr;
+    Tools::convert( nchunks, nchstr );
+    Tools::convert( nsteals.load(), nstealstr );
+    str += ", " + nstealstr + " of " + nchstr + " chunks stolen";
+  }
+  return str + "\n";
+}
+
+}
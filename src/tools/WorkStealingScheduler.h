@@ -0,0 +1,131 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2025 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_WorkStealingScheduler_h
+#define __PLUMED_tools_WorkStealingScheduler_h
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+Cost-balanced, chunked work-stealing scheduler for OpenMP task loops.
+
+The items that have to be processed are split in chunks that all have roughly
+the same estimated cost.  Each thread is then given a contiguous range of chunks
+with approximately the same total cost.  When a thread finishes its own chunks it
+steals the remaining chunks of the other threads.  The cost of each task is measured
+while the tasks are run so the partition adapts to the work that is done in every step.
+
+\verbatim
+WorkStealingScheduler ws;
+ws.resizeTasks( ntasks );
+ws.prepare( nitems, nthreads, [&](unsigned i) { return itemtask[i]; } );
+#pragma omp parallel num_threads(nthreads)
+{
+  unsigned t=OpenMP::getThreadNum(), begin, end;
+  while( ws.nextChunk( t, begin, end ) ) {
+    for(unsigned i=begin; i<end; ++i) { ... }
+  }
+}
+\endverbatim
+
+The class also collects statistics on the load imbalance between the threads,
+which are reported by report().
+*/
+class WorkStealingScheduler {
+private:
+/// The number of chunks each thread should have in a perfectly balanced step
+  unsigned chunks_per_thread;
+/// The measured cost of each task
+  std::vector<double> taskcost;
+/// The estimated cost of each of the items that are being scheduled
+  std::vector<double> itemcost;
+/// The first item in each chunk (the last element is the total number of items)
+  std::vector<unsigned> chunk_start;
+/// The first chunk that is owned by each thread (the last element is the number of chunks)
+  std::vector<unsigned> thread_start;
+/// The next chunk that will be processed from the range of each thread
+  std::unique_ptr<std::atomic<unsigned>[]> next_chunk;
+/// The number of threads the chunks have been distributed over
+  unsigned nthreads;
+/// The time that has been spent by each thread during this step
+  std::vector<double> thread_time;
+/// Statistics on the load imbalance
+  unsigned long nsteps;
+  double sum_imbalance;
+  double max_imbalance;
+  std::atomic<unsigned long> nsteals;
+  unsigned long nchunks;
+public:
+  WorkStealingScheduler();
+/// Set the number of chunks each thread should have
+  void setChunksPerThread( unsigned n );
+/// Make sure that there is space to store the cost of ntasks tasks
+  void resizeTasks( std::size_t ntasks );
+/// Get the estimated cost for a task
+  double getTaskCost( std::size_t task ) const {
+    return taskcost[task];
+  }
+/// Set the measured cost of a task
+  void setTaskCost( std::size_t task, double cost ) {
+    taskcost[task]=cost;
+  }
+/// Divide nitems items into cost balanced chunks. taskOf returns the task that is performed for each item
+  template<typename F>
+  void prepare( unsigned nitems, unsigned nt, F taskOf );
+/// Get the next chunk of items for thread t.  Returns false if there is no work left
+  bool nextChunk( unsigned t, unsigned& begin, unsigned& end );
+/// Reset the timers for the nt threads that are used in this step
+  void resetThreadTimes( unsigned nt );
+/// Record the time spent by thread t doing tasks during this step
+  void addThreadTime( unsigned t, double time ) {
+    thread_time[t]+=time;
+  }
+/// Update the load imbalance statistics at the end of a step
+  void finishStep();
+/// Have any statistics been collected
+  bool hasStatistics() const {
+    return nsteps>0;
+  }
+/// Write a report with the statistics on the load imbalance
+  std::string report( const std::string& name ) const ;
+private:
+/// Distribute the chunks over the threads using the cost of each item
+  void distribute( unsigned nt );
+};
+
+template<typename F>
+void WorkStealingScheduler::prepare( unsigned nitems, unsigned nt, F taskOf ) {
+  itemcost.resize( nitems );
+  for(unsigned i=0; i<nitems; ++i) {
+    itemcost[i] = taskcost[ taskOf(i) ];
+  }
+  distribute( nt );
+}
+
+}
+
+#endif
@@ -100,6 +100,7 @@ public:
   static void registerKeywords(Keywords&);
   explicit BF_Chebyshev(const ActionOptions&);
   void getAllValues(const double, double&, bool&, std::vector<double>&, std::vector<double>&) const override;
+  void getAllValuesOnPoints(const std::vector<double>&, std::vector<double>&, std::vector<double>&) const override;
 };
 
 
@@ -150,6 +151,44 @@ void BF_Chebyshev::getAllValues(const double arg, double& argT, bool& inside_ran
 }
 
 
+void BF_Chebyshev::getAllValuesOnPoints(const std::vector<double>& args, std::vector<double>& values, std::vector<double>& derivs) const {
+  // the recurrence relation is applied to all the points at once
+  const size_t npoints=args.size();
+  values.resize(getNumberOfBasisFunctions()*npoints);
+  derivs.resize(getNumberOfBasisFunctions()*npoints);
+  std::vector<double> derivsT(derivs.size());
+  std::vector<double> argsT(npoints);
+  std::vector<char> inside(npoints);
+  for(size_t k=0; k<npoints; k++) {
+    bool inside_range=true;
+    argsT[k]=translateArgument(args[k], inside_range);
+    inside[k]=inside_range;
+    values[k]=1.0;
+    derivsT[k]=0.0;
+    values[npoints+k]=argsT[k];
+    derivsT[npoints+k]=1.0;
+  }
+  for(unsigned int i=1; i < getOrder(); i++) {
+    const double* v0 = values.data()+(i-1)*npoints;
+    const double* v1 = v0+npoints;
+    double* v2 = values.data()+(i+1)*npoints;
+    const double* d0 = derivsT.data()+(i-1)*npoints;
+    const double* d1 = d0+npoints;
+    double* d2 = derivsT.data()+(i+1)*npoints;
+    #pragma omp simd
+    for(size_t k=0; k<npoints; k++) {
+      v2[k] = 2.0*argsT[k]*v1[k]-v0[k];
+      d2[k] = 2.0*v1[k]+2.0*argsT[k]*d1[k]-d0[k];
+    }
+  }
+  for(unsigned int i=0; i < getNumberOfBasisFunctions(); i++) {
+    for(size_t k=0; k<npoints; k++) {
+      derivs[i*npoints+k] = inside[k] ? intervalDerivf()*derivsT[i*npoints+k] : 0.0;
+    }
+  }
+}
+
+
 void BF_Chebyshev::setupUniformIntegrals() {
   for(unsigned int i=0; i<numberOfBasisFunctions(); i++) {
     double io = i;
@@ -108,6 +108,7 @@ public:
   static void registerKeywords(Keywords&);
   explicit BF_Legendre(const ActionOptions&);
   void getAllValues(const double, double&, bool&, std::vector<double>&, std::vector<double>&) const override;
+  void getAllValuesOnPoints(const std::vector<double>&, std::vector<double>&, std::vector<double>&) const override;
 };
 
 
@@ -172,6 +173,50 @@ void BF_Legendre::getAllValues(const double arg, double& argT, bool& inside_rang
 }
 
 
+void BF_Legendre::getAllValuesOnPoints(const std::vector<double>& args, std::vector<double>& values, std::vector<double>& derivs) const {
+  // the recurrence relation is applied to all the points at once
+  const size_t npoints=args.size();
+  values.resize(getNumberOfBasisFunctions()*npoints);
+  derivs.resize(getNumberOfBasisFunctions()*npoints);
+  std::vector<double> derivsT(derivs.size());
+  std::vector<double> argsT(npoints);
+  std::vector<char> inside(npoints);
+  for(size_t k=0; k<npoints; k++) {
+    bool inside_range=true;
+    argsT[k]=translateArgument(args[k], inside_range);
+    inside[k]=inside_range;
+    values[k]=1.0;
+    derivsT[k]=0.0;
+    values[npoints+k]=argsT[k];
+    derivsT[npoints+k]=1.0;
+  }
+  for(unsigned int i=1; i < getOrder(); i++) {
+    const double io = static_cast<double>(i);
+    const double a = (2.0*io+1.0)/(io+1.0);
+    const double b = io/(io+1.0);
+    const double* v0 = values.data()+(i-1)*npoints;
+    const double* v1 = v0+npoints;
+    double* v2 = values.data()+(i+1)*npoints;
+    const double* d0 = derivsT.data()+(i-1)*npoints;
+    const double* d1 = d0+npoints;
+    double* d2 = derivsT.data()+(i+1)*npoints;
+    #pragma omp simd
+    for(size_t k=0; k<npoints; k++) {
+      v2[k] = a*argsT[k]*v1[k] - b*v0[k];
+      d2[k] = a*(v1[k]+argsT[k]*d1[k]) - b*d0[k];
+    }
+  }
+  for(unsigned int i=0; i < getNumberOfBasisFunctions(); i++) {
+    // L0 is also scaled!
+    const double sf = scaled_ ? sqrt(static_cast<double>(i)+0.5) : 1.0;
+    for(size_t k=0; k<npoints; k++) {
+      values[i*npoints+k] *= sf;
+      derivs[i*npoints+k] = inside[k] ? sf*intervalDerivf()*derivsT[i*npoints+k] : 0.0;
+    }
+  }
+}
+
+
 void BF_Legendre::setupUniformIntegrals() {
   setAllUniformIntegralsToZero();
   double L0_int = 1.0;
@@ -379,6 +379,24 @@ void BasisFunctions::getMultipleValue(const std::vector<double>& args, std::vect
 }
 
 
+void BasisFunctions::getAllValuesOnPoints(const std::vector<double>& args, std::vector<double>& values, std::vector<double>& derivs) const {
+  const size_t npoints=args.size();
+  values.resize(getNumberOfBasisFunctions()*npoints);
+  derivs.resize(getNumberOfBasisFunctions()*npoints);
+  std::vector<double> tmp_values(getNumberOfBasisFunctions());
+  std::vector<double> tmp_derivs(getNumberOfBasisFunctions());
+  for(size_t k=0; k<npoints; k++) {
+    double argT;
+    bool inside_interval=true;
+    getAllValues(args[k],argT,inside_interval,tmp_values,tmp_derivs);
+    for(unsigned int n=0; n<getNumberOfBasisFunctions(); n++) {
+      values[n*npoints+k]=tmp_values[n];
+      derivs[n*npoints+k]=tmp_derivs[n];
+    }
+  }
+}
+
+
 void BasisFunctions::writeBasisFunctionsToFile(OFile& ofile_values, OFile& ofile_derivs, const std::string& min_in, const std::string& max_in, unsigned int nbins_in, const bool ignore_periodicity, const std::string& output_fmt_values, const std::string& output_fmt_derivs, const bool numerical_deriv) const {
   std::vector<std::string> min(1);
   min[0]=min_in;
@@ -246,6 +246,9 @@ public:
   double getValue(const double, const unsigned int, double&, bool&) const;
   // calculate the values for all basis functions
   virtual void getAllValues(const double, double&, bool&, std::vector<double>&, std::vector<double>&) const = 0;
+  // calculate the values and derivatives of all basis functions on many points,
+  // values[n*npoints+k] is the value of the n-th basis function at the k-th point
+  virtual void getAllValuesOnPoints(const std::vector<double>&, std::vector<double>&, std::vector<double>&) const;
   //virtual void get2ndDerivatives(const double, std::vector<double>&)=0;
   void printInfo() const;
   //
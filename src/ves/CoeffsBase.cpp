@@ -31,6 +31,7 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
 
 
 namespace PLMD {
@@ -55,6 +56,8 @@ CoeffsBase::CoeffsBase(
   ncoeffs_(0),
   coeffs_descriptions_(0),
   dimension_labels_(0),
+  truncation_(""),
+  truncation_max_degree_(0),
   args_(0),
   basisf_(0),
   multicoeffs_(false),
@@ -64,6 +67,8 @@ CoeffsBase::CoeffsBase(
   field_ndimensions_("ndimensions"),
   field_ncoeffs_total_("ncoeffs_total"),
   field_shape_prefix_("shape_"),
+  field_truncation_("truncation"),
+  field_truncation_max_degree_("truncation_max_degree"),
   field_time_("time"),
   field_iteration_("iteration"),
   output_fmt_("%30.16e") {
@@ -91,6 +96,8 @@ CoeffsBase::CoeffsBase(
   ncoeffs_(0),
   coeffs_descriptions_(0),
   dimension_labels_(0),
+  truncation_(""),
+  truncation_max_degree_(0),
   args_(args),
   basisf_(basisf),
   multicoeffs_(false),
@@ -100,6 +107,8 @@ CoeffsBase::CoeffsBase(
   field_ndimensions_("ndimensions"),
   field_ncoeffs_total_("ncoeffs_total"),
   field_shape_prefix_("shape_"),
+  field_truncation_("truncation"),
+  field_truncation_max_degree_("truncation_max_degree"),
   field_time_("time"),
   field_iteration_("iteration"),
   output_fmt_("%30.16e") {
@@ -135,6 +144,8 @@ CoeffsBase::CoeffsBase(
   ncoeffs_(0),
   coeffs_descriptions_(0),
   dimension_labels_(0),
+  truncation_(""),
+  truncation_max_degree_(0),
   args_(0),
   basisf_(0),
   multicoeffs_(true),
@@ -144,6 +155,8 @@ CoeffsBase::CoeffsBase(
   field_ndimensions_("ndimensions"),
   field_ncoeffs_total_("ncoeffs_total"),
   field_shape_prefix_("shape_"),
+  field_truncation_("truncation"),
+  field_truncation_max_degree_("truncation_max_degree"),
   field_time_("time"),
   field_iteration_("iteration"),
   output_fmt_("%30.16e") {
@@ -198,6 +211,66 @@ void CoeffsBase::reinitializeIndices(const std::vector<unsigned int>& indices_sh
   }
   coeffs_descriptions_.clear();
   coeffs_descriptions_.resize(ncoeffs_);
+  if(!truncation_.empty()) {
+    setupTruncatedIndices();
+  }
+}
+
+
+void CoeffsBase::truncateIndices(const std::string& truncation, const unsigned int max_degree) {
+  plumed_massert(coeffs_type_!=MultiCoeffs_LinearBasisSet,"the indices of multiple coeffs sets cannot be truncated");
+  plumed_massert(truncation=="TOTAL_DEGREE" || truncation=="HYPERBOLIC_CROSS","unknown truncation " + truncation + " of the coeffs indices, it should be TOTAL_DEGREE or HYPERBOLIC_CROSS");
+  truncation_=truncation;
+  truncation_max_degree_=max_degree;
+  setupTruncatedIndices();
+  if(coeffs_type_==LinearBasisSet) {
+    setupBasisFunctionsInfo();
+  } else {
+    setAllCoeffsDescriptions();
+  }
+}
+
+
+// Only the indices (n_1,...,n_d) for which n_1+...+n_d <= max_degree (TOTAL_DEGREE) or
+// (n_1+1)*...*(n_d+1) <= max_degree+1 (HYPERBOLIC_CROSS) are kept. The number of coeffs then grows
+// polynomially (TOTAL_DEGREE) or almost linearly (HYPERBOLIC_CROSS) with the number of dimensions
+// instead of exponentially. The indices are generated in the order of the full tensor product,
+// so the constant term is always the first coeff.
+void CoeffsBase::setupTruncatedIndices() {
+  truncated_indices_.clear();
+  truncated_full_index_.clear();
+  std::vector<unsigned int> indices(ndimensions_,0);
+  // the degree used by the indices of the dimensions after the current one
+  std::vector<size_t> used(ndimensions_+1);
+  const bool total_degree = truncation_=="TOTAL_DEGREE";
+  used[ndimensions_] = total_degree ? 0 : 1;
+  const size_t max_degree = total_degree ? truncation_max_degree_ : truncation_max_degree_+1;
+  // the last dimension is the outermost loop, as the first dimension is the one that changes fastest
+  unsigned int k=ndimensions_-1;
+  while(true) {
+    const size_t degree = total_degree ? used[k+1]+indices[k] : used[k+1]*(indices[k]+1);
+    if(indices[k]<indices_shape_[k] && degree<=max_degree) {
+      if(k==0) {
+        truncated_indices_.insert(truncated_indices_.end(),indices.begin(),indices.end());
+        truncated_full_index_.push_back(getFullIndex(indices));
+        indices[0]++;
+      } else {
+        used[k]=degree;
+        k--;
+        indices[k]=0;
+      }
+    } else {
+      // all the allowed indices along this dimension have been used
+      if(k==ndimensions_-1) {
+        break;
+      }
+      k++;
+      indices[k]++;
+    }
+  }
+  ncoeffs_=truncated_full_index_.size();
+  coeffs_descriptions_.clear();
+  coeffs_descriptions_.resize(ncoeffs_);
 }
 
 
@@ -256,6 +329,9 @@ bool CoeffsBase::sameShape(const CoeffsBase& coeffsbase_in) const {
   if(numberOfDimensions()!=coeffsbase_in.numberOfDimensions()) {
     return false;
   }
+  if(truncation_!=coeffsbase_in.truncation_ || truncation_max_degree_!=coeffsbase_in.truncation_max_degree_) {
+    return false;
+  }
   if(numberOfCoeffs()!=coeffsbase_in.numberOfCoeffs()) {
     return false;
   }
@@ -326,6 +402,9 @@ bool CoeffsBase::indicesExist(const std::vector<unsigned int>& indices) const {
       return false;
     }
   }
+  if(!truncation_.empty()) {
+    return std::binary_search(truncated_full_index_.begin(),truncated_full_index_.end(),getFullIndex(indices));
+  }
   return true;
 }
 
@@ -394,6 +473,10 @@ void CoeffsBase::writeCoeffsInfoToFile(OFile& ofile) const {
     ofile.addConstantField(field_shape_prefix_+getDimensionLabel(k));
     ofile.printField(field_shape_prefix_+getDimensionLabel(k),(int) shapeOfIndices(k));
   }
+  if(!truncation_.empty()) {
+    ofile.addConstantField(field_truncation_).printField(field_truncation_,truncation_);
+    ofile.addConstantField(field_truncation_max_degree_).printField(field_truncation_max_degree_,(int) truncation_max_degree_);
+  }
 }
 
 
@@ -429,9 +512,25 @@ void CoeffsBase::getCoeffsInfoFromFile(IFile& ifile, const bool ignore_coeffs_in
       return;
     }
   }
+  // truncation of the indices, not present if all the coeffs are written
+  std::string truncation_f="";
+  unsigned int truncation_max_degree_f=0;
+  if(ifile.FieldExist(field_truncation_)) {
+    ifile.scanField(field_truncation_,truncation_f);
+    ifile.scanField(field_truncation_max_degree_,int_tmp);
+    truncation_max_degree_f=(unsigned int) int_tmp;
+  }
   if(!ignore_coeffs_info) {
     std::string msg_header="Error when reading in coeffs from file " + ifile.getPath() + ": ";
     checkCoeffsInfo(msg_header, coeffs_type_f, ndimensions_f, ncoeffs_total_f, indices_shape_f);
+    if(truncation_f!=truncation_ || truncation_max_degree_f!=truncation_max_degree_) {
+      std::string s1;
+      Tools::convert(truncation_max_degree_f,s1);
+      std::string s2;
+      Tools::convert(truncation_max_degree_,s2);
+      std::string msg = msg_header + " the truncation of the coeffs " + (truncation_f.empty() ? "NONE" : truncation_f+" "+s1) + " in file doesn't match the defined value " + (truncation_.empty() ? "NONE" : truncation_+" "+s2);
+      plumed_merror(msg);
+    }
   }
 }
 
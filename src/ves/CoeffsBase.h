@@ -22,8 +22,11 @@
 #ifndef __PLUMED_ves_CoeffsBase_h
 #define __PLUMED_ves_CoeffsBase_h
 
+#include "tools/Exception.h"
+
 #include <vector>
 #include <string>
+#include <algorithm>
 
 
 namespace PLMD {
@@ -67,6 +70,13 @@ private:
   size_t ncoeffs_;
   std::vector<std::string> coeffs_descriptions_;
   std::vector<std::string> dimension_labels_;
+  // truncation of the tensor product of the indices, when active only
+  // the indices in the set are stored, ordered as in the full tensor product
+  std::string truncation_;
+  unsigned int truncation_max_degree_;
+  // the indices (flattened, ndimensions_ for each coeff) and the index in the full tensor product of each coeff
+  std::vector<unsigned int> truncated_indices_;
+  std::vector<size_t> truncated_full_index_;
   //
   std::vector<Value*> args_;
   std::vector<BasisFunctions*> basisf_;
@@ -79,6 +89,8 @@ private:
   const std::string field_ndimensions_;
   const std::string field_ncoeffs_total_;
   const std::string field_shape_prefix_;
+  const std::string field_truncation_;
+  const std::string field_truncation_max_degree_;
   const std::string field_time_;
   const std::string field_iteration_;
   //
@@ -86,6 +98,8 @@ private:
   //
   void initializeIndices(const std::vector<unsigned int>&, const std::vector<std::string>&);
   void reinitializeIndices(const std::vector<unsigned int>&);
+  void setupTruncatedIndices();
+  size_t getFullIndex(const std::vector<unsigned int>&) const;
 public:
   explicit CoeffsBase();
   //
@@ -158,6 +172,17 @@ public:
     return ndimensions_;
   }
   //
+  void truncateIndices(const std::string&, const unsigned int);
+  bool isTruncated() const {
+    return !truncation_.empty();
+  }
+  std::string getTruncation() const {
+    return truncation_;
+  }
+  unsigned int getTruncationMaxDegree() const {
+    return truncation_max_degree_;
+  }
+  //
   bool isActive() const {
     return active;
   }
@@ -268,7 +293,7 @@ std::string CoeffsBase::getDimensionLabel(const unsigned int dim_index) const {
 
 // we are flattening arrays using a column-major order
 inline
-size_t CoeffsBase::getIndex(const std::vector<unsigned int>& indices) const {
+size_t CoeffsBase::getFullIndex(const std::vector<unsigned int>& indices) const {
   // plumed_dbg_assert(indices.size()==ndimensions_);
   // for(unsigned int i=0; i<ndimensions_; i++){
   //   if(indices[i]>=indices_shape_[i]){
@@ -285,9 +310,25 @@ size_t CoeffsBase::getIndex(const std::vector<unsigned int>& indices) const {
   return index;
 }
 
+inline
+size_t CoeffsBase::getIndex(const std::vector<unsigned int>& indices) const {
+  if(truncation_.empty()) {
+    return getFullIndex(indices);
+  }
+  // the truncated indices are sorted by their index in the full tensor product
+  const size_t full_index=getFullIndex(indices);
+  auto it=std::lower_bound(truncated_full_index_.begin(),truncated_full_index_.end(),full_index);
+  plumed_dbg_massert(it!=truncated_full_index_.end() && *it==full_index,"the indices are not in the truncated set of coeffs");
+  return it-truncated_full_index_.begin();
+}
+
 // we are flattening arrays using a column-major order
 inline
 std::vector<unsigned int> CoeffsBase::getIndices(const size_t index) const {
+  if(!truncation_.empty()) {
+    auto begin=truncated_indices_.begin()+index*ndimensions_;
+    return std::vector<unsigned int>(begin,begin+ndimensions_);
+  }
   std::vector<unsigned int> indices(ndimensions_);
   size_t kk=index;
   indices[0]=(index%indices_shape_[0]);
@@ -32,6 +32,7 @@
 #include "tools/Keywords.h"
 #include "tools/Grid.h"
 #include "tools/Communicator.h"
+#include "tools/OpenMP.h"
 
 #include "GridProjWeights.h"
 
@@ -40,6 +41,39 @@
 namespace PLMD {
 namespace ves {
 
+namespace {
+// Contracts dimension k of the tensor t with the matrix a, that has nout rows and shape[k] columns,
+// and sets shape[k] to nout. As in CoeffsBase and Grid, the first dimension is the one that changes fastest.
+void contractDimension(const std::vector<double>& t, std::vector<size_t>& shape, const unsigned int k, const std::vector<double>& a, const size_t nout, std::vector<double>& result) {
+  size_t inner=1;
+  for(unsigned int i=0; i<k; i++) {
+    inner*=shape[i];
+  }
+  size_t outer=1;
+  for(unsigned int i=k+1; i<shape.size(); i++) {
+    outer*=shape[i];
+  }
+  const size_t nin=shape[k];
+  result.assign(outer*nout*inner,0.0);
+  const unsigned nt=std::min<size_t>(OpenMP::getNumThreads(),outer*nout);
+  #pragma omp parallel for num_threads(nt)
+  for(size_t row=0; row<outer*nout; row++) {
+    const size_t o=row/nout;
+    const size_t p=row%nout;
+    double* r=result.data()+row*inner;
+    for(size_t j=0; j<nin; j++) {
+      const double a_pj=a[p*nin+j];
+      const double* tj=t.data()+(o*nin+j)*inner;
+      #pragma omp simd
+      for(size_t i=0; i<inner; i++) {
+        r[i]+=a_pj*tj[i];
+      }
+    }
+  }
+  shape[k]=nout;
+}
+}
+
 void LinearBasisSetExpansion::registerKeywords(Keywords& keys) {
 }
 
@@ -182,11 +216,12 @@ void LinearBasisSetExpansion::updateBiasGrid() {
   if(action_pntr_!=NULL &&  getStepOfLastBiasGridUpdate()==action_pntr_->getStep()) {
     return;
   }
+  std::vector<double> all_bias;
+  std::vector<double> all_forces;
+  getBiasAndForcesOnGrid(*bias_grid_pntr_,all_bias,all_forces);
   for(Grid::index_t l=0; l<bias_grid_pntr_->getSize(); l++) {
-    std::vector<double> forces(nargs_);
-    std::vector<double> args = bias_grid_pntr_->getPoint(l);
-    bool all_inside=true;
-    double bias=getBiasAndForces(args,all_inside,forces);
+    std::vector<double> forces(all_forces.begin()+l*nargs_,all_forces.begin()+(l+1)*nargs_);
+    double bias=all_bias[l];
     //
     if(biasCutoffActive()) {
       vesbias_pntr_->applyBiasCutoff(bias,forces);
@@ -216,11 +251,12 @@ void LinearBasisSetExpansion::updateBiasWithoutCutoffGrid() {
     return;
   }
   //
+  std::vector<double> all_bias;
+  std::vector<double> all_forces;
+  getBiasAndForcesOnGrid(*bias_withoutcutoff_grid_pntr_,all_bias,all_forces);
   for(Grid::index_t l=0; l<bias_withoutcutoff_grid_pntr_->getSize(); l++) {
-    std::vector<double> forces(nargs_);
-    std::vector<double> args = bias_withoutcutoff_grid_pntr_->getPoint(l);
-    bool all_inside=true;
-    double bias=getBiasAndForces(args,all_inside,forces);
+    std::vector<double> forces(all_forces.begin()+l*nargs_,all_forces.begin()+(l+1)*nargs_);
+    double bias=all_bias[l];
     if(bias_withoutcutoff_grid_pntr_->hasDerivatives()) {
       bias_withoutcutoff_grid_pntr_->setValueAndDerivatives(l,bias,forces);
     } else {
@@ -601,27 +637,163 @@ void LinearBasisSetExpansion::restartTargetDistribution() {
 
 void LinearBasisSetExpansion::calculateTargetDistAveragesFromGrid(const Grid* targetdist_grid_pntr) {
   plumed_assert(targetdist_grid_pntr!=NULL);
-  std::vector<double> targetdist_averages(ncoeffs_,0.0);
   std::vector<double> integration_weights = GridIntegrationWeights::getIntegrationWeights(targetdist_grid_pntr);
-  Grid::index_t stride=mycomm_.Get_size();
-  Grid::index_t rank=mycomm_.Get_rank();
-  for(Grid::index_t l=rank; l<targetdist_grid_pntr->getSize(); l+=stride) {
-    std::vector<double> args_values = targetdist_grid_pntr->getPoint(l);
-    std::vector<double> basisset_values(ncoeffs_);
-    // parallelization done over the grid -> should NOT use parallel in getBasisSetValues!!
-    getBasisSetValues(args_values,basisset_values,false);
-    double weight = integration_weights[l]*targetdist_grid_pntr->getValue(l);
-    for(unsigned int i=0; i<ncoeffs_; i++) {
-      targetdist_averages[i] += weight*basisset_values[i];
+  std::vector<double> weights(targetdist_grid_pntr->getSize());
+  for(Grid::index_t l=0; l<targetdist_grid_pntr->getSize(); l++) {
+    weights[l] = integration_weights[l]*targetdist_grid_pntr->getValue(l);
+  }
+  // the weights on the grid are contracted with the values of the basis functions one dimension at a time
+  std::vector<std::vector<double> > bf_values;
+  std::vector<std::vector<double> > bf_derivs;
+  getBasisSetValuesOnGrid(*targetdist_grid_pntr,bf_values,bf_derivs);
+  const std::vector<unsigned> nbin=targetdist_grid_pntr->getNbin();
+  std::vector<double> targetdist_averages;
+  if(bias_coeffs_pntr_->isTruncated()) {
+    // only some of the products of the basis functions are used, so the sum over the grid is done for each coeff
+    targetdist_averages.assign(ncoeffs_,0.0);
+    #pragma omp parallel for num_threads(OpenMP::getNumThreads())
+    for(size_t i=0; i<ncoeffs_; i++) {
+      const std::vector<unsigned int> indices=bias_coeffs_pntr_->getIndices(i);
+      double sum=0.0;
+      std::vector<unsigned> grid_indices(nargs_);
+      for(Grid::index_t l=0; l<targetdist_grid_pntr->getSize(); l++) {
+        targetdist_grid_pntr->getIndices(l,grid_indices);
+        double bf_curr=weights[l];
+        for(unsigned int k=0; k<nargs_; k++) {
+          bf_curr*=bf_values[k][indices[k]*nbin[k]+grid_indices[k]];
+        }
+        sum+=bf_curr;
+      }
+      targetdist_averages[i]=sum;
     }
+  } else {
+    std::vector<size_t> shape(nbin.begin(),nbin.end());
+    for(unsigned int k=0; k<nargs_; k++) {
+      contractDimension(weights,shape,k,bf_values[k],basisf_pntrs_[k]->getNumberOfBasisFunctions(),targetdist_averages);
+      weights.swap(targetdist_averages);
+    }
+    targetdist_averages.swap(weights);
   }
-  mycomm_.Sum(targetdist_averages);
+  plumed_assert(targetdist_averages.size()==ncoeffs_);
   // the overall constant;
   targetdist_averages[0] = getBasisSetConstant();
   TargetDistAverages() = targetdist_averages;
 }
 
 
+void LinearBasisSetExpansion::getBasisSetValuesOnGrid(const Grid& grid, std::vector<std::vector<double> >& bf_values, std::vector<std::vector<double> >& bf_derivs) const {
+  plumed_assert(grid.getDimension()==nargs_);
+  bf_values.resize(nargs_);
+  bf_derivs.resize(nargs_);
+  const std::vector<unsigned> nbin=grid.getNbin();
+  for(unsigned int k=0; k<nargs_; k++) {
+    std::vector<unsigned> indices(nargs_,0);
+    std::vector<double> args(nbin[k]);
+    for(unsigned p=0; p<nbin[k]; p++) {
+      indices[k]=p;
+      args[p]=grid.getPoint(indices)[k];
+    }
+    basisf_pntrs_[k]->getAllValuesOnPoints(args,bf_values[k],bf_derivs[k]);
+  }
+}
+
+
+void LinearBasisSetExpansion::getBiasAndForcesOnGridTruncated(const Grid& grid, const std::vector<std::vector<double> >& bf_values, const std::vector<std::vector<double> >& bf_derivs, std::vector<double>& bias, std::vector<double>& forces) const {
+  // the products of the basis functions that are not in the truncated set would have to be
+  // stored to use the sum factorization, so the sum over the coeffs is done at each point of the grid
+  const std::vector<unsigned> nbin=grid.getNbin();
+  const std::vector<double> coeffs=bias_coeffs_pntr_->getDataAsVector();
+  std::vector<unsigned int> all_indices(ncoeffs_*nargs_);
+  for(size_t i=0; i<ncoeffs_; i++) {
+    const std::vector<unsigned int> indices=bias_coeffs_pntr_->getIndices(i);
+    std::copy(indices.begin(),indices.end(),all_indices.begin()+i*nargs_);
+  }
+  bias.assign(grid.getSize(),0.0);
+  forces.assign(grid.getSize()*nargs_,0.0);
+  #pragma omp parallel num_threads(OpenMP::getNumThreads())
+  {
+    std::vector<unsigned> grid_indices(nargs_);
+    std::vector<double> values(nargs_);
+    std::vector<double> derivs(nargs_);
+    #pragma omp for
+    for(Grid::index_t l=0; l<grid.getSize(); l++) {
+      grid.getIndices(l,grid_indices);
+      double b=0.0;
+      for(size_t i=0; i<ncoeffs_; i++) {
+        double bf_curr=1.0;
+        for(unsigned int k=0; k<nargs_; k++) {
+          const size_t n=all_indices[i*nargs_+k]*nbin[k]+grid_indices[k];
+          values[k]=bf_values[k][n];
+          derivs[k]=bf_derivs[k][n];
+          bf_curr*=values[k];
+        }
+        b+=coeffs[i]*bf_curr;
+        for(unsigned int k=0; k<nargs_; k++) {
+          double der=coeffs[i]*derivs[k];
+          for(unsigned int j=0; j<nargs_; j++) {
+            if(j!=k) {
+              der*=values[j];
+            }
+          }
+          forces[l*nargs_+k]-=der;
+        }
+      }
+      bias[l]=b;
+    }
+  }
+}
+
+
+void LinearBasisSetExpansion::getBiasAndForcesOnGrid(const Grid& grid, std::vector<double>& bias, std::vector<double>& forces) const {
+  // The bias is the sum over the coefficients of products of one dimensional basis functions,
+  // so the coefficients are contracted with the values of the basis functions at the grid points one dimension at a time.
+  // This costs much less than summing over all the coefficients at each point of the grid.
+  // The derivative along dimension k is obtained by using the derivatives of the basis functions along k.
+  std::vector<std::vector<double> > bf_values;
+  std::vector<std::vector<double> > bf_derivs;
+  getBasisSetValuesOnGrid(grid,bf_values,bf_derivs);
+  const std::vector<unsigned> nbin=grid.getNbin();
+  if(bias_coeffs_pntr_->isTruncated()) {
+    getBiasAndForcesOnGridTruncated(grid,bf_values,bf_derivs,bias,forces);
+    return;
+  }
+  // the tables are transposed, so that each row contains all the basis functions at one grid point
+  std::vector<std::vector<double> > values_T(nargs_);
+  std::vector<std::vector<double> > derivs_T(nargs_);
+  std::vector<size_t> nbasis(nargs_);
+  for(unsigned int k=0; k<nargs_; k++) {
+    nbasis[k]=basisf_pntrs_[k]->getNumberOfBasisFunctions();
+    values_T[k].resize(nbasis[k]*nbin[k]);
+    derivs_T[k].resize(nbasis[k]*nbin[k]);
+    for(size_t n=0; n<nbasis[k]; n++) {
+      for(unsigned p=0; p<nbin[k]; p++) {
+        values_T[k][p*nbasis[k]+n]=bf_values[k][n*nbin[k]+p];
+        derivs_T[k][p*nbasis[k]+n]=bf_derivs[k][n*nbin[k]+p];
+      }
+    }
+  }
+  const std::vector<double> coeffs=bias_coeffs_pntr_->getDataAsVector();
+  plumed_assert(coeffs.size()==ncoeffs_);
+  forces.assign(grid.getSize()*nargs_,0.0);
+  std::vector<double> tmp;
+  for(unsigned int d=0; d<=nargs_; d++) {
+    std::vector<size_t> shape=nbasis;
+    std::vector<double> result=coeffs;
+    for(unsigned int k=0; k<nargs_; k++) {
+      contractDimension(result,shape,k,(d==k+1)?derivs_T[k]:values_T[k],nbin[k],tmp);
+      result.swap(tmp);
+    }
+    if(d==0) {
+      bias.swap(result);
+    } else {
+      for(Grid::index_t l=0; l<grid.getSize(); l++) {
+        forces[l*nargs_+d-1]=-result[l];
+      }
+    }
+  }
+}
+
+
 void LinearBasisSetExpansion::setBiasMinimumToZero() {
   plumed_massert(bias_grid_pntr_,"setBiasMinimumToZero can only be used if the bias grid is defined");
   updateBiasGrid();
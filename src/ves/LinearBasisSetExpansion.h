@@ -243,6 +243,12 @@ private:
   std::unique_ptr<Grid> setupGeneralGrid(const std::string&, const bool usederiv=false);
   //
   void calculateTargetDistAveragesFromGrid(const Grid*);
+  // values and derivatives of the basis functions at the grid points along each dimension
+  void getBasisSetValuesOnGrid(const Grid&, std::vector<std::vector<double> >&, std::vector<std::vector<double> >&) const;
+  // bias and forces on all the points of a grid, forces[l*nargs+k] is the force along k at point l
+  void getBiasAndForcesOnGrid(const Grid&, std::vector<double>&, std::vector<double>&) const;
+  // the same when the coeffs are truncated, by summing over the coeffs at each point
+  void getBiasAndForcesOnGridTruncated(const Grid&, const std::vector<std::vector<double> >&, const std::vector<std::vector<double> >&, std::vector<double>&, std::vector<double>&) const;
   //
   bool isStaticTargetDistFileOutputActive() const;
 };
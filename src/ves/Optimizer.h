@@ -199,6 +199,9 @@ public:
   void apply() override {};
   void calculate() override {};
   void update() override;
+  bool isHistoryDependent() const override {
+    return true;
+  }
   unsigned int getNumberOfDerivatives() override {
     return 0;
   }
@@ -152,6 +152,9 @@ public:
   static void registerKeywords(Keywords&);
   explicit VesBias(const ActionOptions&ao);
   ~VesBias();
+  bool isHistoryDependent() const override {
+    return true;
+  }
   //
   static void useInitialCoeffsKeywords(Keywords&);
   static void useTargetDistributionKeywords(Keywords&);
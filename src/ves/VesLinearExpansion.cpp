@@ -74,6 +74,17 @@ define them in the input file before the VES_LINEAR_EXPANSION action and
 then give their labels using the BASIS_FUNCTIONS keyword.
 
 
+## Truncating the Basis Set
+
+The number of coefficients grows exponentially with the number of CVs, as all the
+products of the one-dimensional basis functions are used. With more than three CVs
+it is possible to use only some of these products with the COEFFS_TRUNCATION keyword.
+Using $n_{k}$ to indicate the index of the basis function for the $k$-th CV (that is zero for the constant),
+TOTAL_DEGREE keeps the products for which $n_{1}+n_{2}+\ldots \leq$ COEFFS_MAX_DEGREE,
+while HYPERBOLIC_CROSS keeps the products for which $(n_{1}+1)(n_{2}+1)\cdots \leq$ COEFFS_MAX_DEGREE$+1$,
+which are much less. The truncation is also used for the gradient and the Hessian of the optimizer, and it is written
+in the coefficients files, so it should not be changed when restarting.
+
 ## Target Distributions
 
 Various target distributions $p(\mathbf{s})$ are available in the VES code,
@@ -332,6 +343,8 @@ void VesLinearExpansion::registerKeywords( Keywords& keys ) {
   //
   keys.add("compulsory","BASIS_FUNCTIONS","the label of the one dimensional basis functions that should be used.");
   keys.add("compulsory","GRID_FMT","%14.9f","the format to use when outputting the numbers in the grids");
+  keys.add("optional","COEFFS_TRUNCATION","only use some of the products of the basis functions, either TOTAL_DEGREE or HYPERBOLIC_CROSS. This should be used together with COEFFS_MAX_DEGREE");
+  keys.add("optional","COEFFS_MAX_DEGREE","the largest degree of the products of the basis functions that are used when COEFFS_TRUNCATION is given");
   keys.addOutputComponent("force2","default","scalar","the instantaneous value of the squared force due to this bias potential.");
   keys.addDOI("10.1103/PhysRevLett.115.070601");
 }
@@ -366,7 +379,27 @@ VesLinearExpansion::VesLinearExpansion(const ActionOptions&ao):
     }
   }
 
-  addCoeffsSet(args_pntrs,basisf_pntrs_);
+  std::string truncation="";
+  parse("COEFFS_TRUNCATION",truncation);
+  if(truncation.size()>0) {
+    if(truncation!="TOTAL_DEGREE" && truncation!="HYPERBOLIC_CROSS") {
+      plumed_merror("Error in keyword COEFFS_TRUNCATION of "+getName()+": it should be TOTAL_DEGREE or HYPERBOLIC_CROSS");
+    }
+    unsigned int max_degree=0;
+    parse("COEFFS_MAX_DEGREE",max_degree);
+    if(max_degree==0) {
+      plumed_merror("Error in keyword COEFFS_TRUNCATION of "+getName()+": COEFFS_MAX_DEGREE should be given and larger than zero");
+    }
+    auto coeffs_pntr_tmp = Tools::make_unique<CoeffsVector>("coeffs",args_pntrs,basisf_pntrs_,comm,true);
+    size_t ncoeffs_full = coeffs_pntr_tmp->numberOfCoeffs();
+    coeffs_pntr_tmp->truncateIndices(truncation,max_degree);
+    // the data were allocated for the full tensor product
+    coeffs_pntr_tmp->clear();
+    log.printf("  using %zu of the %zu products of the basis functions (%s truncation with maximum degree %u)\n",coeffs_pntr_tmp->numberOfCoeffs(),ncoeffs_full,truncation.c_str(),max_degree);
+    addCoeffsSet(std::move(coeffs_pntr_tmp));
+  } else {
+    addCoeffsSet(args_pntrs,basisf_pntrs_);
+  }
   ncoeffs_ = numberOfCoeffs();
   bool coeffs_read = readCoeffsFromFiles();
 
@@ -286,6 +286,22 @@ xdrfile_close(XDRFILE *xfp)
 	return ret; /* return 0 if ok */
 }
 
+long long
+xdrfile_tell(XDRFILE *xfp)
+{
+	if(xfp==NULL)
+		return -1;
+	return (long long) ftello(xfp->fp);
+}
+
+int
+xdrfile_seek(XDRFILE *xfp, long long offset, int whence)
+{
+	if(xfp==NULL || xfp->mode!='r')
+		return -1;
+	return fseeko(xfp->fp,(off_t) offset,whence);
+}
+
 
 
 int 
@@ -168,6 +168,33 @@ namespace xdrfile
 	xdrfile_close   (XDRFILE *       xfp);
 
 
+	/*! \brief Get the current position in a file opened for reading, like ftello()
+	 *
+	 *  Contrary to the positions of the XDR stream this is safe for large
+	 *  (64-bit) files, since the position is not stored in an int.
+	 *
+	 *  \param xfp  Pointer to an abstract XDRFILE datatype
+	 *
+	 *  \return     Offset in bytes from the beginning of the file, -1 on error.
+	 */
+	long long
+	xdrfile_tell    (XDRFILE *       xfp);
+
+
+	/*! \brief Move to a position in a file opened for reading, like fseeko()
+	 *
+	 *  \param xfp     Pointer to an abstract XDRFILE datatype
+	 *  \param offset  Offset in bytes
+	 *  \param whence  SEEK_SET, SEEK_CUR or SEEK_END, as in fseek()
+	 *
+	 *  \return        0 on success, non-zero on error.
+	 */
+	int
+	xdrfile_seek    (XDRFILE *       xfp,
+					 long long       offset,
+					 int             whence);
+
+
 
 
 	/*! \brief Read one or more \a char type variable(s) 
@@ -56,6 +56,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -512,6 +513,25 @@ int read_trr_natoms(char *fn,int *natoms)
 	return exdrOK;
 }
 
+int skip_trr(XDRFILE *xd,int *natoms,int *step,float *t)
+/* Skip a frame using the sizes stored in the header */
+{
+	t_trnheader sh;
+	int result;
+	long long size;
+
+	if ((result = do_trnheader(xd,1,&sh)) != exdrOK)
+		return result;
+	*natoms = sh.natoms;
+	*step   = sh.step;
+	*t      = sh.tf;
+	size = (long long)sh.box_size + sh.vir_size + sh.pres_size +
+		sh.x_size + sh.v_size + sh.f_size;
+	if (xdrfile_seek(xd,size,SEEK_CUR))
+		return exdrHEADER;
+	return exdrOK;
+}
+
 int write_trr(XDRFILE *xd,int natoms,int step,float t,float lambda,
 			  matrix box,rvec *x,rvec *v,rvec *f)
 {
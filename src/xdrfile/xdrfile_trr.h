@@ -78,6 +78,9 @@ namespace xdrfile {
   extern int read_trr(XDRFILE *xd,int natoms,int *step,float *t,float *lambda,
 		      matrix box,rvec *x,rvec *v,rvec *f);
 
+  /* Skip one frame of an open trr file, without reading the vectors */
+  extern int skip_trr(XDRFILE *xd,int *natoms,int *step,float *t);
+
   /* Write a frame to xtc file */
   extern int write_trr(XDRFILE *xd,int natoms,int step,float t,float lambda,
 		       matrix box,rvec *x,rvec *v,rvec *f);
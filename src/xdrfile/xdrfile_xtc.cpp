@@ -52,6 +52,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
  
+#include <stdio.h>
 #include <stdlib.h>
 #include "xdrfile.h"
 #include "xdrfile_xtc.h"
@@ -146,6 +147,36 @@ int read_xtc(XDRFILE *xd,
 	return exdrOK;
 }
 
+int skip_xtc(XDRFILE *xd,int *natoms,int *step,float *time)
+/* Skip a frame without decompressing the coordinates */
+{
+	int result,lsize,nbytes;
+	int ints[7];
+	float prec;
+	matrix box;
+
+	if ((result = xtc_header(xd,natoms,step,time,TRUE)) != exdrOK)
+		return result;
+	if (xdrfile_read_float(box[0],DIM*DIM,xd) != DIM*DIM)
+		return exdrFLOAT;
+	if (xdrfile_read_int(&lsize,1,xd) != 1)
+		return exdr3DX;
+	/* few atoms are not compressed */
+	if (lsize <= 9)
+		return xdrfile_seek(xd,(long long)lsize*DIM*4,SEEK_CUR) ? exdr3DX : exdrOK;
+	/* precision, minint[3], maxint[3], smallidx and the size of the compressed data */
+	if (xdrfile_read_float(&prec,1,xd) != 1)
+		return exdr3DX;
+	if (xdrfile_read_int(ints,7,xd) != 7)
+		return exdr3DX;
+	if (xdrfile_read_int(&nbytes,1,xd) != 1)
+		return exdr3DX;
+	/* opaque data are padded to multiples of 4 bytes */
+	if (xdrfile_seek(xd,(long long)((nbytes+3)/4)*4,SEEK_CUR))
+		return exdr3DX;
+	return exdrOK;
+}
+
 int write_xtc(XDRFILE *xd,
 			  int natoms,int step,float time,
 			  matrix box,rvec *x,float prec)
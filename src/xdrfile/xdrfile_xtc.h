@@ -78,6 +78,9 @@ namespace xdrfile {
   extern int read_xtc(XDRFILE *xd,int natoms,int *step,float *time,
 		      matrix box,rvec *x,float *prec);
   
+  /* Skip one frame of an open xtc file, without decompressing the coordinates */
+  extern int skip_xtc(XDRFILE *xd,int *natoms,int *step,float *time);
+  
   /* Write a frame to xtc file */
   extern int write_xtc(XDRFILE *xd,
 		       int natoms,int step,float time,